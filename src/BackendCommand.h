@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+
+// Request from a UI producer to the backend task, executed ahead of the poll
+struct BackendCommand {
+  enum Type : uint8_t {
+    SET_BAND,       // value = band index
+    SET_MODE,       // value = KXPA100Controller::Mode
+    SET_ANTENNA,    // value = antenna port 1/2
+    CAPTURE         // value = CaptureAction, all stations
+  };
+
+  enum CaptureAction : int8_t {
+    CAPTURE_STOP,
+    CAPTURE_START,
+    CAPTURE_SAVE    // stop and write the ring to FRAME_LOG_PATH
+  };
+
+  Type type;
+  int8_t value;
+  uint8_t station;  // index into stations[]
+  uint32_t seq;     // echoed back as Telemetry::commandAck once applied
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Compile-time band plan, one row per KXPA100 band number (^BNxx).
+//
+// Select the IARU region with BANDPLAN_REGION (1, 2 or 3), and put bands on
+// antenna 2 by setting their bit (1 << band index) in BANDPLAN_ANT2_MASK.
+// The table is checked at compile time: sorted, no overlaps, and every row
+// sits at the index of its band command.
+
+#ifndef BANDPLAN_REGION
+#define BANDPLAN_REGION     1
+#endif
+
+#ifndef BANDPLAN_ANT2_MASK
+#define BANDPLAN_ANT2_MASK  (1 << 10)    // 6m on ANT2, everything else ANT1
+#endif
+
+namespace BandPlan {
+
+struct Band {
+  uint32_t lowerFreq;
+  uint32_t upperFreq;
+  const char* name;
+  const char* bandCmd;
+  const char* antennaCmd;
+};
+
+constexpr const char* antennaFor(size_t index) {
+  return ((BANDPLAN_ANT2_MASK >> index) & 1) ? "^AN2;" : "^AN1;";
+}
+
+constexpr Band BANDS[] = {
+#if BANDPLAN_REGION == 1
+  {1800000L,   2000000L,   "160m", "^BN00;", antennaFor(0)},
+  {3500000L,   3800000L,   "80m",  "^BN01;", antennaFor(1)},
+  {5351500L,   5366500L,   "60m",  "^BN02;", antennaFor(2)},
+  {7000000L,   7200000L,   "40m",  "^BN03;", antennaFor(3)},
+#elif BANDPLAN_REGION == 2
+  {1800000L,   2000000L,   "160m", "^BN00;", antennaFor(0)},
+  {3500000L,   4000000L,   "80m",  "^BN01;", antennaFor(1)},
+  {5330500L,   5406400L,   "60m",  "^BN02;", antennaFor(2)},
+  {7000000L,   7300000L,   "40m",  "^BN03;", antennaFor(3)},
+#elif BANDPLAN_REGION == 3
+  {1800000L,   2000000L,   "160m", "^BN00;", antennaFor(0)},
+  {3500000L,   3900000L,   "80m",  "^BN01;", antennaFor(1)},
+  {5351500L,   5366500L,   "60m",  "^BN02;", antennaFor(2)},
+  {7000000L,   7300000L,   "40m",  "^BN03;", antennaFor(3)},
+#else
+#error "BANDPLAN_REGION must be 1, 2 or 3"
+#endif
+  {10100000L,  10150000L,  "30m",  "^BN04;", antennaFor(4)},
+  {14000000L,  14350000L,  "20m",  "^BN05;", antennaFor(5)},
+  {18068000L,  18168000L,  "17m",  "^BN06;", antennaFor(6)},
+  {21000000L,  21450000L,  "15m",  "^BN07;", antennaFor(7)},
+  {24890000L,  24990000L,  "12m",  "^BN08;", antennaFor(8)},
+  {28000000L,  29700000L,  "10m",  "^BN09;", antennaFor(9)},
+#if BANDPLAN_REGION == 1
+  {50000000L,  52000000L,  "6m",   "^BN10;", antennaFor(10)}
+#else
+  {50000000L,  54000000L,  "6m",   "^BN10;", antennaFor(10)}
+#endif
+};
+
+constexpr size_t BAND_COUNT = sizeof(BANDS) / sizeof(BANDS[0]);
+
+// Compile-time validation (C++11 constexpr, hence the recursion)
+constexpr bool isOrdered(size_t i = 0) {
+  return i >= BAND_COUNT ||
+         (BANDS[i].lowerFreq < BANDS[i].upperFreq &&
+          (i + 1 >= BAND_COUNT || BANDS[i].upperFreq < BANDS[i + 1].lowerFreq) &&
+          isOrdered(i + 1));
+}
+
+constexpr bool commandsMatch(size_t i = 0) {
+  return i >= BAND_COUNT ||
+         (BANDS[i].bandCmd[3] - '0' == (int)(i / 10) &&
+          BANDS[i].bandCmd[4] - '0' == (int)(i % 10) &&
+          commandsMatch(i + 1));
+}
+
+static_assert(BAND_COUNT == 11, "KXPA100 has 11 bands (^BN00..^BN10)");
+static_assert(isOrdered(), "band plan must be sorted and free of overlaps");
+static_assert(commandsMatch(), "band command must match the table index");
+
+// Binary search, -1 if the frequency is outside every band
+constexpr int find(uint32_t freq, int lo, int hi) {
+  return lo > hi ? -1 :
+         freq < BANDS[(lo + hi) / 2].lowerFreq ? find(freq, lo, (lo + hi) / 2 - 1) :
+         freq > BANDS[(lo + hi) / 2].upperFreq ? find(freq, (lo + hi) / 2 + 1, hi) :
+         (lo + hi) / 2;
+}
+
+constexpr int bandIndexOf(uint32_t freq) {
+  return find(freq, 0, (int)BAND_COUNT - 1);
+}
+
+static_assert(bandIndexOf(14250000L) == 5 && bandIndexOf(13999999L) == -1 &&
+              bandIndexOf(1800000L) == 0 && bandIndexOf(50100000L) == 10,
+              "band lookup self-test");
+
+} // namespace BandPlan
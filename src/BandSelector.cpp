@@ -0,0 +1,69 @@
+#include "BandSelector.h"
+#include <limits.h>
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+BandSelector::BandSelector(KXPA100Controller& kxpa, uint16_t dwellMs)
+  : _kxpa(kxpa)
+  , _dwellMs(dwellMs)
+  , _current(-1)
+  , _candidate(-1)
+  , _candidateSince(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void BandSelector::setTiming(uint16_t dwellMs) {
+  _dwellMs = dwellMs;
+}
+
+void BandSelector::feed(uint32_t freq, unsigned long now) {
+  int band = _kxpa.getBandIndexByFrequency(freq);
+  if (band < 0) {
+    return;   // not in the band plan or between bands, keep whatever we have
+  }
+
+  if (band == _current) {
+    _candidate = -1;   // burst ended where it started, nothing to do
+    return;
+  }
+
+  if (band != _candidate) {
+    _candidate = band;
+    _candidateSince = now;   // every change restarts the dwell
+  }
+}
+
+// Band reported by the amp or just written to it
+void BandSelector::setCurrent(int band) {
+  _current = band;
+  if (_candidate == band) {
+    _candidate = -1;   // amp is already there, skip the switch
+  }
+}
+
+bool BandSelector::decide(unsigned long now, int& band) {
+  if (_candidate < 0 || now - _candidateSince < _dwellMs) {
+    return false;
+  }
+  band = _candidate;
+  _candidate = -1;
+  return true;
+}
+
+void BandSelector::reset() {
+  _candidate = -1;
+}
+
+unsigned long BandSelector::msUntilDecision(unsigned long now) const {
+  if (_candidate < 0) {
+    return ULONG_MAX;
+  }
+  unsigned long elapsed = now - _candidateSince;
+  return elapsed >= _dwellMs ? 0 : _dwellMs - elapsed;
+}
@@ -0,0 +1,34 @@
+#ifndef BANDSELECTOR_H
+#define BANDSELECTOR_H
+
+#include <Arduino.h>
+#include "KXPA100Controller.h"
+
+// Turns the stream of CAT frequencies into band switch decisions.
+//
+// A new band has to be seen for a dwell time before it is applied, and every
+// further change restarts the dwell, so tuning across several bands results
+// in a single switch to the last one. Frequencies outside the band plan
+// (transverter, glitches, the gaps between bands) are ignored, so the current
+// band is kept past its edge without an extra hysteresis margin.
+class BandSelector {
+public:
+  BandSelector(KXPA100Controller& kxpa, uint16_t dwellMs);
+
+  void setTiming(uint16_t dwellMs);
+  void feed(uint32_t freq, unsigned long now);
+  void setCurrent(int band);
+  bool decide(unsigned long now, int& band);
+  void reset();
+  bool pending() const { return _candidate >= 0; }
+  unsigned long msUntilDecision(unsigned long now) const;
+
+private:
+  KXPA100Controller& _kxpa;
+  uint16_t _dwellMs;
+  int _current;                  // band the amp is on, -1 = unknown
+  int _candidate;                // band waiting for its dwell, -1 = none
+  unsigned long _candidateSince;
+};
+
+#endif // BANDSELECTOR_H
@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include <limits.h>
+#include <esp_timer.h>
+#include "FrameLog.h"
+
+// Common interface of everything that can tell the backend the rig frequency
+class CatSource {
+public:
+  CatSource() : _notifyTask(NULL), _notifyBits(0), _log(NULL), _logStation(0) {}
+  virtual ~CatSource() {}
+
+  virtual void begin() = 0;
+
+  // Call this regularly from the backend task, must never block
+  virtual void update() = 0;
+
+  virtual bool isConnected() = 0;
+
+  // Ask for the current frequency; false if nothing was sent
+  virtual bool requestFrequency() = 0;
+
+  // Latest frequency in Hz; true only once per received value
+  virtual bool takeFrequency(uint32_t& freq) = 0;
+
+  // How long update() may be left alone, ULONG_MAX = until notified
+  virtual unsigned long msUntilWork(unsigned long now) = 0;
+
+  // True while a query waits for its reply on a shared network link
+  virtual bool requestPending() const { return false; }
+
+  // False if the rig pushes frequency changes and requestFrequency() is only a fallback
+  virtual bool needsPolling() const { return true; }
+
+  // Network endpoint of the current (or last) connection, NULL if there is none
+  virtual const char* endpointHost() const { return NULL; }
+  virtual uint16_t endpointPort() const { return 0; }
+
+  // Endpoint to try before the configured one, e.g. the last one that answered
+  virtual void preferEndpoint(const char* host, uint16_t port) {}
+
+  // Trade link latency for current draw while the station is idle
+  virtual void setPowerSave(bool enabled) {}
+
+  // Task notification bits set whenever the source has news for update()
+  void setNotify(TaskHandle_t task, uint32_t bits) {
+    _notifyBits = bits;
+    _notifyTask = task;
+  }
+
+  // Queries and replies as CAT frames of this station (see FrameLog)
+  void setFrameLog(FrameLog* log, uint8_t station) {
+    _log = log;
+    _logStation = station;
+  }
+
+protected:
+  void notify() {
+    if (_notifyTask != NULL) {
+      xTaskNotify(_notifyTask, _notifyBits, eSetBits);
+    }
+  }
+
+  // Backend task, like update()
+  void logFrame(FrameLog::Kind kind, const void* data, size_t len) {
+    if (_log != NULL) {
+      _log->record(_logStation, kind, data, len, esp_timer_get_time());
+    }
+  }
+
+  TaskHandle_t _notifyTask;
+  uint32_t _notifyBits;
+  FrameLog* _log;
+  uint8_t _logStation;
+};
@@ -1,69 +1,110 @@
 #pragma once
 #include <WiFi.h>
+#include <atomic>
+#include "CatSource.h"
+#include "NetClient.h"
+#include "WifiCache.h"
+#include "LatencyStats.h"
 
-class CatWifiClient {
+// rigctld over WiFi/TCP. Several clients (one per station) share the WiFi
+// station interface; the first one to begin() owns it and reconnects it.
+//
+// Fast reconnect: with a WifiCache from the last association, the owner
+// joins the known AP on its channel without a scan and, if allowed, reuses
+// the last address as a static IP instead of waiting for DHCP. A fast join
+// that fails falls back to a full scan, and a CAT connect timeout on a reused
+// address falls back to DHCP. A fresh address skips the connect backoff.
+class CatWifiClient : public CatSource {
 public:
-  CatWifiClient(const char* ssid, const char* password,
+  CatWifiClient(NetClient& socket, const char* ssid, const char* password,
                 const char* serverIP, uint16_t port, uint16_t timeout)
-      : _ssid(ssid), _password(password),
-        _serverIP(serverIP), _port(port), _timeout(timeout),
+      : _socket(socket), _ssid(ssid), _password(password),
+        _serverIP(serverIP), _port(port), _host(serverIP), _hostPort(port),
+        _timeout(timeout), _ownsWifi(false),
         _socketState(DISCONNECTED), _lastConnectAttempt(0),
-        _retryCount(0) {}
+        _retryCount(0), _connectNow(false), _lineLen(0), _requestPending(false),
+        _requestSentAt(0), _requestSentUs(0), _replyFreq(0), _freq(0), _freqFresh(false) {
+    _cachedHost[0] = '\0';
+  }
 
-  void begin() {
-    Serial.println("Starting WiFi...");
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect(true);
-    delay(100);
+  void begin() override {
+    _ownsWifi = !_wifiStarted();
+    if (_ownsWifi) {
+      Serial.println("Starting WiFi...");
+      WiFi.persistent(false);        // credentials come from Secrets.h, no flash write per begin
+      WiFi.mode(WIFI_STA);
+      WiFi.setSleep(WIFI_PS_NONE);   // full speed until the station goes idle
 
-    WiFi.begin(_ssid, _password);
+      Link& link = _link();
+      link.staticIp = link.reuseIp && _cacheMatches() && link.cache.ip != 0;
+      if (link.staticIp) {
+        WiFi.config(IPAddress(link.cache.ip), IPAddress(link.cache.gateway),
+                    IPAddress(link.cache.mask), IPAddress(link.cache.dns));
+      }
+      _beginWifi();
+      _wifiStarted() = true;
+    } else if (WiFi.status() == WL_CONNECTED) {
+      _socketState = READY_TO_CONNECT;   // GOT_IP has already been and gone
+    }
 
     // Event Callback - NON-BLOCKING
     WiFi.onEvent([this](arduino_event_id_t event, arduino_event_info_t info) {
       switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+          if (_ownsWifi) {
+            Link& link = _link();
+            memcpy(link.pending.bssid, info.wifi_sta_connected.bssid, sizeof(link.pending.bssid));
+            link.pending.channel = info.wifi_sta_connected.channel;
+            link.associated = true;
+            link.fastFailed = false;
+          }
+          break;
+
         case ARDUINO_EVENT_WIFI_STA_GOT_IP:
           Serial.print("WiFi connected, IP: ");
           Serial.println(WiFi.localIP());
+          if (_ownsWifi) {
+            _learn(info);
+          }
           _socketState = READY_TO_CONNECT;
+          _connectNow = true;
+          notify();
           break;
 
         case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
-          Serial.println("WiFi disconnected, trying to reconnect...");
           _socketState = DISCONNECTED;
-          WiFi.begin(_ssid, _password);
+          if (_ownsWifi) {
+            Link& link = _link();
+            if (!link.associated && link.fastBegin) {
+              Serial.println("Cached AP not found, scanning...");
+              link.fastFailed = true;
+            } else {
+              Serial.println("WiFi disconnected, trying to reconnect...");
+            }
+            link.associated = false;
+            _beginWifi();
+          }
+          notify();
+          break;
+
+        default:
           break;
       }
     });
   }
 
   // Call this regularly from your loop/task
-  void update() {
+  void update() override {
     unsigned long now = millis();
     
     switch (_socketState) {
       case READY_TO_CONNECT:
-        // Attempt connection with backoff
-        if (now - _lastConnectAttempt >= _getBackoffDelay()) {
-          _attemptSocketConnect();
-        }
-        break;
-        
-      case CONNECTING:
-        // Check if connection succeeded
-        if (_socket.connected()) {
-          Serial.println("CAT-Server connected");
-          _socketState = CONNECTED;
+        // A new address connects at once, retries on the same one back off
+        if (_connectNow.exchange(false)) {
           _retryCount = 0;
-        } else if (now - _lastConnectAttempt >= CONNECT_TIMEOUT_MS) {
-          Serial.println("Socket connect timeout");
-          _socket.stop();
-          _socketState = READY_TO_CONNECT;
-          _retryCount++;
-          
-          if (_retryCount >= MAX_RETRIES) {
-            Serial.println("Max retries reached, waiting longer...");
-            _retryCount = MAX_RETRIES; // Cap it
-          }
+          _attemptSocketConnect();
+        } else if (now - _lastConnectAttempt >= _getBackoffDelay()) {
+          _attemptSocketConnect();
         }
         break;
         
@@ -71,9 +112,13 @@ public:
         // Monitor connection health
         if (!_socket.connected()) {
           Serial.println("Socket disconnected");
+          LatencyStats::count(LatencyStats::C_CAT_RECONNECT);
           _socketState = READY_TO_CONNECT;
           _retryCount = 0;
+          _resetReceiver();
+          break;
         }
+        _receive(now);
         break;
         
       case DISCONNECTED:
@@ -82,65 +127,315 @@ public:
     }
   }
 
-  bool isConnected() {
+  bool isConnected() override {
     return WiFi.status() == WL_CONNECTED && _socket.connected();
   }
 
-  String sendCommand(const char* command) {
-    if (!isConnected()) {
-      return "";
+  // Queue a frequency query, returns false while the previous one is outstanding.
+  // Uses rigctld's extended response protocol, framed by a final "RPRT n" line.
+  bool requestFrequency() override {
+    if (!isConnected() || _requestPending) {
+      return false;
     }
 
-    _socket.print(command);
+    _socket.print("+f\n");
+    logFrame(FrameLog::CAT_TX, "+f", 2);
+    _requestPending = true;
+    _requestSentAt = millis();
+    _requestSentUs = esp_timer_get_time();
+    _replyFreq = 0;
+    return true;
+  }
 
-    unsigned long startTime = millis();
-    // Wait for data availability
-    while (!_socket.available() && millis() - startTime < _timeout) {
-      delay(10);
+  // Latest frequency reply in Hz; true only once per reply
+  bool takeFrequency(uint32_t& freq) override {
+    if (!_freqFresh) {
+      return false;
     }
+    freq = _freq;
+    _freqFresh = false;
+    return true;
+  }
 
-    if (!_socket.available()) {
-      Serial.println("CAT command timeout");
-      return "";
+  bool requestPending() const override { return _requestPending; }
+
+  // A WiFiClient socket cannot wake a task, so an outstanding reply is
+  // polled every RX_POLL_MS; everything else is timed or event driven.
+  unsigned long msUntilWork(unsigned long now) override {
+    switch (_socketState) {
+      case READY_TO_CONNECT: {
+        if (_connectNow) {
+          return 0;
+        }
+        unsigned long elapsed = now - _lastConnectAttempt;
+        unsigned long backoff = _getBackoffDelay();
+        return elapsed >= backoff ? 0 : backoff - elapsed;
+      }
+      case CONNECTED:
+        return _requestPending ? RX_POLL_MS : ULONG_MAX;
+      case DISCONNECTED:
+      default:
+        return ULONG_MAX;   // GOT_IP event notifies
     }
+  }
 
-    String response;
-    response.reserve(64); // Pre-allocate to avoid fragmentation
-    while (_socket.available()) {
-      response += static_cast<char>(_socket.read());
+  const char* endpointHost() const override { return _host; }
+  uint16_t endpointPort() const override { return _hostPort; }
+
+  // The cached endpoint gets one attempt, after a failure the configured
+  // server is used until the next boot
+  void preferEndpoint(const char* host, uint16_t port) override {
+    if (host == NULL || host[0] == '\0' || port == 0 ||
+        (strcmp(host, _serverIP) == 0 && port == _port)) {
+      return;
+    }
+    strncpy(_cachedHost, host, HOST_MAX - 1);
+    _cachedHost[HOST_MAX - 1] = '\0';
+    _host = _cachedHost;
+    _hostPort = port;
+  }
+
+  // Last association (any client, the WiFi owner applies it in begin());
+  // reuseIp also takes the address over as a static IP
+  static void setWifiCache(const WifiCache& cache, bool reuseIp) {
+    Link& link = _link();
+    link.cache = cache;
+    link.cache.ssid[sizeof(link.cache.ssid) - 1] = '\0';
+    link.reuseIp = reuseIp;
+  }
+
+  // A new association to save; true once per address, call from the backend
+  static bool takeWifiCache(WifiCache& cache) {
+    Link& link = _link();
+    if (!link.learnedFresh.load(std::memory_order_acquire)) {
+      return false;
     }
-    return response;
+    cache = link.learned;
+    link.learnedFresh.store(false, std::memory_order_release);
+    return true;
+  }
+
+  // Modem sleep: the radio only wakes for the AP's DTIM beacons, replies
+  // then take up to one DTIM interval (typ. 100-300ms) longer
+  void setPowerSave(bool enabled) override {
+    WiFi.setSleep(enabled ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE);
   }
 
 private:
   enum SocketState {
     DISCONNECTED,
     READY_TO_CONNECT,
-    CONNECTING,
     CONNECTED
   };
 
-  static const uint16_t CONNECT_TIMEOUT_MS = 2000;
+  // connect() blocks the backend, every station's polling and protection
+  // with it, for up to this long; a rigctld on the LAN answers in a few ms
+  static const uint16_t CONNECT_TIMEOUT_MS = 150;
   static const uint16_t INITIAL_BACKOFF_MS = 500;
   static const uint16_t MAX_BACKOFF_MS = 30000;
   static const uint8_t MAX_RETRIES = 10;
+  static const uint8_t RX_LINE_MAX = 64;
+  static const uint8_t RX_POLL_MS = 5;
+  static const uint8_t HOST_MAX = 40;
 
+  NetClient& _socket;
   const char* _ssid;
   const char* _password;
   const char* _serverIP;
   uint16_t _port;
+  const char* _host;              // endpoint in use: _serverIP or _cachedHost
+  uint16_t _hostPort;
+  char _cachedHost[HOST_MAX];
   uint16_t _timeout;
-  WiFiClient _socket;
+  bool _ownsWifi;
   
   SocketState _socketState;
   unsigned long _lastConnectAttempt;
   uint8_t _retryCount;
+  std::atomic<bool> _connectNow;   // set by GOT_IP (WiFi event task) or the endpoint fallback
+
+  // Line-buffered receive state
+  char _line[RX_LINE_MAX];
+  uint8_t _lineLen;
+  bool _requestPending;
+  unsigned long _requestSentAt;
+  int64_t _requestSentUs;
+  uint32_t _replyFreq;
+  uint32_t _freq;
+  bool _freqFresh;
+
+  // State of the shared station interface. The event task writes pending and
+  // cache, and hands learned to the backend while learnedFresh is false.
+  struct Link {
+    WifiCache cache;              // used for the next fast join
+    WifiCache pending;            // being filled by CONNECTED / GOT_IP
+    WifiCache learned;
+    std::atomic<bool> learnedFresh;
+    bool reuseIp;
+    bool staticIp;                // cache.ip configured instead of DHCP
+    bool fastBegin;               // last begin() skipped the scan
+    bool fastFailed;
+    bool associated;
+  };
+
+  static bool& _wifiStarted() {
+    static bool started = false;
+    return started;
+  }
+
+  static Link& _link() {
+    static Link link;             // zero-initialized: no cache, DHCP
+    return link;
+  }
+
+  bool _cacheMatches() const {
+    const WifiCache& cache = _link().cache;
+    return cache.channel != 0 && strcmp(cache.ssid, _ssid) == 0;
+  }
+
+  void _beginWifi() {
+    Link& link = _link();
+    link.fastBegin = _cacheMatches() && !link.fastFailed;
+    if (link.fastBegin) {
+      WiFi.begin(_ssid, _password, link.cache.channel, link.cache.bssid);
+    } else {
+      WiFi.begin(_ssid, _password);
+    }
+  }
+
+  // GOT_IP on the owner: complete the association record and hand it over
+  void _learn(const arduino_event_info_t& info) {
+    Link& link = _link();
+    strncpy(link.pending.ssid, _ssid, sizeof(link.pending.ssid) - 1);
+    link.pending.ssid[sizeof(link.pending.ssid) - 1] = '\0';
+    link.pending.ip = info.got_ip.ip_info.ip.addr;
+    link.pending.gateway = info.got_ip.ip_info.gw.addr;
+    link.pending.mask = info.got_ip.ip_info.netmask.addr;
+    link.pending.dns = (uint32_t)WiFi.dnsIP();
+    link.cache = link.pending;
+    if (!link.learnedFresh.load(std::memory_order_acquire)) {
+      link.learned = link.pending;
+      link.learnedFresh.store(true, std::memory_order_release);
+    }
+  }
+
+  // The reused address does not reach the server (taken by another host?): ask DHCP
+  bool _dropStaticIp() {
+    Link& link = _link();
+    if (!_ownsWifi || !link.staticIp) {
+      return false;
+    }
+    Serial.println("Saved IP address unreachable, asking DHCP");
+    link.staticIp = false;
+    WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+    return true;
+  }
 
   void _attemptSocketConnect() {
     Serial.println("Attempting CAT-Server connection...");
-    _socket.connect(_serverIP, _port);
-    _socketState = CONNECTING;
     _lastConnectAttempt = millis();
+    if (_socket.connect(_host, _hostPort, CONNECT_TIMEOUT_MS) == 1 && _socket.connected()) {
+      Serial.println("CAT-Server connected");
+      _socketState = CONNECTED;
+      _retryCount = 0;
+      return;
+    }
+
+    Serial.println("Socket connect timeout");
+    _socket.stop();
+    if (_useConfiguredServer()) {
+      // A different server, so no backoff; but on the next update(), one
+      // connect timeout per backend pass
+      _socketState = READY_TO_CONNECT;
+      _connectNow = true;
+      return;
+    }
+    if (_dropStaticIp()) {
+      _socketState = DISCONNECTED;   // until DHCP has an address
+      return;
+    }
+    _socketState = READY_TO_CONNECT;
+    _retryCount++;
+
+    if (_retryCount >= MAX_RETRIES) {
+      Serial.println("Max retries reached, waiting longer...");
+      _retryCount = MAX_RETRIES; // Cap it
+    }
+  }
+
+  bool _useConfiguredServer() {
+    if (_host == _serverIP) {
+      return false;
+    }
+    Serial.println("Cached CAT-Server failed, using the configured one");
+    _host = _serverIP;
+    _hostPort = _port;
+    return true;
+  }
+
+  // Drain whatever has arrived, never waits for more
+  void _receive(unsigned long now) {
+    while (_socket.available()) {
+      char c = static_cast<char>(_socket.read());
+
+      if (c == '\n') {
+        _line[_lineLen] = '\0';
+        logFrame(FrameLog::CAT_RX, _line, _lineLen);
+        _handleLine();
+        _lineLen = 0;
+      } else if (c != '\r' && _lineLen < RX_LINE_MAX - 1) {
+        _line[_lineLen++] = c;
+      }
+    }
+
+    if (_requestPending && now - _requestSentAt >= _timeout) {
+      Serial.println("CAT command timeout");
+      LatencyStats::count(LatencyStats::C_CAT_TIMEOUT);
+      _resetReceiver();
+    }
+  }
+
+  void _handleLine() {
+    // Extended response: "get_freq:", "Frequency: 14250000", "RPRT 0"
+    if (strncmp(_line, "Frequency:", 10) == 0) {
+      _replyFreq = strtoul(_line + 10, NULL, 10);
+      return;
+    }
+
+    if (strncmp(_line, "RPRT", 4) == 0) {
+      int code = atoi(_line + 4);
+      if (code == 0 && _replyFreq > 0) {
+        _freq = _replyFreq;
+        _freqFresh = true;
+      } else if (code != 0) {
+        Serial.print("CAT error: ");
+        Serial.println(_line);
+        LatencyStats::count(LatencyStats::C_CAT_ERROR);
+      }
+      _replyDone();
+      _replyFreq = 0;
+      return;
+    }
+
+    // Plain response (server without extended mode): a bare number
+    if (_lineLen > 0 && _line[0] >= '0' && _line[0] <= '9') {
+      _freq = strtoul(_line, NULL, 10);
+      _freqFresh = _freq > 0;
+      _replyDone();
+    }
+  }
+
+  void _replyDone() {
+    if (_requestPending) {
+      LatencyStats::record(LatencyStats::T_CAT_REPLY, (uint32_t)(esp_timer_get_time() - _requestSentUs));
+    }
+    _requestPending = false;
+  }
+
+  void _resetReceiver() {
+    _lineLen = 0;
+    _requestPending = false;
+    _replyFreq = 0;
   }
 
   unsigned long _getBackoffDelay() {
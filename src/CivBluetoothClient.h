@@ -0,0 +1,244 @@
+#pragma once
+#include <BluetoothSerial.h>
+#include <atomic>
+#include "CatSource.h"
+#include "LatencyStats.h"
+
+// Direct CI-V link to the IC-705 over Bluetooth SPP, no rigctld host needed.
+//
+// With CI-V transceive enabled the radio broadcasts every frequency change
+// as an unsolicited "00" frame. A "03" query is only sent as a fallback when
+// the radio has been silent for QUERY_FALLBACK_MS (e.g. transceive turned off).
+class CivBluetoothClient : public CatSource {
+public:
+  CivBluetoothClient(const char* deviceName, uint8_t radioAddr,
+                     uint8_t ctrlAddr, uint16_t timeout)
+      : _deviceName(deviceName), _radioAddr(radioAddr), _ctrlAddr(ctrlAddr),
+        _timeout(timeout), _linkUp(false), _frameLen(0),
+        _requestPending(false), _requestSentAt(0), _requestSentUs(0), _lastFrameAt(0),
+        _freq(0), _freqFresh(false) {}
+
+  void begin() override {
+    Serial.println("Starting Bluetooth (CI-V)...");
+    _instance() = this;
+    _bt.register_callback(_sppEvent);        // wakes the backend on incoming data
+    _bt.begin("KXPA100-Controller", true);   // master role
+
+    // connect() blocks for seconds, keep it away from the backend task
+    xTaskCreatePinnedToCore(_connectTask, "CivConnect", 3072, this, 0, NULL, 0);
+  }
+
+  // Call this regularly from your loop/task
+  void update() override {
+    bool up = _bt.connected(0);
+    if (up != _linkUp) {
+      Serial.println(up ? "CI-V device connected" : "CI-V device disconnected");
+      if (!up) {
+        LatencyStats::count(LatencyStats::C_CAT_RECONNECT);
+      }
+      _linkUp = up;
+      _resetReceiver();
+    }
+    if (up) {
+      _receive(millis());
+    }
+  }
+
+  bool isConnected() override {
+    return _linkUp;
+  }
+
+  // Fallback query, only sent when no frame has arrived for a while
+  bool requestFrequency() override {
+    unsigned long now = millis();
+    if (!_linkUp || _requestPending || now - _lastFrameAt < QUERY_FALLBACK_MS) {
+      return false;
+    }
+
+    const uint8_t query[] = { PREAMBLE, PREAMBLE, _radioAddr, _ctrlAddr, CMD_READ_FREQ, END_OF_MSG };
+    _bt.write(query, sizeof(query));
+    logFrame(FrameLog::CAT_TX, query, sizeof(query) - 1);
+    _requestPending = true;
+    _requestSentAt = now;
+    _requestSentUs = esp_timer_get_time();
+    _lastFrameAt = now;
+    return true;
+  }
+
+  // Incoming data notifies, only the timers need polling
+  unsigned long msUntilWork(unsigned long now) override {
+    if (!_linkUp) {
+      return LINK_POLL_MS;
+    }
+    if (_requestPending) {
+      unsigned long elapsed = now - _requestSentAt;
+      return elapsed >= _timeout ? 0 : _timeout - elapsed;
+    }
+    unsigned long silent = now - _lastFrameAt;
+    return silent >= QUERY_FALLBACK_MS ? 0 : QUERY_FALLBACK_MS - silent;
+  }
+
+  // Transceive pushes every change, requestFrequency() is only the fallback
+  bool needsPolling() const override { return false; }
+
+  // Latest decoded frequency in Hz; true only once per frame
+  bool takeFrequency(uint32_t& freq) override {
+    if (!_freqFresh) {
+      return false;
+    }
+    freq = _freq;
+    _freqFresh = false;
+    return true;
+  }
+
+private:
+  static const uint8_t PREAMBLE = 0xFE;
+  static const uint8_t END_OF_MSG = 0xFD;
+  static const uint8_t COLLISION = 0xFC;
+  static const uint8_t BROADCAST = 0x00;
+  static const uint8_t CMD_TRANSCEIVE_FREQ = 0x00;
+  static const uint8_t CMD_READ_FREQ = 0x03;
+  static const uint8_t CMD_NG = 0xFA;
+  static const uint8_t FRAME_MAX = 16;
+  static const uint16_t QUERY_FALLBACK_MS = 1000;
+  static const uint16_t RECONNECT_MS = 5000;
+  static const uint16_t LINK_POLL_MS = 500;
+
+  const char* _deviceName;
+  uint8_t _radioAddr;
+  uint8_t _ctrlAddr;
+  uint16_t _timeout;
+  BluetoothSerial _bt;
+  std::atomic<bool> _linkUp;
+
+  // Frame assembly state: FE FE <to> <from> <cmd> [data...] FD
+  uint8_t _frame[FRAME_MAX];
+  uint8_t _frameLen;
+  bool _requestPending;
+  unsigned long _requestSentAt;
+  int64_t _requestSentUs;
+  unsigned long _lastFrameAt;
+  uint32_t _freq;
+  bool _freqFresh;
+
+  // SPP callbacks carry no context, there is one client per firmware
+  static CivBluetoothClient*& _instance() {
+    static CivBluetoothClient* instance = NULL;
+    return instance;
+  }
+
+  static void _sppEvent(esp_spp_cb_event_t event, esp_spp_cb_param_t* param) {
+    // Runs after BluetoothSerial has queued the data
+    CivBluetoothClient* self = _instance();
+    if (self != NULL && (event == ESP_SPP_DATA_IND_EVT || event == ESP_SPP_OPEN_EVT ||
+                         event == ESP_SPP_CLOSE_EVT)) {
+      self->notify();
+    }
+  }
+
+  static void _connectTask(void* arg) {
+    CivBluetoothClient* self = static_cast<CivBluetoothClient*>(arg);
+    while (true) {
+      if (!self->_bt.connected(0)) {
+        Serial.print("Connecting to CI-V device ");
+        Serial.println(self->_deviceName);
+        if (!self->_bt.connect(self->_deviceName)) {
+          Serial.println("CI-V connect failed");
+        }
+      }
+      vTaskDelay(pdMS_TO_TICKS(RECONNECT_MS));
+    }
+  }
+
+  // Drain whatever has arrived, never waits for more
+  void _receive(unsigned long now) {
+    while (_bt.available()) {
+      uint8_t b = static_cast<uint8_t>(_bt.read());
+
+      if (b == PREAMBLE) {
+        // FE never appears inside a frame, so it always (re)starts one
+        if (_frameLen == 0 || _frameLen > 2) {
+          _frameLen = 0;
+        }
+        if (_frameLen < 2) {
+          _frame[_frameLen++] = b;
+        }
+      } else if (b == END_OF_MSG) {
+        if (_frameLen >= 5) {
+          logFrame(FrameLog::CAT_RX, _frame, _frameLen);
+          _handleFrame(now);
+        }
+        _frameLen = 0;
+      } else if (b == COLLISION || _frameLen < 2 || _frameLen >= FRAME_MAX) {
+        _frameLen = 0;
+      } else {
+        _frame[_frameLen++] = b;
+      }
+    }
+
+    if (_requestPending && now - _requestSentAt >= _timeout) {
+      Serial.println("CI-V command timeout");
+      LatencyStats::count(LatencyStats::C_CAT_TIMEOUT);
+      _requestPending = false;
+    }
+  }
+
+  void _handleFrame(unsigned long now) {
+    uint8_t to = _frame[2];
+    uint8_t from = _frame[3];
+    uint8_t cmd = _frame[4];
+    const uint8_t* data = _frame + 5;
+    uint8_t dataLen = _frameLen - 5;
+
+    // Ignore our own echo and traffic between other stations
+    if (from != _radioAddr || (to != BROADCAST && to != _ctrlAddr)) {
+      return;
+    }
+    _lastFrameAt = now;
+
+    if (cmd == CMD_NG) {
+      Serial.println("CI-V command rejected");
+      LatencyStats::count(LatencyStats::C_CAT_ERROR);
+      _requestPending = false;
+      return;
+    }
+
+    if (cmd != CMD_TRANSCEIVE_FREQ && cmd != CMD_READ_FREQ) {
+      return;
+    }
+    if (cmd == CMD_READ_FREQ && _requestPending) {
+      LatencyStats::record(LatencyStats::T_CAT_REPLY, (uint32_t)(esp_timer_get_time() - _requestSentUs));
+      _requestPending = false;
+    }
+
+    uint32_t freq;
+    if (_decodeBcd(data, dataLen, freq) && freq > 0) {
+      _freq = freq;
+      _freqFresh = true;
+    }
+  }
+
+  // Frequency as packed BCD, least significant byte first: 0x00 0x00 0x25 0x14 0x00 = 14.250.000 Hz
+  static bool _decodeBcd(const uint8_t* data, uint8_t len, uint32_t& out) {
+    if (len < 4 || len > 5) {
+      return false;
+    }
+    uint32_t value = 0;
+    for (int8_t i = len - 1; i >= 0; i--) {
+      uint8_t hi = data[i] >> 4;
+      uint8_t lo = data[i] & 0x0F;
+      if (hi > 9 || lo > 9) {
+        return false;
+      }
+      value = value * 100 + hi * 10 + lo;
+    }
+    out = value;
+    return true;
+  }
+
+  void _resetReceiver() {
+    _frameLen = 0;
+    _requestPending = false;
+    _lastFrameAt = 0;
+  }
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <Arduino.h>
+
+// Generated by web/embed_page.py from web/dashboard.html, do not edit.
+// 3620 bytes of HTML, gzipped; served as-is with Content-Encoding: gzip
+const uint8_t DASHBOARD_PAGE_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x57, 0x6d, 0x6f, 0xdb, 0x36,
+  0x10, 0xfe, 0xee, 0x5f, 0xc1, 0xb2, 0x58, 0x20, 0xcd, 0x8a, 0x2c, 0xbb, 0xa9, 0x11, 0x58, 0x56,
+  0x82, 0x34, 0x6d, 0xb1, 0x6e, 0x7d, 0x43, 0x93, 0xb5, 0x1b, 0x0c, 0x63, 0xa0, 0x44, 0x2a, 0x26,
+  0x2c, 0x89, 0x06, 0x49, 0xf9, 0x65, 0xae, 0xff, 0xd3, 0x7e, 0xc3, 0x7e, 0xd9, 0x8e, 0x14, 0xfd,
+  0x56, 0xb7, 0x43, 0xb7, 0x0f, 0x09, 0xc5, 0x23, 0xef, 0xb9, 0xe3, 0xf1, 0xee, 0x39, 0x7a, 0xf8,
+  0xe8, 0xf9, 0xbb, 0xdb, 0xfb, 0xdf, 0xdf, 0xbf, 0x40, 0x13, 0x5d, 0x16, 0x57, 0xad, 0xe1, 0x76,
+  0x60, 0x84, 0xc2, 0x50, 0x32, 0x4d, 0x50, 0x36, 0x21, 0x52, 0x31, 0x9d, 0xe0, 0x5a, 0xe7, 0xe7,
+  0x97, 0x78, 0x2b, 0xae, 0x48, 0xc9, 0x12, 0x3c, 0xe7, 0x6c, 0x31, 0x13, 0x52, 0x63, 0x94, 0x89,
+  0x4a, 0xb3, 0x0a, 0xb6, 0x2d, 0x38, 0xd5, 0x93, 0x84, 0xb2, 0x39, 0xcf, 0xd8, 0xb9, 0x9d, 0x04,
+  0x88, 0x57, 0x5c, 0x73, 0x52, 0x9c, 0xab, 0x8c, 0x14, 0x2c, 0xe9, 0x1a, 0x10, 0xcd, 0x75, 0xc1,
+  0xae, 0x7e, 0xf9, 0xed, 0xfd, 0x4d, 0x37, 0x8a, 0xd0, 0x2d, 0x68, 0x4b, 0x51, 0x0c, 0x3b, 0x8d,
+  0xb8, 0x35, 0x54, 0x7a, 0x65, 0xc6, 0x54, 0xd0, 0xd5, 0x3a, 0x87, 0xc5, 0xf3, 0x9c, 0x94, 0xbc,
+  0x58, 0x0d, 0x14, 0xa9, 0xd4, 0xb9, 0x62, 0x92, 0xe7, 0x71, 0x4a, 0xb2, 0xe9, 0x83, 0x14, 0x75,
+  0x45, 0x07, 0x8f, 0x19, 0x63, 0x71, 0x49, 0xe4, 0x03, 0xaf, 0x06, 0x51, 0x3c, 0x23, 0x94, 0xf2,
+  0xea, 0x61, 0x70, 0x39, 0x5b, 0x6e, 0x5a, 0xa1, 0xd2, 0xeb, 0xc3, 0x9d, 0x79, 0x0e, 0x9a, 0x42,
+  0x52, 0x26, 0xcf, 0x25, 0xa1, 0xbc, 0x56, 0x83, 0xfe, 0x6c, 0xb9, 0x53, 0xe9, 0x46, 0x30, 0xd9,
+  0x02, 0xa1, 0x08, 0xb9, 0xf9, 0xb2, 0x39, 0xc8, 0xe0, 0xa2, 0x17, 0x19, 0xcc, 0x49, 0x6f, 0x7d,
+  0xb0, 0x07, 0xcc, 0xc4, 0xd6, 0x45, 0xc5, 0xff, 0x64, 0x83, 0xae, 0xb5, 0xaa, 0x49, 0x5a, 0xb0,
+  0xb5, 0xb3, 0x93, 0x89, 0xa2, 0x20, 0x33, 0xc5, 0x06, 0xdb, 0x8f, 0xb8, 0x41, 0x83, 0x83, 0xff,
+  0x00, 0x5b, 0xe9, 0x7a, 0x6b, 0xfd, 0xc9, 0x6c, 0x89, 0x2e, 0x40, 0x5d, 0xd3, 0x41, 0xce, 0xa5,
+  0xd2, 0xe7, 0xd9, 0x84, 0x17, 0x74, 0x0d, 0x6a, 0x42, 0x0e, 0x1e, 0xf7, 0xfb, 0x7d, 0xa7, 0x78,
+  0x61, 0xf4, 0xc2, 0x79, 0x13, 0x98, 0x05, 0xe3, 0x0f, 0x13, 0x3d, 0x48, 0x45, 0x41, 0x4f, 0xdc,
+  0x08, 0x45, 0x9e, 0x6f, 0xd5, 0xb3, 0x28, 0xda, 0x84, 0xa2, 0xda, 0x4e, 0xa3, 0xcb, 0x68, 0xd3,
+  0x4a, 0x6b, 0xad, 0x45, 0x15, 0x28, 0x56, 0xb0, 0x4c, 0xaf, 0x0f, 0xb4, 0x9f, 0xee, 0xc3, 0x70,
+  0xd1, 0x38, 0x05, 0x07, 0xdd, 0x47, 0xd6, 0xcc, 0xad, 0x81, 0xc7, 0x05, 0xaf, 0xa6, 0x87, 0x8a,
+  0x70, 0x84, 0x78, 0xef, 0xef, 0xa6, 0x35, 0xec, 0xb8, 0x9b, 0x1c, 0x76, 0x5c, 0x52, 0x99, 0x2b,
+  0x85, 0x81, 0xf2, 0x39, 0xe2, 0x34, 0xc1, 0x06, 0x00, 0x5f, 0x41, 0xf6, 0x54, 0xe0, 0x02, 0x60,
+  0x87, 0x61, 0x38, 0xec, 0xc0, 0xe2, 0xc1, 0x16, 0xa5, 0x89, 0xe6, 0xa2, 0x52, 0xf8, 0x6a, 0xbb,
+  0xa2, 0x32, 0xc9, 0x67, 0xfa, 0xaa, 0x35, 0x27, 0x12, 0xbd, 0x79, 0xf7, 0xfc, 0xc5, 0x5d, 0x32,
+  0xc2, 0xcf, 0x56, 0x33, 0xa2, 0x14, 0x0e, 0xf0, 0x1b, 0x52, 0xd5, 0xa4, 0x80, 0x8f, 0x9b, 0x5a,
+  0x8b, 0x12, 0x54, 0x33, 0x3c, 0x0e, 0x52, 0x52, 0x51, 0x95, 0x8c, 0xc6, 0xc1, 0x42, 0x05, 0x4a,
+  0xc3, 0x47, 0xdc, 0xca, 0xeb, 0x2a, 0x33, 0xb8, 0x88, 0x15, 0x9e, 0x0e, 0xb2, 0x60, 0xe9, 0xaf,
+  0x0d, 0x1e, 0x4b, 0xa8, 0xc8, 0xea, 0x12, 0x72, 0x39, 0xcc, 0x24, 0x23, 0x9a, 0xbd, 0x28, 0x98,
+  0x99, 0x79, 0xda, 0x8f, 0x79, 0xee, 0x65, 0x3e, 0x0b, 0xb3, 0x02, 0x2c, 0xbd, 0x35, 0x05, 0x90,
+  0x19, 0xd1, 0xf2, 0x51, 0x52, 0xd5, 0x45, 0x01, 0x0b, 0x9a, 0x2d, 0xf5, 0xad, 0x2b, 0x84, 0x65,
+  0x2c, 0x99, 0xae, 0x25, 0xc0, 0x6f, 0xf6, 0xa6, 0x72, 0xbe, 0xf4, 0xe6, 0x81, 0x0a, 0xa8, 0xbf,
+  0x6e, 0x56, 0xbd, 0x79, 0x47, 0xf9, 0xa1, 0x16, 0x2f, 0xf9, 0x92, 0x51, 0x8f, 0xfa, 0x07, 0x7b,
+  0x15, 0xab, 0xa8, 0x37, 0x67, 0x32, 0x0d, 0x78, 0x30, 0xf7, 0xd7, 0x60, 0x68, 0xa1, 0xce, 0xce,
+  0x16, 0x2a, 0x04, 0xaf, 0xe8, 0xea, 0x0e, 0x82, 0xc2, 0x92, 0xa4, 0xeb, 0x83, 0x60, 0xb7, 0xb3,
+  0x8d, 0x11, 0x6e, 0x73, 0xfb, 0x7f, 0x7e, 0x08, 0x95, 0xd6, 0x90, 0x47, 0x1e, 0x0f, 0x0a, 0x92,
+  0xb2, 0xc2, 0x5f, 0xb7, 0x10, 0x32, 0x27, 0xa5, 0x09, 0x9c, 0x1c, 0x43, 0x44, 0x21, 0x56, 0x4a,
+  0x63, 0x3f, 0x50, 0xc9, 0x7a, 0x13, 0x48, 0xb1, 0x80, 0x40, 0x8d, 0xb0, 0x89, 0x18, 0x2c, 0x3c,
+  0x33, 0xc3, 0x38, 0x18, 0xe1, 0x99, 0x58, 0x30, 0x09, 0x82, 0xf7, 0x76, 0x34, 0x12, 0xb5, 0x30,
+  0xf3, 0xbb, 0x4f, 0x1f, 0xec, 0x4c, 0xb3, 0x72, 0x06, 0xd3, 0x7b, 0x33, 0x8c, 0x03, 0x30, 0x81,
+  0xd0, 0x08, 0xcf, 0x45, 0xa1, 0x41, 0xf8, 0x11, 0x06, 0xf2, 0xc0, 0xec, 0x3e, 0x52, 0x19, 0xc9,
+  0x8d, 0x09, 0x52, 0x45, 0xac, 0xa4, 0x14, 0x94, 0x99, 0x7b, 0x33, 0x83, 0x99, 0xe7, 0xa4, 0x2e,
+  0xb4, 0xb9, 0xc9, 0x97, 0xcd, 0x87, 0x91, 0xd9, 0x34, 0x09, 0xf0, 0x6b, 0x33, 0x8c, 0xe1, 0xf2,
+  0x10, 0xa2, 0x21, 0x99, 0xcd, 0xe0, 0xe0, 0xb7, 0xa6, 0x46, 0x3c, 0x73, 0x92, 0x49, 0x0f, 0x07,
+  0xe6, 0x22, 0x9a, 0x63, 0x5e, 0xe3, 0xbb, 0x26, 0x6f, 0x20, 0x18, 0x56, 0x30, 0xc0, 0x8e, 0x6d,
+  0xb0, 0xef, 0xc7, 0x2e, 0x04, 0xda, 0x86, 0xc0, 0x56, 0x2b, 0xb6, 0x42, 0x73, 0xfa, 0x30, 0x17,
+  0xf2, 0x05, 0xc9, 0x26, 0xde, 0x36, 0x7e, 0x9e, 0x6c, 0x52, 0x43, 0xcb, 0x66, 0xbb, 0x84, 0xbd,
+  0x5a, 0x9e, 0xd8, 0xd7, 0xd4, 0xd9, 0x97, 0xa3, 0xee, 0x18, 0x6c, 0xa8, 0x91, 0x1c, 0x45, 0xe3,
+  0x71, 0xb2, 0x5d, 0xc3, 0x26, 0xd0, 0xe7, 0xa7, 0xba, 0x6e, 0x1f, 0xc8, 0x8f, 0xc4, 0x5a, 0xfa,
+  0x1b, 0xff, 0xf4, 0xa4, 0x7a, 0xe7, 0x3c, 0x94, 0xad, 0xc5, 0x6e, 0xca, 0x17, 0x70, 0x6d, 0x92,
+  0x9f, 0x7a, 0x9f, 0x06, 0x55, 0xe3, 0xbf, 0xb0, 0xdb, 0xc5, 0xcc, 0x48, 0x9d, 0xab, 0xa9, 0x1f,
+  0x8b, 0x70, 0x4e, 0x8a, 0x9a, 0x25, 0x55, 0x0c, 0x40, 0x47, 0xa6, 0x84, 0x73, 0xc0, 0xe8, 0xa6,
+  0x56, 0xb7, 0x21, 0x0c, 0xa7, 0x8b, 0xef, 0x98, 0x46, 0x36, 0x4d, 0xc0, 0x34, 0x50, 0x4b, 0x56,
+  0xf0, 0x6c, 0x9a, 0xec, 0xcc, 0xfa, 0x6b, 0x9b, 0x97, 0x2e, 0x91, 0xb8, 0x61, 0x99, 0xc6, 0x92,
+  0xbf, 0x39, 0x3d, 0x15, 0x2c, 0xfa, 0xf1, 0xb1, 0x28, 0xfd, 0x52, 0x60, 0x1d, 0x90, 0xee, 0xf6,
+  0x6c, 0xd9, 0x9f, 0x9e, 0xb5, 0xdc, 0x9e, 0x75, 0x79, 0xea, 0x6f, 0xe9, 0xc7, 0xcb, 0x6f, 0xbb,
+  0xd9, 0x64, 0x21, 0x07, 0xfd, 0xcd, 0x17, 0x76, 0x97, 0x2e, 0x0c, 0xa3, 0x6e, 0xd0, 0x1b, 0x9f,
+  0x9a, 0x24, 0xdf, 0x34, 0x88, 0x6f, 0xde, 0xde, 0xe3, 0x36, 0xf9, 0x57, 0xb3, 0xc4, 0x15, 0x02,
+  0x58, 0x26, 0xdf, 0xb4, 0xbc, 0x63, 0xa4, 0x07, 0xa6, 0x1d, 0x1d, 0x3d, 0x5b, 0xbd, 0x02, 0xed,
+  0x1d, 0x35, 0xfa, 0x47, 0x7a, 0xd4, 0x6a, 0x19, 0x62, 0x28, 0x12, 0xf8, 0xdb, 0x32, 0x91, 0x8a,
+  0x5b, 0x9b, 0x56, 0xa7, 0x83, 0x9c, 0x16, 0xaa, 0x2f, 0x03, 0xd3, 0xde, 0xab, 0x07, 0x46, 0x51,
+  0xdd, 0xed, 0x07, 0x48, 0x4f, 0x58, 0x65, 0xfe, 0xed, 0xa4, 0x39, 0x67, 0x05, 0x55, 0xd0, 0xbf,
+  0xd1, 0xf3, 0x57, 0x1f, 0xee, 0x7f, 0xff, 0xe3, 0x47, 0x94, 0x72, 0x8d, 0x6c, 0x5b, 0xdb, 0xb3,
+  0x0b, 0x65, 0x50, 0xdd, 0x5e, 0x5a, 0xe7, 0x3b, 0x66, 0x99, 0x27, 0x15, 0x5b, 0xa0, 0xe7, 0x44,
+  0x93, 0x8f, 0xf0, 0x40, 0xb0, 0x4b, 0x40, 0x2e, 0x4a, 0x8f, 0xe6, 0xe6, 0x04, 0xbf, 0xf2, 0x4a,
+  0x5f, 0x7a, 0x91, 0x3f, 0x0e, 0xca, 0x64, 0x27, 0xe8, 0xf6, 0xbd, 0x6e, 0xa0, 0x25, 0x64, 0x47,
+  0x20, 0x92, 0x27, 0xc6, 0x7d, 0x20, 0xbc, 0x47, 0xca, 0x6f, 0x5c, 0x77, 0xf3, 0xf2, 0xac, 0xdb,
+  0x04, 0x3b, 0x6d, 0x14, 0x5f, 0x19, 0x20, 0xd1, 0x6e, 0x43, 0xad, 0x85, 0x26, 0xcd, 0x8e, 0x08,
+  0x38, 0xbd, 0x4a, 0xa2, 0xb3, 0xb3, 0x74, 0xd8, 0x54, 0x45, 0xc1, 0xaa, 0x07, 0x3d, 0xb9, 0xb6,
+  0x93, 0x51, 0x3a, 0x1e, 0xe0, 0x6b, 0x6c, 0xb8, 0xdb, 0x6c, 0xf2, 0x6d, 0xa0, 0x5c, 0x15, 0xa4,
+  0x9b, 0xad, 0xa9, 0x1e, 0x5c, 0x51, 0x68, 0x59, 0xef, 0x08, 0xd6, 0x52, 0xb8, 0x33, 0x0e, 0x4e,
+  0x0b, 0xe7, 0x74, 0x37, 0x0a, 0xba, 0x3e, 0x30, 0xef, 0x27, 0x1c, 0x8b, 0x76, 0xd2, 0xdb, 0xa1,
+  0x5c, 0x18, 0x14, 0xc3, 0x8d, 0xff, 0x05, 0xe4, 0xef, 0xbf, 0x6e, 0xbf, 0x80, 0xb9, 0x34, 0x30,
+  0x40, 0xb8, 0xdf, 0x8d, 0x72, 0xac, 0xde, 0xed, 0x37, 0x71, 0x23, 0xa7, 0x71, 0x83, 0x04, 0x3c,
+  0x02, 0x25, 0x57, 0xd1, 0xb5, 0x4b, 0x5c, 0x13, 0xa4, 0x1d, 0xc4, 0x93, 0x5e, 0x03, 0x51, 0xd2,
+  0x53, 0x0c, 0x53, 0x3b, 0x47, 0x20, 0x25, 0xb5, 0xc1, 0x2f, 0xe9, 0xf0, 0xc9, 0xb5, 0xad, 0xd4,
+  0x51, 0x49, 0xc7, 0x47, 0x70, 0xfd, 0x8b, 0x06, 0x2e, 0x4f, 0x30, 0x86, 0x77, 0x8b, 0xf4, 0xcc,
+  0x64, 0x9a, 0x44, 0xf1, 0x74, 0x78, 0x19, 0x4f, 0x01, 0xd6, 0xae, 0x66, 0xc9, 0x41, 0xc6, 0x88,
+  0xf6, 0xd4, 0xb6, 0xe0, 0x47, 0x99, 0x9f, 0x42, 0x0f, 0x9c, 0xc6, 0x79, 0x3b, 0xb9, 0xd3, 0xd2,
+  0x3c, 0x1a, 0x72, 0x29, 0xca, 0x5b, 0x78, 0xa8, 0xde, 0x82, 0x23, 0xd0, 0xa2, 0x37, 0xc0, 0x82,
+  0xb6, 0x77, 0x1c, 0x87, 0xeb, 0xf3, 0x67, 0xa0, 0x5f, 0x13, 0x98, 0xcb, 0x7d, 0x60, 0x7a, 0x36,
+  0xb2, 0xa6, 0x4f, 0x7d, 0x3d, 0xb4, 0x2e, 0x37, 0xf7, 0xb1, 0x8d, 0xdc, 0x1d, 0x7d, 0xfc, 0xe2,
+  0x86, 0x7a, 0x4f, 0xfb, 0x5f, 0xf5, 0xd9, 0x06, 0xc8, 0xb4, 0xaf, 0x23, 0x7c, 0x2f, 0x3b, 0xeb,
+  0x5e, 0xdb, 0x86, 0x84, 0xf0, 0x00, 0x57, 0x02, 0x35, 0x9f, 0x7e, 0x1b, 0x16, 0x7a, 0xd7, 0xf8,
+  0xf6, 0xe6, 0xbe, 0x11, 0x9b, 0x8f, 0x1d, 0xc0, 0xfe, 0xdd, 0x81, 0xe7, 0xd0, 0xd5, 0x1a, 0x0c,
+  0x60, 0x9b, 0x01, 0x86, 0x77, 0x1e, 0x86, 0x86, 0x7f, 0xd0, 0xf2, 0xdd, 0x8b, 0xca, 0xb3, 0x35,
+  0x09, 0x1d, 0xdd, 0x14, 0xe4, 0x27, 0x96, 0xde, 0x89, 0x6c, 0xca, 0xb4, 0x87, 0x17, 0x6a, 0xd0,
+  0xe9, 0x40, 0x63, 0x14, 0x99, 0xa5, 0x82, 0x70, 0x22, 0x94, 0x6e, 0xe3, 0xce, 0x02, 0x98, 0x24,
+  0x86, 0x0e, 0x98, 0xf2, 0x8a, 0xc8, 0xd5, 0xfd, 0x6a, 0x06, 0xa6, 0x88, 0x94, 0x64, 0x05, 0x25,
+  0x9c, 0x43, 0xdb, 0x8f, 0x2d, 0x18, 0xb0, 0x99, 0x00, 0xb2, 0x39, 0x24, 0xb3, 0x6f, 0x32, 0x94,
+  0x6d, 0xdc, 0xfe, 0xd1, 0xd9, 0xb1, 0xf3, 0x8d, 0x51, 0xbc, 0xd9, 0x01, 0x66, 0x85, 0x50, 0xec,
+  0x7f, 0x23, 0x52, 0xae, 0x76, 0xa0, 0x01, 0x02, 0xce, 0x90, 0xab, 0xe6, 0x2d, 0x89, 0xa1, 0xa9,
+  0xe9, 0x7b, 0x5e, 0x32, 0x51, 0x6b, 0xcf, 0x6d, 0x09, 0x7a, 0x70, 0x89, 0xfe, 0xde, 0x74, 0xc9,
+  0x94, 0x82, 0xd7, 0xc9, 0xde, 0x38, 0xb3, 0x41, 0xb3, 0xf7, 0xaa, 0x21, 0x04, 0x22, 0x47, 0x2c,
+  0xa4, 0x40, 0x66, 0x89, 0x79, 0x8b, 0x9a, 0x7c, 0xc3, 0x6e, 0x43, 0xc3, 0x76, 0x93, 0xe4, 0xe7,
+  0xbb, 0x77, 0x6f, 0xc3, 0x99, 0xf9, 0x9d, 0xe4, 0x35, 0x3b, 0x5d, 0x2f, 0x4e, 0x26, 0x96, 0x96,
+  0x54, 0xdc, 0x3c, 0x39, 0xbf, 0x87, 0xc6, 0x39, 0xb8, 0x28, 0x7f, 0xba, 0x7f, 0xf3, 0xda, 0xd4,
+  0x85, 0x33, 0x32, 0x09, 0xb7, 0x1b, 0x4e, 0xbb, 0x4f, 0x11, 0x70, 0x48, 0x60, 0x1d, 0xce, 0x6a,
+  0x35, 0xf1, 0x76, 0xef, 0x3c, 0xdf, 0x35, 0x0e, 0x84, 0x36, 0xac, 0x50, 0xcc, 0x51, 0xf4, 0xd6,
+  0x37, 0x58, 0xd8, 0x98, 0x56, 0xb0, 0xcb, 0x91, 0xd8, 0xbc, 0xd3, 0xdd, 0x9b, 0x7a, 0xd8, 0x71,
+  0x2f, 0xf4, 0x4e, 0xf3, 0x63, 0xf0, 0x1f, 0x14, 0x3c, 0x1a, 0x8b, 0x24, 0x0e, 0x00, 0x00,
+};
+const size_t DASHBOARD_PAGE_GZ_LEN = sizeof(DASHBOARD_PAGE_GZ);
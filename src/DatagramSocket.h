@@ -0,0 +1,15 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Outbound UDP socket for the telemetry export.
+//
+// The firmware uses WiFiDatagramSocket (see WiFiDatagramSocket.h), the native
+// test environment a recorder.
+class DatagramSocket {
+public:
+  virtual ~DatagramSocket() {}
+
+  // One datagram; false if it could not be handed to the stack
+  virtual bool send(const char* host, uint16_t port, const uint8_t* data, size_t len) = 0;
+};
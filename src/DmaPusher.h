@@ -0,0 +1,53 @@
+#pragma once
+#include <M5Unified.h>
+#include "LatencyStats.h"
+
+// Pushes canvases to the panel with DMA and remembers which buffer is still
+// on the wire.
+//
+// push() returns as soon as the transfer is queued, so the UI composes the
+// next box while the previous one goes out over SPI. Only drawing into the
+// very canvas that is in flight has to wait (see reclaim()).
+class DmaPusher {
+public:
+  explicit DmaPusher(LGFX_Device& lcd)
+      : _lcd(lcd), _inFlight(NULL), _writing(false) {}
+
+  void begin() {
+    _lcd.initDMA();
+  }
+
+  void push(M5Canvas& canvas, int32_t x, int32_t y) {
+    if (!_writing) {
+      _lcd.startWrite();   // keep the bus until the transfer is done, see poll()
+      _writing = true;
+    }
+    // Palette canvases are expanded to RGB565 on the way into the DMA buffer
+    _lcd.pushImageDMA(x, y, canvas.width(), canvas.height(), canvas.getBuffer(),
+                      canvas.getColorDepth(), canvas.getPalette());
+    _inFlight = canvas.getBuffer();
+  }
+
+  // Call before drawing into a canvas; waits only if it is being transferred
+  void reclaim(M5Canvas& canvas) {
+    if (_inFlight != NULL && _inFlight == canvas.getBuffer()) {
+      LatencyStats::Scope timing(LatencyStats::T_DMA_WAIT);
+      _lcd.waitDMA();
+      _inFlight = NULL;
+    }
+  }
+
+  // Hands the bus back once the last transfer has finished, never waits
+  void poll() {
+    if (_writing && !_lcd.dmaBusy()) {
+      _lcd.endWrite();
+      _writing = false;
+      _inFlight = NULL;
+    }
+  }
+
+private:
+  LGFX_Device& _lcd;
+  const void* _inFlight;
+  bool _writing;
+};
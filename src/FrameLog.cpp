@@ -0,0 +1,146 @@
+#include "FrameLog.h"
+#include <esp_timer.h>
+
+//-----------------------------------------------------------------------------
+// Storage
+//-----------------------------------------------------------------------------
+
+static const char MAGIC[4] = { 'K', 'X', 'F', 'L' };
+
+static const char* const KIND_NAMES[] = { "kxpa tx", "kxpa rx", "cat tx", "cat rx" };
+
+static_assert(sizeof(KIND_NAMES) / sizeof(KIND_NAMES[0]) == FrameLog::KIND_COUNT,
+              "one name per kind");
+
+static void putU32(uint8_t* out, uint32_t v) {
+  out[0] = (uint8_t)v;
+  out[1] = (uint8_t)(v >> 8);
+  out[2] = (uint8_t)(v >> 16);
+  out[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t getU32(const uint8_t* in) {
+  return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+//-----------------------------------------------------------------------------
+// Reader
+//-----------------------------------------------------------------------------
+
+FrameLog::Reader::Reader(const uint8_t* data, size_t len)
+    : _data(NULL), _len(0), _pos(FILE_HEADER), _records(0), _lost(0) {
+  if (data == NULL || len < FILE_HEADER || memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+      data[4] != VERSION) {
+    return;
+  }
+  _data = data;
+  _len = len;
+  _records = getU32(data + 8);
+  _lost = getU32(data + 12);
+}
+
+bool FrameLog::Reader::next(Record& rec) {
+  if (_data == NULL || _pos + RECORD_HEADER > _len) {
+    return false;
+  }
+  const uint8_t* p = _data + _pos;
+  uint8_t len = p[5];
+  if (_pos + RECORD_HEADER + len > _len || len > PAYLOAD_MAX || (p[4] & 0x0F) >= KIND_COUNT) {
+    return false;
+  }
+  rec.timeUs = getU32(p);
+  rec.station = p[4] >> 4;
+  rec.kind = (Kind)(p[4] & 0x0F);
+  rec.len = len;
+  memcpy(rec.data, p + RECORD_HEADER, len);
+  _pos += RECORD_HEADER + len;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+FrameLog::FrameLog()
+    : _buf(NULL), _size(0), _head(0), _used(0), _records(0), _lost(0),
+      _startUs(0), _capturing(false) {}
+
+void FrameLog::setBuffer(uint8_t* buffer, size_t size) {
+  _buf = buffer;
+  _size = buffer != NULL ? size : 0;
+  _capturing = false;
+  _head = 0;
+  _used = 0;
+}
+
+void FrameLog::start() {
+  _head = 0;
+  _used = 0;
+  _records = 0;
+  _lost = 0;
+  _startUs = esp_timer_get_time();
+  _capturing = _buf != NULL && _size > RECORD_HEADER + PAYLOAD_MAX;
+}
+
+void FrameLog::record(uint8_t station, Kind kind, const void* data, size_t len, int64_t atUs) {
+  if (!_capturing) {
+    return;
+  }
+  if (len > PAYLOAD_MAX) {
+    len = PAYLOAD_MAX;
+  }
+  size_t need = RECORD_HEADER + len;
+  while (_size - _used < need) {
+    dropOldest();
+  }
+
+  uint8_t header[RECORD_HEADER];
+  putU32(header, atUs > _startUs ? (uint32_t)(atUs - _startUs) : 0);
+  header[4] = (uint8_t)((station << 4) | kind);
+  header[5] = (uint8_t)len;
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < need; ++i) {
+    _buf[(_head + i) % _size] = i < RECORD_HEADER ? header[i] : bytes[i - RECORD_HEADER];
+  }
+  _head = (_head + need) % _size;
+  _used += need;
+  _records++;
+}
+
+size_t FrameLog::dump(Print& out) const {
+  uint8_t header[FILE_HEADER] = { 0 };
+  memcpy(header, MAGIC, sizeof(MAGIC));
+  header[4] = VERSION;
+  putU32(header + 8, _records);
+  putU32(header + 12, _lost);
+  size_t written = out.write((const char*)header, sizeof(header));
+  if (_used == 0) {
+    return written;
+  }
+
+  // Oldest first: up to the end of the buffer, then the wrapped part
+  size_t tail = (_head + _size - _used) % _size;
+  size_t first = min(_used, _size - tail);
+  written += out.write((const char*)_buf + tail, first);
+  if (first < _used) {
+    written += out.write((const char*)_buf, _used - first);
+  }
+  return written;
+}
+
+const char* FrameLog::name(Kind kind) {
+  return kind < KIND_COUNT ? KIND_NAMES[kind] : "?";
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+void FrameLog::dropOldest() {
+  size_t tail = (_head + _size - _used) % _size;
+  size_t size = RECORD_HEADER + at(tail + 5);
+  _used -= size;
+  _records--;
+  _lost++;
+}
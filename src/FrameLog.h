@@ -0,0 +1,114 @@
+#ifndef FRAMELOG_H
+#define FRAMELOG_H
+
+#include <Arduino.h>
+
+// Capture of every frame on the KXPA links and the CAT sources, for the
+// field unit that misbehaves once a day.
+//
+// Records go into a byte ring supplied by the caller (internal RAM or PSRAM,
+// allocated once); when it is full the oldest records are dropped. A record
+// is 6 bytes plus the frame:
+//
+//   u32 time   us since start(), little endian
+//   u8  tag    station << 4 | Kind
+//   u8  len    frame length, cut at PAYLOAD_MAX
+//   ...        frame bytes: KXPA as on the wire (with ';'), rigctld lines
+//              without '\n', CI-V frames without the closing FD
+//
+// dump() writes a 16 byte header ("KXFL", version, record and lost counts)
+// followed by the records oldest first; Reader walks that image again, e.g.
+// for ReplaySerialPort. KXPA TX is stamped when it is written, RX with the
+// arrival of its ';' in the UART task, so records follow the order the
+// backend saw them in and RX may be stamped before a TX logged ahead of it.
+//
+// One task at a time: record(), start(), stop() and dump() are not
+// synchronised. The backend owns the log; a stopped ring may be handed to
+// another task for dump() as long as nobody starts it meanwhile.
+class FrameLog {
+public:
+  enum Kind : uint8_t {
+    KXPA_TX = 0,
+    KXPA_RX,
+    CAT_TX,
+    CAT_RX,
+    KIND_COUNT
+  };
+
+  static const uint8_t VERSION = 1;
+  static const uint8_t PAYLOAD_MAX = 48;
+  static const size_t RECORD_HEADER = 6;
+  static const size_t FILE_HEADER = 16;
+
+  struct Record {
+    uint32_t timeUs;
+    uint8_t station;
+    Kind kind;
+    uint8_t len;
+    uint8_t data[PAYLOAD_MAX];
+  };
+
+  // Walks a dump() image in place
+  class Reader {
+  public:
+    Reader() : _data(NULL), _len(0), _pos(0), _records(0), _lost(0) {}
+    Reader(const uint8_t* data, size_t len);
+
+    bool valid() const { return _data != NULL; }
+    uint32_t records() const { return _records; }
+    uint32_t lost() const { return _lost; }
+
+    // Next record, false at the end or on a truncated tail
+    bool next(Record& rec);
+    void rewind() { _pos = FILE_HEADER; }
+
+  private:
+    const uint8_t* _data;
+    size_t _len;
+    size_t _pos;
+    uint32_t _records;
+    uint32_t _lost;
+  };
+
+  FrameLog();
+
+  // The ring, before start(); NULL stops recording for good
+  void setBuffer(uint8_t* buffer, size_t size);
+  bool hasBuffer() const { return _buf != NULL; }
+
+  // start() clears the ring and restarts the time base
+  void start();
+  void stop() { _capturing = false; }
+  bool capturing() const { return _capturing; }
+
+  // atUs is esp_timer time; no-op while stopped
+  void record(uint8_t station, Kind kind, const void* data, size_t len, int64_t atUs);
+  void record(uint8_t station, Kind kind, const char* text, int64_t atUs) {
+    record(station, kind, text, strlen(text), atUs);
+  }
+
+  uint32_t records() const { return _records; }
+  uint32_t lost() const { return _lost; }
+  size_t used() const { return _used; }
+  size_t dumpSize() const { return FILE_HEADER + _used; }
+
+  // Header and records oldest first; bytes written
+  size_t dump(Print& out) const;
+
+  static const char* name(Kind kind);
+
+private:
+  void dropOldest();
+  uint8_t at(size_t offset) const { return _buf[offset % _size]; }
+
+  uint8_t* _buf;
+  size_t _size;
+  size_t _head;                 // next write position
+  size_t _used;                 // bytes of complete records behind _head
+  uint32_t _records;
+  uint32_t _lost;               // dropped when the ring was full
+  int64_t _startUs;
+  bool _capturing;
+};
+
+#endif // FRAMELOG_H
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+#include "SerialPort.h"
+
+// SerialPort on one of the ESP32 UARTs
+class HardwareSerialPort : public SerialPort {
+public:
+  explicit HardwareSerialPort(HardwareSerial& serial) : _serial(serial) {}
+
+  void begin(uint32_t baud, int rxPin, int txPin, bool inverted) override {
+    _serial.begin(baud, SERIAL_8N1, rxPin, txPin, inverted);
+  }
+
+  bool isOpen() override { return (bool)_serial; }
+  int available() override { return _serial.available(); }
+  int read() override { return _serial.read(); }
+  size_t write(const char* data) override { return _serial.write(data); }
+
+  void onReceive(std::function<void(void)> callback) override {
+    _serial.onReceive(callback);
+  }
+
+private:
+  HardwareSerial& _serial;
+};
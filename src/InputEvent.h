@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+
+// Button event from the input task to the UI loop
+struct InputEvent {
+  enum Type : uint8_t {
+    PRESS,          // button went down
+    REPEAT,         // still held, auto-repeat step (BtnA/BtnC only)
+    COMBO_AC,       // BtnA and BtnC held together (button = BTN_A)
+    HOLD_AC         // ... and still held after the hold time (button = BTN_A)
+  };
+
+  enum Button : uint8_t {
+    BTN_A,
+    BTN_B,
+    BTN_C,
+    BUTTON_COUNT
+  };
+
+  Type type;
+  Button button;
+};
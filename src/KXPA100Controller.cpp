@@ -1,10 +1,53 @@
 #include "KXPA100Controller.h"
+#include "LatencyStats.h"
+#include "FrameLog.h"
 
 //-----------------------------------------------------------------------------
 // Constants
 //-----------------------------------------------------------------------------
-static const uint16_t SERIAL_TIMEOUT_MS = 100;
+static const uint16_t REPLY_TIMEOUT_MS = 150;    // ceiling of the learned timeouts
+static const uint16_t REPLY_MIN_TIMEOUT_MS = 5;  // floor: tick and UART event latency
 static const uint8_t MAX_RETRIES = 3;
+static const uint16_t POLL_TIMEOUT_MS = 250;
+
+// Status queries, indexed by PollParam
+static const char* const POLL_QUERIES[] = {
+  "^I;", "^BN;", "^PF;", "^TM;", "^SW;", "^AN;", "^MD;", "^FL;", "^SV;"
+};
+
+static const KXPA100Controller::PollParam POLL_DEFAULT_ORDER[] = {
+  KXPA100Controller::PARAM_IDENT,
+  KXPA100Controller::PARAM_BAND,
+  KXPA100Controller::PARAM_POWER,
+  KXPA100Controller::PARAM_TEMP,
+  KXPA100Controller::PARAM_SWR,
+  KXPA100Controller::PARAM_ANTENNA,
+  KXPA100Controller::PARAM_MODE,
+  KXPA100Controller::PARAM_FAULTS,
+  KXPA100Controller::PARAM_VOLTAGE
+};
+
+// Estimator names, indexed by Turnaround
+static const char* const TURN_NAMES[] = {
+  "^I", "^BN", "^PF", "^TM", "^SW", "^AN", "^MD", "^FL", "^SV",
+  "set ^BN", "set ^AN", "other"
+};
+
+static_assert(sizeof(TURN_NAMES) / sizeof(TURN_NAMES[0]) == KXPA100Controller::TURN_COUNT,
+              "one name per turnaround estimator");
+
+// Reply bits still outstanding during a poll
+enum : uint16_t {
+  POLL_IDENT   = 1 << KXPA100Controller::PARAM_IDENT,
+  POLL_BAND    = 1 << KXPA100Controller::PARAM_BAND,
+  POLL_POWER   = 1 << KXPA100Controller::PARAM_POWER,
+  POLL_TEMP    = 1 << KXPA100Controller::PARAM_TEMP,
+  POLL_SWR     = 1 << KXPA100Controller::PARAM_SWR,
+  POLL_ANTENNA = 1 << KXPA100Controller::PARAM_ANTENNA,
+  POLL_MODE    = 1 << KXPA100Controller::PARAM_MODE,
+  POLL_FAULTS  = 1 << KXPA100Controller::PARAM_FAULTS,
+  POLL_VOLTAGE = 1 << KXPA100Controller::PARAM_VOLTAGE
+};
 
 //-----------------------------------------------------------------------------
 // Initialize Static Members
@@ -12,30 +55,15 @@ static const uint8_t MAX_RETRIES = 3;
 
 const char* const KXPA100Controller::_modeCmd[] = { "^MDB", "^MDM", "^MDA" };
 const char* const KXPA100Controller::_modeStr[] = { "Bypass", "Manual", "Automatic" };
-
-const KXPA100Controller::BandInfo KXPA100Controller::_bandTable[] = {
-  {1800000L,   2000000L,   "160m", "^BN00;", "^AN1;"},
-  {3500000L,   3800000L,   "80m",  "^BN01;", "^AN1;"},
-  {5351500L,   5366500L,   "60m",  "^BN02;", "^AN1;"},
-  {7000000L,   7200000L,   "40m",  "^BN03;", "^AN1;"},
-  {10100000L,  10150000L,  "30m",  "^BN04;", "^AN1;"},
-  {14000000L,  14350000L,  "20m",  "^BN05;", "^AN1;"},
-  {18068000L,  18168000L,  "17m",  "^BN06;", "^AN1;"},
-  {21000000L,  21450000L,  "15m",  "^BN07;", "^AN1;"},
-  {24890000L,  24990000L,  "12m",  "^BN08;", "^AN1;"},
-  {28000000L,  29700000L,  "10m",  "^BN09;", "^AN1;"},
-  {50000000L,  52000000L,  "6m",   "^BN10;", "^AN2;"}
+const char* const KXPA100Controller::_faultStr[] = {
+  "No Fault", "Hi Current", "Hi Temp", "Hi Voltage", "Lo Voltage", "Hi SWR", "Overdrive", "Fault", "?"
 };
 
-const size_t KXPA100Controller::_bandCount =
-  sizeof(KXPA100Controller::_bandTable) /
-  sizeof(KXPA100Controller::_bandTable[0]);
-
 //-----------------------------------------------------------------------------
 // Constructor
 //-----------------------------------------------------------------------------
 
-KXPA100Controller::KXPA100Controller(HardwareSerial& port,
+KXPA100Controller::KXPA100Controller(SerialPort& port,
                                      int rxPin,
                                      int txPin,
                                      uint32_t baud,
@@ -45,28 +73,59 @@ KXPA100Controller::KXPA100Controller(HardwareSerial& port,
   , _rxPin(rxPin)
   , _txPin(txPin)
   , _baud(baud)
-  , _delayComm(delayComm)
   , _inverted(inverted)
-{ }
+  , _ant2Mask(BANDPLAN_ANT2_MASK)
+  , _rxLen(0)
+  , _rxOverflow(false)
+  , _frameHead(0)
+  , _frameTail(0)
+  , _frameSignal(NULL)
+  , _notifyTask(NULL)
+  , _notifyBits(0)
+  , _log(NULL)
+  , _logStation(0)
+  , _pendingCount(0)
+  , _requestSeq(0)
+  , _lastFrameUs(0)
+  , _chainUs(0)
+{
+  memset(_pending, 0, sizeof(_pending));
+  memset(&_poll, 0, sizeof(_poll));
+  seedTurnaround(delayComm);
+}
 
 //-----------------------------------------------------------------------------
 // Public Methods
 //-----------------------------------------------------------------------------
 
+void KXPA100Controller::setLink(uint32_t baud, uint16_t delayComm) {
+  _baud = baud;
+  seedTurnaround(delayComm);
+}
+
+void KXPA100Controller::setAntennaMask(uint16_t ant2Mask) {
+  _ant2Mask = ant2Mask;
+}
+
 void KXPA100Controller::begin() {
   // Initialize Serial2 with total inverted RX/TX if required
-  _port.begin(_baud, SERIAL_8N1, _rxPin, _txPin, _inverted);
-  _port.setTimeout(SERIAL_TIMEOUT_MS);
+  _port.begin(_baud, _rxPin, _txPin, _inverted);
   
   // Flush any garbage from buffer
   while (_port.available()) {
     _port.read();
   }
+
+  // From here on all RX bytes arrive through the UART event callback
+  if (_frameSignal == NULL) {
+    _frameSignal = xSemaphoreCreateBinary();
+  }
+  _port.onReceive([this]() { onUartReceive(); });
 }
 
 bool KXPA100Controller::checkConnection() {
-  String v = txRx("^I;");
-  bool ok = v == ("^IKXPA100");
+  Reply v;
+  bool ok = txRx("^I;", v) && strcmp(v, "^IKXPA100") == 0;
   
   if (!ok) {
     Serial.println("KXPA100 connection check failed");
@@ -75,112 +134,372 @@ bool KXPA100Controller::checkConnection() {
   return ok;
 }
 
-String KXPA100Controller::getSWR() {
-  String s = txRx("^SW;");
-  if (s.length() == 0) return "0.0";
+int16_t KXPA100Controller::getSWR() {
+  Reply r;
+  return parseSWR(txRx("^SW;", r) ? r : "");
+}
+
+int16_t KXPA100Controller::getPower() {
+  Reply r;
+  return parsePower(txRx("^PF;", r) ? r : "");
+}
+
+int16_t KXPA100Controller::getTemperature() {
+  Reply r;
+  return parseTemperature(txRx("^TM;", r) ? r : "");
+}
+
+int8_t KXPA100Controller::getAntenna() {
+  Reply r;
+  return parseAntenna(txRx("^AN;", r) ? r : "");
+}
+
+KXPA100Controller::Mode KXPA100Controller::getMode() {
+  Reply r;
+  return parseMode(txRx("^MD;", r) ? r : "");
+}
+
+bool KXPA100Controller::setMode(const char* mode) {
+  Reply r;
+  return txRx(mode, r);
+}
+
+bool KXPA100Controller::setMode(Mode mode) {
+  if (mode < MODE_BYPASS || mode > MODE_AUTO) {
+    Serial.print("setMode: Invalid mode ");
+    Serial.println(mode);
+    return false;
+  }
+  
+  char cmd[8];
+  snprintf(cmd, sizeof(cmd), "%s;", _modeCmd[mode]);
+  return setMode(cmd);
+}
+
+bool KXPA100Controller::setAntenna(int8_t antenna) {
+  if (antenna != 1 && antenna != 2) {
+    Serial.print("setAntenna: Invalid antenna ");
+    Serial.println(antenna);
+    return false;
+  }
   
-  s.replace("^SW", "");
-  float swr = s.toFloat() / 10.0f;
+  Reply r;
+  return txRx(antenna == 1 ? "^AN1;" : "^AN2;", r);
+}
+
+int16_t KXPA100Controller::getVoltage() {
+  Reply r;
+  return parseVoltage(txRx("^SV;", r) ? r : "");
+}
+
+bool KXPA100Controller::getFaultCodes(char (&faults)[FAULTS_MAX]) {
+  Reply r;
+  bool ok = txRx("^FL;", r);
+  parseFaultCodes(ok ? r : "", faults);
+  return ok;
+}
+
+int KXPA100Controller::getBand() {
+  Reply r;
+  return parseBand(txRx("^BN;", r) ? r : "");
+}
+
+bool KXPA100Controller::pollStatus(StatusSnapshot& status) {
+  startPoll(status);
+  return finishPoll();
+}
+
+void KXPA100Controller::startPoll(StatusSnapshot& status) {
+  startPoll(status, POLL_DEFAULT_ORDER, PARAM_COUNT);
+}
+
+void KXPA100Controller::startPoll(StatusSnapshot& status, const PollParam* params, uint8_t count) {
+  _poll.self = this;
+  _poll.status = &status;
+  _poll.requested = 0;
+  _poll.pending = 0;
+  _poll.startUs = esp_timer_get_time();
+
+  // Fields that are not queried keep their last value
+  for (uint8_t i = 0; i < count; ++i) {
+    _poll.requested |= (1 << params[i]);
+  }
+  uint16_t mask = _poll.requested;
+
+  if (mask & POLL_IDENT) status.connected = false;
+  if (mask & POLL_BAND) status.band = -1;
+  if (mask & POLL_POWER) status.powerX10 = parsePower("");
+  if (mask & POLL_TEMP) status.tempX10 = parseTemperature("");
+  if (mask & POLL_SWR) status.swrX10 = parseSWR("");
+  if (mask & POLL_ANTENNA) status.antenna = parseAntenna("");
+  if (mask & POLL_MODE) status.mode = parseMode("");
+  if (mask & POLL_FAULTS) parseFaultCodes("", status.faults);
+  if (mask & POLL_VOLTAGE) status.voltageMv = parseVoltage("");
+
+  if (!_port.isOpen()) {
+    Serial.println("Serial port not available");
+    return;
+  }
+
+  // Late replies to an earlier poll must not answer this one
+  service();
+  flushFrames();
+
+  // All queries go out back-to-back in the given order, replies are matched by prefix
+  for (uint8_t i = 0; i < count; ++i) {
+    if (request(POLL_QUERIES[params[i]], onPollReply, &_poll)) {
+      _poll.pending |= (1 << params[i]);
+    }
+  }
+}
+
+bool KXPA100Controller::finishPoll() {
+  if (_poll.status == NULL) return false;
+
+  waitReplies(POLL_TIMEOUT_MS);
+  StatusSnapshot& status = *_poll.status;
+  _poll.status = NULL;
+  LatencyStats::record(LatencyStats::T_KXPA_POLL, (uint32_t)(esp_timer_get_time() - _poll.startUs));
+
+  if (_poll.pending) {
+    Serial.print("Poll incomplete, missing mask 0x");
+    Serial.println(_poll.pending, HEX);
+  }
+
+  // Without an ident query the link counts as alive while anything answers
+  if (!(_poll.requested & POLL_IDENT)) {
+    status.connected = status.connected && (_poll.requested & ~_poll.pending) != 0;
+  }
+
+  if (!status.connected) {
+    Serial.println("KXPA100 connection check failed");
+  }
+
+  return status.connected;
+}
+
+const char* KXPA100Controller::getBandName(int index) const {
+  if (index < 0 || index >= (int)BandPlan::BAND_COUNT) return "Invalid";
+  return BandPlan::BANDS[index].name;
+}
+
+const char* KXPA100Controller::getAntennaCmd(int index) const {
+  if (index < 0 || index >= (int)BandPlan::BAND_COUNT) return "";
+  return ((_ant2Mask >> index) & 1) ? "^AN2;" : "^AN1;";
+}
+
+const char* KXPA100Controller::getModeName(int8_t mode) const {
+  if (mode < MODE_BYPASS || mode > MODE_AUTO) return "Unknown";
+  return _modeStr[mode];
+}
+
+KXPA100Controller::Fault KXPA100Controller::decodeFault(const char* faults, uint8_t* active) {
+  if (active != NULL) *active = 0;
+  if (faults[0] == '\0' || faults[0] == '?') return FAULT_UNKNOWN;
+
+  int32_t code = 0;
+  for (const char* p = faults; *p != '\0'; ++p) {
+    if (*p < '0' || *p > '9') return FAULT_OTHER;
+    code = code * 10 + (*p - '0');
+    if (code > 99) return FAULT_OTHER;
+  }
+
+  uint8_t count = 0;
+  for (int32_t bits = code; bits != 0; bits >>= 1) {
+    count += bits & 1;
+  }
+  if (active != NULL) *active = count;
+
+  // Bits past FAULT_OVERDRIVE have no name, the raw code says more
+  if (code >= (1 << (FAULT_OTHER - 1))) return FAULT_OTHER;
+  for (uint8_t fault = FAULT_HIGH_CURRENT; fault < FAULT_OTHER; ++fault) {
+    if (code & (1 << (fault - 1))) return (Fault)fault;
+  }
+  return FAULT_NONE;
+}
+
+const char* KXPA100Controller::faultName(Fault fault) {
+  static_assert(sizeof(_faultStr) / sizeof(_faultStr[0]) == FAULT_COUNT, "one name per fault");
+  return fault < FAULT_COUNT ? _faultStr[fault] : "?";
+}
+
+int KXPA100Controller::getBandIndexByFrequency(uint32_t freq) const {
+  return BandPlan::bandIndexOf(freq);
+}
+
+bool KXPA100Controller::setBand(int idx) {
+  if (idx < 0 || idx >= (int)BandPlan::BAND_COUNT) {
+    Serial.print("setBand: Invalid index ");
+    Serial.println(idx);
+    return false;
+  }
+  if (!_port.isOpen()) {
+    Serial.println("Serial port not available");
+    return false;
+  }
+  LatencyStats::Scope timing(LatencyStats::T_KXPA_SET_BAND);
+
+  const BandPlan::Band& band = BandPlan::BANDS[idx];
+  const char* antennaCmd = getAntennaCmd(idx);
+  int8_t antenna = antennaCmd[3] - '0';
+  bool bandDone = false;
+  bool antennaDone = false;
+
+  // Retry logic for critical commands, only the part that failed is repeated
+  for (uint8_t attempt = 0; attempt < MAX_RETRIES; attempt++) {
+    Reply bandEcho, antennaEcho, bandNow, antennaNow;
+    bandEcho[0] = antennaEcho[0] = bandNow[0] = antennaNow[0] = '\0';
+
+    service();
+    flushFrames();
+
+    // One burst: the writes, then the read-back. The amp answers in order and
+    // the oldest request with a matching prefix gets each frame, so the set
+    // echoes and the query replies cannot be mixed up
+    if (!bandDone) request(band.bandCmd, storeReply, bandEcho);
+    if (!antennaDone) request(antennaCmd, storeReply, antennaEcho);
+    if (!bandDone) request("^BN;", storeReply, bandNow);
+    if (!antennaDone) request("^AN;", storeReply, antennaNow);
+    waitReplies(REPLY_TIMEOUT_MS);
+
+    if (!bandDone) bandDone = parseBand(bandNow) == idx;
+    if (!antennaDone) antennaDone = parseAntenna(antennaNow) == antenna;
+    if (bandDone && antennaDone) {
+      return true;
+    }
+
+    Serial.print("setBand retry ");
+    Serial.print(attempt + 1);
+    Serial.print("/");
+    Serial.print(MAX_RETRIES);
+    Serial.println(!bandDone && !antennaDone ? " (band+antenna)" : !bandDone ? " (band)" : " (antenna)");
+    LatencyStats::count(LatencyStats::C_KXPA_RETRY);
+  }
   
-  // Sanity check
-  if (swr < 1.0 || swr > 99.9) {
+  Serial.println("setBand: Failed after retries");
+  LatencyStats::count(LatencyStats::C_KXPA_FAIL);
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Private Reply Parsers
+//-----------------------------------------------------------------------------
+
+bool KXPA100Controller::parseValue(const char* frame, int32_t& value) {
+  // Skip the 3-char reply prefix ("^SW", "^PF", ...) and read the digits in place
+  if (strlen(frame) <= 3) return false;
+
+  const char* p = frame + 3;
+  bool negative = false;
+  if (*p == '-') {
+    negative = true;
+    ++p;
+  }
+  if (*p < '0' || *p > '9') return false;
+
+  int32_t v = 0;
+  while (*p >= '0' && *p <= '9') {
+    v = v * 10 + (*p - '0');
+    ++p;
+  }
+
+  value = negative ? -v : v;
+  return true;
+}
+
+int16_t KXPA100Controller::parseSWR(const char* s) {
+  if (s[0] == '\0') return 0;
+  
+  int32_t swr = 0;
+  
+  // Sanity check (1.0 - 99.9)
+  if (!parseValue(s, swr) || swr < 10 || swr > 999) {
     Serial.println("Invalid SWR value received");
-    return "ERR";
+    return INVALID_VALUE;
   }
   
-  return String(swr, 1);
+  return (int16_t)swr;
 }
 
-String KXPA100Controller::getPower() {
-  String p = txRx("^PF;");
-  if (p.length() == 0) return "0";
+int16_t KXPA100Controller::parsePower(const char* p) {
+  if (p[0] == '\0') return 0;
   
-  p.replace("^PF", "");
-  float pp = p.toFloat() / 10.0f;
+  int32_t pp = 0;
   
   // Sanity check (KXPA100 max ~100W)
-  if (pp < 0 || pp > 150) {
+  if (!parseValue(p, pp) || pp < 0 || pp > 1500) {
     Serial.println("Invalid power value received");
-    return "ERR";
+    return INVALID_VALUE;
   }
   
-  return String(pp, 0);
+  return (int16_t)pp;
 }
 
-String KXPA100Controller::getTemperature() {
-  String t = txRx("^TM;");
-  if (t.length() == 0) return "0";
+int16_t KXPA100Controller::parseTemperature(const char* t) {
+  if (t[0] == '\0') return 0;
   
-  t.replace("^TM", "");
-  t.replace(";", "");
-  float tt = t.toFloat() / 10.0f;
+  int32_t tt = 0;
   
   // Sanity check (-40°C to +100°C)
-  if (tt < -40 || tt > 100) {
+  if (!parseValue(t, tt) || tt < -400 || tt > 1000) {
     Serial.println("Invalid temperature value received");
-    return "ERR";
+    return INVALID_VALUE;
   }
   
-  return String(tt, 0);
+  return (int16_t)tt;
 }
 
-String KXPA100Controller::getAntenna() {
-  String a = txRx("^AN;");
-  if (a.length() == 0) return "?";
-  return a;
+int8_t KXPA100Controller::parseAntenna(const char* a) {
+  if (strcmp(a, "^AN1") == 0) return 1;
+  if (strcmp(a, "^AN2") == 0) return 2;
+  return 0;
 }
 
-String KXPA100Controller::getMode() {
-  String m = txRx("^MD;");
-  if (m.length() == 0) return "Unknown";
+KXPA100Controller::Mode KXPA100Controller::parseMode(const char* m) {
+  if (m[0] == '\0') return MODE_UNKNOWN;
   
   for (int i = 0; i < 3; ++i) {
-    if (m == _modeCmd[i]) return _modeStr[i];
+    if (strcmp(m, _modeCmd[i]) == 0) return (Mode)i;
   }
   
   Serial.print("Unknown mode received: ");
   Serial.println(m);
-  return m;
-}
-
-String KXPA100Controller::setMode(const char* mode) {
-  String c = txRx(mode);
-  return c;
+  return MODE_UNKNOWN;
 }
 
-String KXPA100Controller::getVoltage() {
-  String v = txRx("^SV;");
-  if (v.length() == 0) return "0.0";
+int16_t KXPA100Controller::parseVoltage(const char* v) {
+  if (v[0] == '\0') return 0;
   
-  v.replace("^SV","");
-  float vv = v.toFloat() / 1000.0f;
+  int32_t vv = 0;
   
   // Sanity check (typical 12-15V)
-  if (vv < 0 || vv > 20) {
+  if (!parseValue(v, vv) || vv < 0 || vv > 20000) {
     Serial.println("Invalid voltage value received");
-    return "ERR";
+    return INVALID_VALUE;
   }
   
-  return String(vv, 1);
+  return (int16_t)vv;
 }
 
-String KXPA100Controller::getFaultCodes() {
-  String f = txRx("^FL;");
-  if (f.length() == 0) return "?";
+void KXPA100Controller::parseFaultCodes(const char* f, char (&faults)[FAULTS_MAX]) {
+  if (f[0] == '\0') {
+    strcpy(faults, "?");
+    return;
+  }
   
-  f.replace("^FL", "");
-  return f;
+  if (strncmp(f, "^FL", 3) == 0) f += 3;
+  strncpy(faults, f, FAULTS_MAX - 1);
+  faults[FAULTS_MAX - 1] = '\0';
 }
 
-int KXPA100Controller::getBand() {
-  String b = txRx("^BN;");
-  if (b.length() == 0) return -1;
+int KXPA100Controller::parseBand(const char* b) {
+  if (b[0] == '\0') return -1;
   
-  b.replace("^BN", "");
-  int band = b.toInt();
+  int32_t band = -1;
+  parseValue(b, band);
   
   // Validate band index
-  if (band < 0 || band >= (int)_bandCount) {
+  if (band < 0 || band >= (int)BandPlan::BAND_COUNT) {
     Serial.print("Invalid band index received: ");
     Serial.println(band);
     return -1;
@@ -189,89 +508,343 @@ int KXPA100Controller::getBand() {
   return band;
 }
 
-const char* KXPA100Controller::getBandName(int index) const {
-  if (index < 0 || index >= (int)_bandCount) return "Invalid";
-  return _bandTable[index].name;
-}
+//-----------------------------------------------------------------------------
+// Asynchronous Command Path
+//-----------------------------------------------------------------------------
 
-const char* KXPA100Controller::getAntennaCmd(int index) const {
-  if (index < 0 || index >= (int)_bandCount) return "";
-  return _bandTable[index].antennaCmd;
-}
+bool KXPA100Controller::request(const char* cmd, ReplyHandler handler, void* ctx) {
+  PendingReply* slot = NULL;
 
-int KXPA100Controller::getBandIndexByFrequency(uint32_t freq) {
-  for (size_t i = 0; i < _bandCount; ++i) {
-    if (freq >= _bandTable[i].lowerFreq && freq <= _bandTable[i].upperFreq) {
-      return i;
+  if (handler != NULL) {
+    for (uint8_t i = 0; i < PENDING_MAX; ++i) {
+      if (!_pending[i].active) {
+        slot = &_pending[i];
+        break;
+      }
+    }
+    if (slot == NULL) {
+      Serial.println("Reply table full");
+      return false;
     }
   }
-  // Frequency not found
-  return -1;
-}
 
-void KXPA100Controller::setBand(int idx) {
-  if (idx < 0 || idx >= (int)_bandCount) {
-    Serial.print("setBand: Invalid index ");
-    Serial.println(idx);
-    return;
+  size_t len = strlen(cmd);
+  if (_port.write(cmd) != len) {
+    Serial.println("Incomplete command write");
+    LatencyStats::count(LatencyStats::C_KXPA_WRITE_FAIL);
+    return false;
   }
-  
-  // Retry logic for critical commands
-  for (uint8_t attempt = 0; attempt < MAX_RETRIES; attempt++) {
-    _port.write(_bandTable[idx].bandCmd);           
-    delay(_delayComm); 
-    _port.write(_bandTable[idx].antennaCmd);
-    delay(_delayComm);
-    
-    // Verify the band was set (optional but recommended)
-    int actualBand = getBand();
-    if (actualBand == idx) {
-      return; // Success
+  if (_log != NULL) {
+    _log->record(_logStation, FrameLog::KXPA_TX, cmd, len, esp_timer_get_time());
+  }
+
+  if (slot != NULL) {
+    // Reply prefix is the command up to ';', e.g. "^SW" or "^I"
+    size_t n = 0;
+    while (n < sizeof(slot->prefix) - 1 && cmd[n] != ';' && cmd[n] != '\0') {
+      slot->prefix[n] = cmd[n];
+      ++n;
     }
-    
-    Serial.print("setBand retry ");
-    Serial.print(attempt + 1);
-    Serial.print("/");
-    Serial.println(MAX_RETRIES);
-    delay(50); // Small delay before retry
+    slot->prefix[n] = '\0';
+    slot->seq = _requestSeq++;
+    slot->sentAt = millis();
+    slot->sentUs = esp_timer_get_time();
+    slot->turn = turnaroundOf(cmd);
+    slot->timer = slot->turn < PARAM_COUNT ? LatencyStats::T_KXPA_REPLY + slot->turn
+                                           : LatencyStats::T_KXPA_OTHER;
+
+    // The amp answers in order, a reply queued behind others is due later
+    const TurnaroundEstimator& est = _turnaround[slot->turn];
+    int64_t startUs = (_pendingCount > 0 && _chainUs > slot->sentUs) ? _chainUs : slot->sentUs;
+    _chainUs = startUs + est.expectedUs();
+    uint32_t timeoutUs = (uint32_t)(startUs - slot->sentUs) + est.timeoutUs();
+    slot->timeoutMs = (uint16_t)min((timeoutUs + 999) / 1000, (uint32_t)REPLY_TIMEOUT_MS);
+    slot->handler = handler;
+    slot->ctx = ctx;
+    slot->active = true;
+    _pendingCount++;
+  }
+
+  return true;
+}
+
+void KXPA100Controller::service() {
+  Frame frame;
+  while (popFrame(frame)) {
+    dispatchFrame(frame.data, frame.arrivedUs);
+  }
+  expireReplies();
+}
+
+// Task notification bits set when a frame completes while no request waits in
+// waitReplies(), so an idle owner only wakes up for real traffic
+void KXPA100Controller::setFrameNotify(TaskHandle_t task, uint32_t bits) {
+  _notifyBits = bits;
+  _notifyTask = task;
+}
+
+void KXPA100Controller::setFrameLog(FrameLog* log, uint8_t station) {
+  _log = log;
+  _logStation = station;
+}
+
+const TurnaroundEstimator& KXPA100Controller::turnaround(uint8_t kind) const {
+  return _turnaround[kind < TURN_COUNT ? kind : (uint8_t)TURN_OTHER];
+}
+
+void KXPA100Controller::printTurnaround(Print& out) const {
+  char line[80];
+
+  out.println("turnaround       n     mean      dev  timeout  [us]");
+  for (uint8_t i = 0; i < TURN_COUNT; ++i) {
+    const TurnaroundEstimator& est = _turnaround[i];
+    snprintf(line, sizeof(line), "%-8s %8lu %8lu %8lu %8lu",
+             TURN_NAMES[i], (unsigned long)est.samples(),
+             (unsigned long)est.expectedUs(),
+             (unsigned long)est.deviationUs(),
+             (unsigned long)est.timeoutUs());
+    out.println(line);
   }
-  
-  Serial.println("setBand: Failed after retries");
 }
 
 //-----------------------------------------------------------------------------
 // Private TX/RX with Timeout Handling
 //-----------------------------------------------------------------------------
 
-String KXPA100Controller::txRx(const char* cmd) {
+bool KXPA100Controller::txRx(const char* cmd, Reply& reply) {
+  LatencyStats::Scope timing(LatencyStats::T_KXPA_TXRX);
+  reply[0] = '\0';
+
   // Check if port is available
-  if (!_port) {
+  if (!_port.isOpen()) {
     Serial.println("Serial port not available");
-    return "";
+    return false;
   }
   
-  // Clear any stale data in RX buffer
-  while (_port.available()) {
-    _port.read();
-  }
+  // Deliver whatever is still queued, anything unclaimed is stale
+  service();
+  flushFrames();
   
-  // Send command
-  size_t written = _port.write(cmd);
-  if (written != strlen(cmd)) {
-    Serial.println("Incomplete command write");
-    return "";
+  // Send command, the reply lands in the caller's buffer as soon as its ';' arrives
+  if (!request(cmd, storeReply, reply)) {
+    return false;
   }
+  waitReplies(REPLY_TIMEOUT_MS);
   
-  delay(_delayComm);
-  
-  // Read response with timeout (handled by setTimeout)
-  String resp = _port.readStringUntil(';');
-  
-  if (resp.length() == 0) {
+  if (reply[0] == '\0') {
     Serial.print("No response for command: ");
     Serial.println(cmd);
-    return "";
+    return false;
   }
   
-  return resp;
+  return true;
+}
+
+bool KXPA100Controller::waitReplies(uint16_t timeoutMs) {
+  LatencyStats::Scope timing(LatencyStats::T_KXPA_WAIT);
+  unsigned long startTime = millis();
+
+  service();
+  while (_pendingCount > 0) {
+    unsigned long elapsed = millis() - startTime;
+    if (elapsed >= timeoutMs) break;
+
+    // Sleep until the UART callback completes the next frame or a reply expires
+    unsigned long wait = min((unsigned long)(timeoutMs - elapsed), msUntilExpiry());
+    xSemaphoreTake(_frameSignal, pdMS_TO_TICKS(wait));
+    service();
+  }
+
+  return _pendingCount == 0;
+}
+
+unsigned long KXPA100Controller::msUntilExpiry() const {
+  unsigned long now = millis();
+  unsigned long wait = REPLY_TIMEOUT_MS;
+
+  for (uint8_t i = 0; i < PENDING_MAX; ++i) {
+    const PendingReply& p = _pending[i];
+    if (!p.active) continue;
+    unsigned long elapsed = now - p.sentAt;
+    wait = min(wait, elapsed >= p.timeoutMs ? 0UL : p.timeoutMs - elapsed);
+  }
+  return wait;
+}
+
+void KXPA100Controller::seedTurnaround(uint16_t delayComm) {
+  for (uint8_t i = 0; i < TURN_COUNT; ++i) {
+    _turnaround[i].seed((uint32_t)delayComm * 1000,
+                        (uint32_t)REPLY_MIN_TIMEOUT_MS * 1000,
+                        (uint32_t)REPLY_TIMEOUT_MS * 1000);
+  }
+}
+
+uint8_t KXPA100Controller::turnaroundOf(const char* cmd) {
+  for (uint8_t p = 0; p < PARAM_COUNT; ++p) {
+    if (strcmp(cmd, POLL_QUERIES[p]) == 0) return p;
+  }
+  if (strncmp(cmd, "^BN", 3) == 0) return TURN_SET_BAND;
+  if (strncmp(cmd, "^AN", 3) == 0) return TURN_SET_ANTENNA;
+  return TURN_OTHER;
+}
+
+void KXPA100Controller::onUartReceive() {
+  bool completed = false;
+  int64_t nowUs = esp_timer_get_time();
+
+  while (_port.available()) {
+    char c = (char)_port.read();
+
+    if (c == ';') {
+      if (!_rxOverflow && _rxLen > 0) {
+        uint8_t head = _frameHead.load(std::memory_order_relaxed);
+        uint8_t next = (head + 1) % FRAME_QUEUE_LEN;
+        if (next != _frameTail.load(std::memory_order_acquire)) {
+          memcpy(_frames[head].data, _rxFrame, _rxLen);
+          _frames[head].data[_rxLen] = '\0';
+          _frames[head].arrivedUs = nowUs;
+          _frameHead.store(next, std::memory_order_release);
+          completed = true;
+        }
+      }
+      _rxLen = 0;
+      _rxOverflow = false;
+      continue;
+    }
+
+    // Line noise before a frame start is discarded
+    if (_rxLen == 0 && c != '^') continue;
+
+    if (_rxLen < FRAME_MAX - 1) {
+      _rxFrame[_rxLen++] = c;
+    } else {
+      _rxOverflow = true;
+    }
+  }
+
+  if (completed && _frameSignal != NULL) {
+    xSemaphoreGive(_frameSignal);
+  }
+  if (completed && _notifyTask != NULL && _pendingCount == 0) {
+    xTaskNotify(_notifyTask, _notifyBits, eSetBits);
+  }
+}
+
+bool KXPA100Controller::popFrame(Frame& frame) {
+  uint8_t tail = _frameTail.load(std::memory_order_relaxed);
+  if (tail == _frameHead.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  frame = _frames[tail];
+  _frameTail.store((tail + 1) % FRAME_QUEUE_LEN, std::memory_order_release);
+
+  // Logged as it was on the wire, stale frames that get flushed included
+  if (_log != NULL) {
+    char raw[FRAME_MAX + 1];
+    size_t len = strlen(frame.data);
+    memcpy(raw, frame.data, len);
+    raw[len] = ';';
+    _log->record(_logStation, FrameLog::KXPA_RX, raw, len + 1, frame.arrivedUs);
+  }
+  return true;
+}
+
+void KXPA100Controller::flushFrames() {
+  Frame frame;
+  while (popFrame(frame)) { }
+}
+
+void KXPA100Controller::dispatchFrame(const char* frame, int64_t arrivedUs) {
+  // Turnaround counts from the send, or from the previous frame if the amp
+  // was still busy answering that one
+  int64_t previousUs = _lastFrameUs;
+  _lastFrameUs = arrivedUs;
+
+  // Oldest outstanding request with a matching prefix gets the frame
+  PendingReply* match = NULL;
+  for (uint8_t i = 0; i < PENDING_MAX; ++i) {
+    PendingReply& p = _pending[i];
+    if (!p.active) continue;
+    if (strncmp(frame, p.prefix, strlen(p.prefix)) != 0) continue;
+    if (match == NULL || (int32_t)(p.seq - match->seq) < 0) {
+      match = &p;
+    }
+  }
+
+  if (match == NULL) {
+    Serial.print("Unexpected reply: ");
+    Serial.println(frame);
+    LatencyStats::count(LatencyStats::C_KXPA_UNEXPECTED);
+    return;
+  }
+
+  LatencyStats::record((LatencyStats::Timer)match->timer,
+                       (uint32_t)(esp_timer_get_time() - match->sentUs));
+  int64_t fromUs = match->sentUs > previousUs ? match->sentUs : previousUs;
+  if (arrivedUs > fromUs) {
+    _turnaround[match->turn].sample((uint32_t)(arrivedUs - fromUs));
+  }
+  match->active = false;
+  _pendingCount--;
+  match->handler(frame, match->ctx);
+}
+
+void KXPA100Controller::expireReplies() {
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < PENDING_MAX; ++i) {
+    PendingReply& p = _pending[i];
+    if (!p.active || now - p.sentAt < p.timeoutMs) continue;
+
+    p.active = false;
+    _pendingCount--;
+    _turnaround[p.turn].timedOut();
+    LatencyStats::count(LatencyStats::C_KXPA_TIMEOUT);
+    p.handler(NULL, p.ctx);
+  }
+}
+
+void KXPA100Controller::storeReply(const char* frame, void* ctx) {
+  if (frame == NULL) return;
+  char* reply = static_cast<char*>(ctx);
+  strncpy(reply, frame, FRAME_MAX - 1);
+  reply[FRAME_MAX - 1] = '\0';
+}
+
+void KXPA100Controller::onPollReply(const char* frame, void* ctx) {
+  PollContext* poll = static_cast<PollContext*>(ctx);
+  if (frame == NULL || poll->status == NULL) return;
+
+  KXPA100Controller* self = poll->self;
+  StatusSnapshot& status = *poll->status;
+
+  // Demultiplex by reply prefix
+  if (strncmp(frame, "^BN", 3) == 0) {
+    status.band = self->parseBand(frame);
+    poll->pending &= ~POLL_BAND;
+  } else if (strncmp(frame, "^PF", 3) == 0) {
+    status.powerX10 = self->parsePower(frame);
+    poll->pending &= ~POLL_POWER;
+  } else if (strncmp(frame, "^TM", 3) == 0) {
+    status.tempX10 = self->parseTemperature(frame);
+    poll->pending &= ~POLL_TEMP;
+  } else if (strncmp(frame, "^SW", 3) == 0) {
+    status.swrX10 = self->parseSWR(frame);
+    poll->pending &= ~POLL_SWR;
+  } else if (strncmp(frame, "^AN", 3) == 0) {
+    status.antenna = self->parseAntenna(frame);
+    poll->pending &= ~POLL_ANTENNA;
+  } else if (strncmp(frame, "^MD", 3) == 0) {
+    status.mode = self->parseMode(frame);
+    poll->pending &= ~POLL_MODE;
+  } else if (strncmp(frame, "^FL", 3) == 0) {
+    self->parseFaultCodes(frame, status.faults);
+    poll->pending &= ~POLL_FAULTS;
+  } else if (strncmp(frame, "^SV", 3) == 0) {
+    status.voltageMv = self->parseVoltage(frame);
+    poll->pending &= ~POLL_VOLTAGE;
+  } else if (strncmp(frame, "^I", 2) == 0) {
+    status.connected = strcmp(frame, "^IKXPA100") == 0;
+    poll->pending &= ~POLL_IDENT;
+  }
 }
@@ -2,18 +2,90 @@
 #define KXPA100CONTROLLER_H
 
 #include <Arduino.h>
+#include <atomic>
+#include "BandPlan.h"
+#include "SerialPort.h"
+#include "TurnaroundEstimator.h"
+
+class FrameLog;
 
 class KXPA100Controller {
 public:
-  struct BandInfo {
-    uint32_t lowerFreq;
-    uint32_t upperFreq;
-    const char* name;
-    const char* bandCmd;
-    const char* antennaCmd;
+  static const size_t FRAME_MAX = 16;
+  static const size_t FAULTS_MAX = 8;
+
+  // Reply buffer supplied by the caller of txRx
+  typedef char Reply[FRAME_MAX];
+
+  // Value for a reply that failed its sanity check
+  static const int16_t INVALID_VALUE = INT16_MIN;
+
+  enum Mode : int8_t {
+    MODE_UNKNOWN = -1,
+    MODE_BYPASS = 0,
+    MODE_MANUAL,
+    MODE_AUTO
+  };
+
+  // Decoded ^FL reply. The code is a bitmap: bit 0 = FAULT_HIGH_CURRENT up to
+  // bit 5 = FAULT_OVERDRIVE, in the order below; a higher bit or a reply that
+  // is not a number 0-99 is FAULT_OTHER
+  enum Fault : uint8_t {
+    FAULT_NONE = 0,
+    FAULT_HIGH_CURRENT,
+    FAULT_HIGH_TEMP,
+    FAULT_HIGH_VOLTAGE,
+    FAULT_LOW_VOLTAGE,
+    FAULT_HIGH_SWR,
+    FAULT_OVERDRIVE,
+    FAULT_OTHER,
+    FAULT_UNKNOWN,              // no valid reply yet ("?")
+    FAULT_COUNT
+  };
+
+  // Status parameters, one query each; bit (1 << param) in poll masks
+  enum PollParam : uint8_t {
+    PARAM_IDENT = 0,
+    PARAM_BAND,
+    PARAM_POWER,
+    PARAM_TEMP,
+    PARAM_SWR,
+    PARAM_ANTENNA,
+    PARAM_MODE,
+    PARAM_FAULTS,
+    PARAM_VOLTAGE,
+    PARAM_COUNT
+  };
+
+  static const uint16_t POLL_ALL = (1 << PARAM_COUNT) - 1;
+
+  // Turnaround estimators: one per status query (PollParam), then the echoed
+  // set commands and everything else
+  enum Turnaround : uint8_t {
+    TURN_SET_BAND = PARAM_COUNT,
+    TURN_SET_ANTENNA,
+    TURN_OTHER,
+    TURN_COUNT
   };
 
-  KXPA100Controller(HardwareSerial& port,
+  // Result of one pipelined status poll (see pollStatus), fixed-point values
+  struct StatusSnapshot {
+    bool connected;
+    int8_t band;                // -1 = unknown
+    int16_t powerX10;           // W × 10
+    int16_t tempX10;            // °C × 10
+    int16_t swrX10;             // SWR × 10
+    int16_t voltageMv;          // mV
+    int8_t antenna;             // 1/2, 0 = unknown
+    int8_t mode;                // Mode
+    char faults[FAULTS_MAX];    // raw fault code, "?" = unknown
+  };
+
+  // Called with the complete reply frame (without ';'), or nullptr on timeout
+  typedef void (*ReplyHandler)(const char* frame, void* ctx);
+
+  // delayComm is the turnaround assumed until the first replies are measured
+  KXPA100Controller(SerialPort& port,
                     int rxPin,
                     int txPin,
                     uint32_t baud,
@@ -21,34 +93,134 @@ public:
                     bool inverted);
 
   void begin();
+  // Runtime overrides of the constructor settings, call before begin()
+  void setLink(uint32_t baud, uint16_t delayComm);
+  void setAntennaMask(uint16_t ant2Mask);
   bool checkConnection();
-  String getSWR();
-  String getPower();
-  String getTemperature();
-  String getAntenna();
-  String getMode();
-  String setMode(const char* mode);
-  String getVoltage();
-  String getFaultCodes();
+  int16_t getSWR();
+  int16_t getPower();
+  int16_t getTemperature();
+  int8_t getAntenna();
+  Mode getMode();
+  bool setMode(const char* mode);
+  bool setMode(Mode mode);
+  bool setAntenna(int8_t antenna);
+  int16_t getVoltage();
+  bool getFaultCodes(char (&faults)[FAULTS_MAX]);
   int getBand();
   const char* getBandName(int index) const;
   const char* getAntennaCmd(int index) const;
-  int getBandIndexByFrequency(uint32_t freq);
-  void setBand(int idx);
+  const char* getModeName(int8_t mode) const;
+  // First active fault in enum order, active = how many bits are set
+  static Fault decodeFault(const char* faults, uint8_t* active = NULL);
+  static const char* faultName(Fault fault);
+  int getBandIndexByFrequency(uint32_t freq) const;
+  bool setBand(int idx);
+  bool pollStatus(StatusSnapshot& status);
+  void startPoll(StatusSnapshot& status);
+  void startPoll(StatusSnapshot& status, const PollParam* params, uint8_t count);
+  bool finishPoll();
+  uint16_t lastPollMask() const { return _poll.requested; }
+  uint16_t lastPollMissing() const { return _poll.pending; }
+
+  // Asynchronous command path
+  bool request(const char* cmd, ReplyHandler handler, void* ctx);
+  void service();
+  void setFrameNotify(TaskHandle_t task, uint32_t bits);
+
+  // Every command written and every frame received, as this station (see FrameLog)
+  void setFrameLog(FrameLog* log, uint8_t station);
+  bool idle() const { return _pendingCount == 0; }
+
+  // Learned reply timing, see TurnaroundEstimator
+  const TurnaroundEstimator& turnaround(uint8_t kind) const;
+  void printTurnaround(Print& out) const;
  
 private:
-  String txRx(const char* cmd);
-  HardwareSerial& _port;
+  struct Frame {
+    char data[FRAME_MAX];
+    int64_t arrivedUs;          // esp_timer, when the ';' came in
+  };
+
+  struct PendingReply {
+    bool active;
+    char prefix[4];
+    uint32_t seq;
+    unsigned long sentAt;
+    int64_t sentUs;             // esp_timer, for the latency stats
+    uint8_t timer;              // LatencyStats::Timer
+    uint8_t turn;               // Turnaround
+    uint16_t timeoutMs;         // from the estimator at send time
+    ReplyHandler handler;
+    void* ctx;
+  };
+
+  struct PollContext {
+    KXPA100Controller* self;
+    StatusSnapshot* status;
+    uint16_t requested;
+    uint16_t pending;
+    int64_t startUs;
+  };
+
+  static const uint8_t FRAME_QUEUE_LEN = 16;
+  static const uint8_t PENDING_MAX = 16;
+
+  bool txRx(const char* cmd, Reply& reply);
+  static bool parseValue(const char* frame, int32_t& value);
+  int16_t parseSWR(const char* s);
+  int16_t parsePower(const char* p);
+  int16_t parseTemperature(const char* t);
+  int8_t parseAntenna(const char* a);
+  Mode parseMode(const char* m);
+  int16_t parseVoltage(const char* v);
+  void parseFaultCodes(const char* f, char (&faults)[FAULTS_MAX]);
+  int parseBand(const char* b);
+  bool waitReplies(uint16_t timeoutMs);
+  void seedTurnaround(uint16_t delayComm);
+  unsigned long msUntilExpiry() const;
+  static uint8_t turnaroundOf(const char* cmd);
+  void onUartReceive();
+  bool popFrame(Frame& frame);
+  void flushFrames();
+  void dispatchFrame(const char* frame, int64_t arrivedUs);
+  void expireReplies();
+  static void storeReply(const char* frame, void* ctx);
+  static void onPollReply(const char* frame, void* ctx);
+  SerialPort& _port;
   int _rxPin;
   int _txPin;
   uint32_t _baud;
-  uint16_t _delayComm;
   bool _inverted;
+  uint16_t _ant2Mask;             // bit (1 << band) = ANT2, see BANDPLAN_ANT2_MASK
+
+  // Incremental ';'-terminated parser, fed from the UART event task
+  char _rxFrame[FRAME_MAX];
+  size_t _rxLen;
+  bool _rxOverflow;
+
+  // Completed frames (SPSC: UART event task -> caller of service())
+  Frame _frames[FRAME_QUEUE_LEN];
+  std::atomic<uint8_t> _frameHead;
+  std::atomic<uint8_t> _frameTail;
+  SemaphoreHandle_t _frameSignal;
+  TaskHandle_t _notifyTask;       // woken for frames nobody is waiting for
+  uint32_t _notifyBits;
+  FrameLog* _log;
+  uint8_t _logStation;
+
+  PendingReply _pending[PENDING_MAX];
+  uint8_t _pendingCount;
+  uint32_t _requestSeq;
+  PollContext _poll;
+
+  TurnaroundEstimator _turnaround[TURN_COUNT];
+  int64_t _lastFrameUs;           // arrival of the previous frame
+  int64_t _chainUs;               // expected end of the replies still outstanding
 
   static const char* const _modeCmd[];
   static const char* const _modeStr[];
-  static const BandInfo _bandTable[];
-  static const size_t _bandCount;
+  static const char* const _faultStr[];
 };
 
 #endif // KXPA100CONTROLLER_H
\ No newline at end of file
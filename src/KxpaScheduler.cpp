@@ -0,0 +1,136 @@
+#include "KxpaScheduler.h"
+
+//-----------------------------------------------------------------------------
+// Default Poll Table
+//-----------------------------------------------------------------------------
+
+// Fallback period for the "on change" parameters, catches front panel changes
+static const uint16_t ON_CHANGE_FALLBACK_MS = 5000;
+
+const KxpaScheduler::ParamConfig KxpaScheduler::_defaults[] = {
+  // param                           prio  idle   tx
+  {KXPA100Controller::PARAM_SWR,     0,    200,   50},
+  {KXPA100Controller::PARAM_POWER,   0,    200,   50},
+  {KXPA100Controller::PARAM_FAULTS,  1,    500,   200},
+  {KXPA100Controller::PARAM_IDENT,   2,    1000,  1000},
+  {KXPA100Controller::PARAM_BAND,    2,    1000,  1000},
+  {KXPA100Controller::PARAM_ANTENNA, 3,    NEVER, NEVER},
+  {KXPA100Controller::PARAM_MODE,    3,    NEVER, NEVER},
+  {KXPA100Controller::PARAM_TEMP,    4,    2000,  2000},
+  {KXPA100Controller::PARAM_VOLTAGE, 4,    2000,  2000}
+};
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+KxpaScheduler::KxpaScheduler(uint8_t budget)
+  : _budget(budget)
+  , _transmitting(false)
+  , _backoff(1)
+{
+  for (uint8_t i = 0; i < KXPA100Controller::PARAM_COUNT; ++i) {
+    _entries[i].cfg = _defaults[i];
+    _entries[i].lastPoll = 0;
+    _entries[i].stale = true;    // everything is due on the first cycle
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void KxpaScheduler::configure(PollParam param, uint8_t priority, uint16_t periodMs, uint16_t txPeriodMs) {
+  for (uint8_t i = 0; i < KXPA100Controller::PARAM_COUNT; ++i) {
+    if (_entries[i].cfg.param != param) continue;
+    _entries[i].cfg.priority = priority;
+    _entries[i].cfg.periodMs = periodMs;
+    _entries[i].cfg.txPeriodMs = txPeriodMs;
+    return;
+  }
+}
+
+bool KxpaScheduler::plan(unsigned long now, PollPlan& plan) {
+  plan.count = 0;
+
+  // Collect due entries, insertion-sorted by priority (stable for equal prio)
+  for (uint8_t i = 0; i < KXPA100Controller::PARAM_COUNT; ++i) {
+    const Entry& e = _entries[i];
+    if (!isDue(e, now)) continue;
+
+    uint8_t pos = plan.count;
+    while (pos > 0 && priorityOf(plan.params[pos - 1]) > e.cfg.priority) {
+      plan.params[pos] = plan.params[pos - 1];
+      --pos;
+    }
+    plan.params[pos] = e.cfg.param;
+    plan.count++;
+  }
+
+  // Lower priorities beyond the budget wait for the next cycle
+  if (plan.count > _budget) {
+    plan.count = _budget;
+  }
+
+  return plan.count > 0;
+}
+
+void KxpaScheduler::complete(const PollPlan& plan, uint16_t missingMask, unsigned long now) {
+  for (uint8_t i = 0; i < plan.count; ++i) {
+    for (uint8_t j = 0; j < KXPA100Controller::PARAM_COUNT; ++j) {
+      Entry& e = _entries[j];
+      if (e.cfg.param != plan.params[i]) continue;
+
+      e.lastPoll = now;
+      // Unanswered queries are retried on the next cycle
+      e.stale = (missingMask & (1 << e.cfg.param)) != 0;
+    }
+  }
+}
+
+void KxpaScheduler::invalidate(uint16_t mask) {
+  for (uint8_t i = 0; i < KXPA100Controller::PARAM_COUNT; ++i) {
+    if (mask & (1 << _entries[i].cfg.param)) {
+      _entries[i].stale = true;
+    }
+  }
+}
+
+unsigned long KxpaScheduler::msUntilDue(unsigned long now) const {
+  unsigned long next = (unsigned long)ON_CHANGE_FALLBACK_MS * _backoff;
+
+  for (uint8_t i = 0; i < KXPA100Controller::PARAM_COUNT; ++i) {
+    const Entry& e = _entries[i];
+    if (e.stale) return 0;
+
+    unsigned long elapsed = now - e.lastPoll;
+    unsigned long period = periodOf(e);
+    if (elapsed >= period) return 0;
+    if (period - elapsed < next) next = period - elapsed;
+  }
+
+  return next;
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+unsigned long KxpaScheduler::periodOf(const Entry& e) const {
+  if (_transmitting) {
+    return e.cfg.txPeriodMs == NEVER ? ON_CHANGE_FALLBACK_MS : e.cfg.txPeriodMs;
+  }
+  unsigned long period = e.cfg.periodMs == NEVER ? ON_CHANGE_FALLBACK_MS : e.cfg.periodMs;
+  return period * _backoff;
+}
+
+uint8_t KxpaScheduler::priorityOf(PollParam param) const {
+  for (uint8_t i = 0; i < KXPA100Controller::PARAM_COUNT; ++i) {
+    if (_entries[i].cfg.param == param) return _entries[i].cfg.priority;
+  }
+  return 0xFF;
+}
+
+bool KxpaScheduler::isDue(const Entry& e, unsigned long now) const {
+  return e.stale || now - e.lastPoll >= periodOf(e);
+}
@@ -0,0 +1,63 @@
+#ifndef KXPASCHEDULER_H
+#define KXPASCHEDULER_H
+
+#include <Arduino.h>
+#include "KXPA100Controller.h"
+
+// Decides which KXPA status parameters go on the wire in the next poll.
+//
+// Every parameter has its own period (a faster one while transmitting) and a
+// priority. Each cycle the due parameters are sorted by priority and cut off
+// at a per-cycle budget, so the safety-critical reads always make it out
+// first and the slow ones fill in when the link is quiet.
+class KxpaScheduler {
+public:
+  typedef KXPA100Controller::PollParam PollParam;
+
+  static const uint16_t NEVER = 0;   // period: only polled after invalidate()
+
+  struct ParamConfig {
+    PollParam param;
+    uint8_t priority;        // lower value goes out first
+    uint16_t periodMs;       // while idle, NEVER = on change only
+    uint16_t txPeriodMs;     // while transmitting
+  };
+
+  struct PollPlan {
+    PollParam params[KXPA100Controller::PARAM_COUNT];
+    uint8_t count;
+  };
+
+  explicit KxpaScheduler(uint8_t budget = KXPA100Controller::PARAM_COUNT);
+
+  void configure(PollParam param, uint8_t priority, uint16_t periodMs, uint16_t txPeriodMs);
+  bool plan(unsigned long now, PollPlan& plan);
+  void complete(const PollPlan& plan, uint16_t missingMask, unsigned long now);
+  void invalidate(uint16_t mask);
+  void setTransmitting(bool transmitting) { _transmitting = transmitting; }
+  bool transmitting() const { return _transmitting; }
+  // Stretch the idle periods by this factor (1 = normal), TX periods are kept
+  void setBackoff(uint8_t factor) { _backoff = factor > 0 ? factor : 1; }
+  uint8_t backoff() const { return _backoff; }
+  unsigned long msUntilDue(unsigned long now) const;
+
+private:
+  struct Entry {
+    ParamConfig cfg;
+    unsigned long lastPoll;
+    bool stale;
+  };
+
+  unsigned long periodOf(const Entry& e) const;
+  uint8_t priorityOf(PollParam param) const;
+  bool isDue(const Entry& e, unsigned long now) const;
+
+  Entry _entries[KXPA100Controller::PARAM_COUNT];
+  uint8_t _budget;
+  bool _transmitting;
+  uint8_t _backoff;
+
+  static const ParamConfig _defaults[];   // one row per PollParam
+};
+
+#endif // KXPASCHEDULER_H
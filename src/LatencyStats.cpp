@@ -0,0 +1,101 @@
+#include "LatencyStats.h"
+
+//-----------------------------------------------------------------------------
+// Storage
+//-----------------------------------------------------------------------------
+
+LatencyStats::Histogram LatencyStats::_hist[TIMER_COUNT];
+uint32_t LatencyStats::_counters[COUNTER_COUNT];
+
+static const char* const TIMER_NAMES[] = {
+  "kxpa ^I", "kxpa ^BN", "kxpa ^PF", "kxpa ^TM", "kxpa ^SW",
+  "kxpa ^AN", "kxpa ^MD", "kxpa ^FL", "kxpa ^SV", "kxpa set",
+  "txRx", "poll", "poll wait", "setBand", "cat reply",
+  "cat->band", "field", "meter", "frame", "dma wait"
+};
+
+static const char* const COUNTER_NAMES[] = {
+  "kxpa timeout", "kxpa unexpected", "kxpa write fail", "kxpa retry",
+  "kxpa fail", "cat timeout", "cat error", "cat reconnect",
+  "protect trip"
+};
+
+static_assert(sizeof(TIMER_NAMES) / sizeof(TIMER_NAMES[0]) == LatencyStats::TIMER_COUNT,
+              "one name per timer");
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == LatencyStats::COUNTER_COUNT,
+              "one name per counter");
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void LatencyStats::record(Timer timer, uint32_t us) {
+  Histogram& h = _hist[timer];
+
+  uint8_t bucket = 0;
+  while (bucket < BUCKETS - 1 && (us >> (bucket + 1)) != 0) {
+    ++bucket;
+  }
+
+  if (h.count == 0 || us < h.minUs) h.minUs = us;
+  if (us > h.maxUs) h.maxUs = us;
+  h.sumUs += us;
+  h.buckets[bucket]++;
+  h.count++;
+}
+
+void LatencyStats::reset() {
+  memset(_hist, 0, sizeof(_hist));
+  memset(_counters, 0, sizeof(_counters));
+}
+
+uint32_t LatencyStats::percentile(Timer timer, uint8_t pct) {
+  const Histogram& h = _hist[timer];
+  if (h.count == 0) return 0;
+
+  // Rank of the sample, rounded up so p100 is the last one
+  uint32_t rank = ((uint64_t)h.count * pct + 99) / 100;
+  if (rank == 0) rank = 1;
+
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BUCKETS; ++i) {
+    seen += h.buckets[i];
+    if (seen >= rank) {
+      uint32_t upper = (i == BUCKETS - 1) ? h.maxUs : (2UL << i) - 1;
+      return min(upper, h.maxUs);
+    }
+  }
+  return h.maxUs;
+}
+
+const char* LatencyStats::name(Timer timer) {
+  return timer < TIMER_COUNT ? TIMER_NAMES[timer] : "?";
+}
+
+const char* LatencyStats::name(Counter counter) {
+  return counter < COUNTER_COUNT ? COUNTER_NAMES[counter] : "?";
+}
+
+void LatencyStats::print(Print& out) {
+  char line[80];
+
+  out.println("timer              n      avg      p50      p99      max  [us]");
+  for (uint8_t i = 0; i < TIMER_COUNT; ++i) {
+    Timer t = (Timer)i;
+    const Histogram& h = _hist[t];
+    if (h.count == 0) continue;
+
+    snprintf(line, sizeof(line), "%-12s %7lu %8lu %8lu %8lu %8lu",
+             name(t), (unsigned long)h.count,
+             (unsigned long)(h.sumUs / h.count),
+             (unsigned long)percentile(t, 50),
+             (unsigned long)percentile(t, 99),
+             (unsigned long)h.maxUs);
+    out.println(line);
+  }
+
+  for (uint8_t i = 0; i < COUNTER_COUNT; ++i) {
+    snprintf(line, sizeof(line), "%-16s %lu", name((Counter)i), (unsigned long)_counters[i]);
+    out.println(line);
+  }
+}
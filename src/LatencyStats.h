@@ -0,0 +1,91 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "KXPA100Controller.h"
+
+// Field latency numbers for every KXPA and CAT transaction and the render path.
+//
+// Durations are measured with esp_timer_get_time() and kept in log2
+// histograms (bucket i holds [2^i, 2^(i+1)) us), plus a set of event
+// counters. Each timer has a single writer task; readers (serial "stats",
+// diagnostics page) may see a sample half-applied, which is fine for numbers
+// that are only ever looked at.
+class LatencyStats {
+public:
+  enum Timer : uint8_t {
+    T_KXPA_REPLY = 0,                         // request -> reply, + PollParam
+    T_KXPA_OTHER = KXPA100Controller::PARAM_COUNT,  // replies to any other command
+    T_KXPA_TXRX,                              // blocking txRx()
+    T_KXPA_POLL,                              // pipelined status poll
+    T_KXPA_WAIT,                              // blocked in waitReplies()
+    T_KXPA_SET_BAND,                          // setBand() incl. verify/retries
+    T_CAT_REPLY,                              // CAT query -> reply
+    T_CAT_BAND,                               // first CAT freq of a new band -> setBand() done
+    T_RENDER_FIELD,                           // one UiField redraw
+    T_RENDER_METER,                           // one meter frame
+    T_RENDER_FRAME,                           // UI pass that drew anything
+    T_DMA_WAIT,                               // reclaim() waiting for the DMA
+    TIMER_COUNT
+  };
+
+  enum Counter : uint8_t {
+    C_KXPA_TIMEOUT,
+    C_KXPA_UNEXPECTED,
+    C_KXPA_WRITE_FAIL,
+    C_KXPA_RETRY,
+    C_KXPA_FAIL,
+    C_CAT_TIMEOUT,
+    C_CAT_ERROR,
+    C_CAT_RECONNECT,
+    C_PROTECT_TRIP,
+    COUNTER_COUNT
+  };
+
+  static const uint8_t BUCKETS = 24;         // up to ~16 s
+
+  struct Histogram {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint32_t buckets[BUCKETS];
+  };
+
+  // Measures the enclosing block
+  class Scope {
+  public:
+    explicit Scope(Timer timer) : _timer(timer), _start(esp_timer_get_time()) {}
+    ~Scope() {
+      if (_timer != TIMER_COUNT) LatencyStats::record(_timer, (uint32_t)(esp_timer_get_time() - _start));
+    }
+    // Nothing worth timing happened after all
+    void cancel() { _timer = TIMER_COUNT; }
+  private:
+    Timer _timer;
+    int64_t _start;
+  };
+
+  static void record(Timer timer, uint32_t us);
+  static void count(Counter counter) { _counters[counter]++; }
+  static void reset();
+
+  static const Histogram& histogram(Timer timer) { return _hist[timer]; }
+  static uint32_t counter(Counter counter) { return _counters[counter]; }
+
+  // Upper edge of the bucket holding the given percentile, capped at the maximum
+  static uint32_t percentile(Timer timer, uint8_t pct);
+
+  static const char* name(Timer timer);
+  static const char* name(Counter counter);
+
+  // Table of all timers with samples, then the counters
+  static void print(Print& out);
+
+private:
+  static Histogram _hist[TIMER_COUNT];
+  static uint32_t _counters[COUNTER_COUNT];
+};
+
+#endif // LATENCYSTATS_H
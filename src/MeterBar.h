@@ -0,0 +1,102 @@
+#pragma once
+#include <M5Unified.h>
+#include "KXPA100Controller.h"
+
+// Horizontal bar graph with peak hold, drawn incrementally.
+//
+// Only the columns between the previously shown and the new length are
+// painted, plus the peak marker when it moves, so a frame at a steady
+// reading costs nothing and a typical change a few hundred pixels.
+class MeterBar {
+public:
+  MeterBar(LovyanGFX* lcd, int16_t x, int16_t y, int16_t w, int16_t h,
+           int16_t minValue, int16_t maxValue, int16_t warnValue,
+           uint16_t color, uint16_t warnColor, uint16_t background)
+      : _lcd(lcd), _x(x), _y(y), _w(w), _h(h),
+        _minValue(minValue), _maxValue(maxValue),
+        _color(color), _warnColor(warnColor), _background(background),
+        _shownCols(0), _peakCol(0), _shownPeakCol(-1), _peakAt(0), _valid(false) {
+    _warnCol = columnOf(warnValue);
+  }
+
+  // Forget what is on screen, the next draw() repaints the whole bar
+  void invalidate() { _valid = false; }
+
+  void draw(int16_t value, unsigned long now) {
+    int16_t cols = columnOf(value);
+
+    if (!_valid) {
+      _lcd->fillRect(_x, _y, _w, _h, _background);
+      _shownCols = 0;
+      _shownPeakCol = -1;
+      _peakCol = 0;
+      _valid = true;
+    }
+
+    // Bar: paint only the delta
+    int16_t from = min(cols, _shownCols);
+    int16_t to = max(cols, _shownCols);
+    if (cols > _shownCols) {
+      fillColumns(from, to);
+    } else if (cols < _shownCols) {
+      _lcd->fillRect(_x + from, _y, to - from, _h, _background);
+    }
+    _shownCols = cols;
+    bool markerHit = _shownPeakCol >= 0 && from < _shownPeakCol + PEAK_WIDTH && to > _shownPeakCol;
+
+    // Peak: follows rises at once, decays after the hold time
+    if (cols >= _peakCol) {
+      _peakCol = cols;
+      _peakAt = now;
+    } else if (now - _peakAt >= PEAK_HOLD_MS) {
+      _peakCol = max((int16_t)(_peakCol - PEAK_DECAY_COLS), cols);
+    }
+
+    int16_t marker = _peakCol > cols ? _peakCol - PEAK_WIDTH : -1;
+    if (marker != _shownPeakCol || markerHit) {
+      if (_shownPeakCol >= 0) {
+        restoreColumns(_shownPeakCol, _shownPeakCol + PEAK_WIDTH);
+      }
+      if (marker >= 0) {
+        _lcd->fillRect(_x + marker, _y, PEAK_WIDTH, _h, DARKGREY);
+      }
+      _shownPeakCol = marker;
+    }
+  }
+
+private:
+  static const uint16_t PEAK_HOLD_MS = 1500;
+  static const int16_t PEAK_DECAY_COLS = 4;    // per frame once the hold expired
+  static const int16_t PEAK_WIDTH = 2;
+
+  int16_t columnOf(int16_t value) const {
+    if (value == KXPA100Controller::INVALID_VALUE || value <= _minValue) return 0;
+    if (value >= _maxValue) return _w;
+    return (int32_t)(value - _minValue) * _w / (_maxValue - _minValue);
+  }
+
+  // Bar colour for [from, to), switching to the warning colour past _warnCol
+  void fillColumns(int16_t from, int16_t to) {
+    int16_t split = constrain(_warnCol, from, to);
+    if (split > from) _lcd->fillRect(_x + from, _y, split - from, _h, _color);
+    if (to > split) _lcd->fillRect(_x + split, _y, to - split, _h, _warnColor);
+  }
+
+  // Whatever belongs under [from, to) without a marker: bar or background
+  void restoreColumns(int16_t from, int16_t to) {
+    int16_t split = constrain(_shownCols, from, to);
+    if (split > from) fillColumns(from, split);
+    if (to > split) _lcd->fillRect(_x + split, _y, to - split, _h, _background);
+  }
+
+  LovyanGFX* _lcd;
+  int16_t _x, _y, _w, _h;
+  int16_t _minValue, _maxValue;
+  int16_t _warnCol;
+  uint16_t _color, _warnColor, _background;
+  int16_t _shownCols;
+  int16_t _peakCol;
+  int16_t _shownPeakCol;
+  unsigned long _peakAt;
+  bool _valid;
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// TCP connection to the CAT server.
+//
+// The firmware uses WiFiNetClient (see WiFiNetClient.h), the native test
+// environment a fake rigctld.
+class NetClient {
+public:
+  virtual ~NetClient() {}
+
+  // Blocks until connected or timeoutMs, 1 = connected
+  virtual int connect(const char* host, uint16_t port, uint16_t timeoutMs) = 0;
+  virtual bool connected() = 0;
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual size_t print(const char* data) = 0;
+  virtual void stop() = 0;
+};
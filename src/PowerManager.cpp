@@ -0,0 +1,71 @@
+#include "PowerManager.h"
+#include <M5Unified.h>
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+PowerManager::PowerManager(unsigned long idleAfterMs, uint8_t idleBrightness, uint32_t idleCpuMhz)
+  : _idleAfterMs(idleAfterMs)
+  , _idleBrightness(idleBrightness)
+  , _idleCpuMhz(idleCpuMhz)
+  , _activeBrightness(0)
+  , _activeCpuMhz(0)
+  , _wakeTask(NULL)
+  , _lastActivity(0)
+  , _level(LEVEL_ACTIVE)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void PowerManager::begin(unsigned long now) {
+  _activeBrightness = M5.Display.getBrightness();
+  _activeCpuMhz = getCpuFrequencyMhz();
+  _lastActivity.store(now, std::memory_order_release);
+}
+
+void PowerManager::activity(unsigned long now) {
+  _lastActivity.store(now, std::memory_order_release);
+
+  // The UI task may be sleeping for a long idle frame
+  if (idle() && _wakeTask != NULL && xTaskGetCurrentTaskHandle() != _wakeTask) {
+    xTaskNotifyGive(_wakeTask);
+  }
+}
+
+bool PowerManager::update(unsigned long now) {
+  // Another task may have stored a millis() later than our now: no quiet time
+  // at all, not a wrap to ~ULONG_MAX
+  long quiet = (long)(now - _lastActivity.load(std::memory_order_acquire));
+  Level want = quiet > 0 && (unsigned long)quiet >= _idleAfterMs ? LEVEL_IDLE : LEVEL_ACTIVE;
+
+  if (want == level()) {
+    return false;
+  }
+
+  apply(want);
+  _level.store(want, std::memory_order_release);
+  Serial.println(want == LEVEL_IDLE ? "Power: idle" : "Power: active");
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+void PowerManager::apply(Level level) {
+  if (level == LEVEL_IDLE) {
+    M5.Display.setBrightness(_idleBrightness);
+    if (!setCpuFrequencyMhz(_idleCpuMhz)) {
+      Serial.println("CPU frequency change failed");
+    }
+  } else {
+    if (!setCpuFrequencyMhz(_activeCpuMhz)) {
+      Serial.println("CPU frequency change failed");
+    }
+    M5.Display.setBrightness(_activeBrightness);
+  }
+}
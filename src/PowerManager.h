@@ -0,0 +1,50 @@
+#ifndef POWERMANAGER_H
+#define POWERMANAGER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Drops the station into a low-power profile once nothing has happened for a
+// while, and back out on the first sign of activity.
+//
+// Any task may report activity (button, CAT frequency change, amp status
+// change). The UI task owns the transitions: update() applies CPU frequency
+// and backlight, everything else (poll back-off, WiFi modem sleep) follows
+// idle() in the task that owns it.
+class PowerManager {
+public:
+  enum Level {
+    LEVEL_ACTIVE,
+    LEVEL_IDLE
+  };
+
+  PowerManager(unsigned long idleAfterMs, uint8_t idleBrightness, uint32_t idleCpuMhz);
+
+  // Records the active CPU frequency and backlight, call after M5.begin()
+  void begin(unsigned long now);
+
+  // Any task; wakes the station on the next update(), or at once via the wake task
+  void activity(unsigned long now);
+  void setWakeTask(TaskHandle_t task) { _wakeTask = task; }
+
+  // UI task only; true if the level changed
+  bool update(unsigned long now);
+
+  Level level() const { return (Level)_level.load(std::memory_order_acquire); }
+  bool idle() const { return level() == LEVEL_IDLE; }
+
+private:
+  void apply(Level level);
+
+  unsigned long _idleAfterMs;
+  uint8_t _idleBrightness;
+  uint32_t _idleCpuMhz;
+  uint8_t _activeBrightness;
+  uint32_t _activeCpuMhz;
+  TaskHandle_t _wakeTask;
+
+  std::atomic<uint32_t> _lastActivity;
+  std::atomic<uint8_t> _level;
+};
+
+#endif // POWERMANAGER_H
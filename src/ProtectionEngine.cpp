@@ -0,0 +1,105 @@
+#include "ProtectionEngine.h"
+
+static const char* const TRIP_NAMES[] = {
+  "none", "fault", "SWR", "temperature", "low voltage", "high voltage"
+};
+
+static_assert(sizeof(TRIP_NAMES) / sizeof(TRIP_NAMES[0]) == ProtectionEngine::TRIP_COUNT,
+              "one name per trip");
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+ProtectionEngine::ProtectionEngine(const Limits& limits)
+  : _limits(limits)
+  , _lastTrip(TRIP_NONE)
+  , _lastFault(KXPA100Controller::FAULT_NONE)
+  , _trips(0)
+  , _failures(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+ProtectionEngine::Trip ProtectionEngine::check(const KXPA100Controller::StatusSnapshot& status,
+                                               uint16_t answered) {
+  if (!status.connected) return TRIP_NONE;
+
+  // The amp's own verdict comes first
+  if (answered & (1 << KXPA100Controller::PARAM_FAULTS)) {
+    KXPA100Controller::Fault fault = KXPA100Controller::decodeFault(status.faults);
+    if (fault != KXPA100Controller::FAULT_NONE && fault != KXPA100Controller::FAULT_UNKNOWN) {
+      _lastFault = fault;
+      return TRIP_FAULT;
+    }
+  }
+
+  // Rejected replies read INVALID_VALUE and are skipped
+  if ((answered & (1 << KXPA100Controller::PARAM_SWR)) &&
+      status.swrX10 != KXPA100Controller::INVALID_VALUE &&
+      status.powerX10 >= _limits.swrMinPowerX10 && status.swrX10 > _limits.swrMaxX10) {
+    return TRIP_SWR;
+  }
+
+  if ((answered & (1 << KXPA100Controller::PARAM_TEMP)) &&
+      status.tempX10 != KXPA100Controller::INVALID_VALUE && status.tempX10 > _limits.tempMaxX10) {
+    return TRIP_TEMP;
+  }
+
+  if ((answered & (1 << KXPA100Controller::PARAM_VOLTAGE)) &&
+      status.voltageMv != KXPA100Controller::INVALID_VALUE && status.voltageMv > 0) {
+    if (status.voltageMv < _limits.voltageMinMv) return TRIP_VOLTAGE_LOW;
+    if (status.voltageMv > _limits.voltageMaxMv) return TRIP_VOLTAGE_HIGH;
+  }
+
+  return TRIP_NONE;
+}
+
+void ProtectionEngine::record(Trip trip, bool bypassed) {
+  _lastTrip = trip;
+  _trips++;
+  if (!bypassed) {
+    _failures++;
+  }
+}
+
+const char* ProtectionEngine::name(Trip trip) {
+  return trip < TRIP_COUNT ? TRIP_NAMES[trip] : "?";
+}
+
+void ProtectionEngine::describe(Trip trip, const KXPA100Controller::StatusSnapshot& status,
+                                char* out, size_t len) const {
+  switch (trip) {
+    case TRIP_FAULT:
+    {
+      uint8_t active = 0;
+      KXPA100Controller::Fault fault = KXPA100Controller::decodeFault(status.faults, &active);
+      if (active > 1 && fault != KXPA100Controller::FAULT_OTHER) {
+        snprintf(out, len, "fault %s (%s +%u)", status.faults, KXPA100Controller::faultName(fault), active - 1);
+      } else {
+        snprintf(out, len, "fault %s (%s)", status.faults, KXPA100Controller::faultName(fault));
+      }
+      break;
+    }
+    case TRIP_SWR:
+      snprintf(out, len, "SWR %d.%d > %d.%d at %dW", status.swrX10 / 10, status.swrX10 % 10,
+               _limits.swrMaxX10 / 10, _limits.swrMaxX10 % 10, status.powerX10 / 10);
+      break;
+    case TRIP_TEMP:
+      snprintf(out, len, "temperature %d.%dC > %d.%dC", status.tempX10 / 10, abs(status.tempX10 % 10),
+               _limits.tempMaxX10 / 10, _limits.tempMaxX10 % 10);
+      break;
+    case TRIP_VOLTAGE_LOW:
+      snprintf(out, len, "supply %dmV < %dmV", status.voltageMv, _limits.voltageMinMv);
+      break;
+    case TRIP_VOLTAGE_HIGH:
+      snprintf(out, len, "supply %dmV > %dmV", status.voltageMv, _limits.voltageMaxMv);
+      break;
+    default:
+      snprintf(out, len, "%s", name(trip));
+      break;
+  }
+}
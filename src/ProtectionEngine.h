@@ -0,0 +1,60 @@
+#ifndef PROTECTIONENGINE_H
+#define PROTECTIONENGINE_H
+
+#include <Arduino.h>
+#include "KXPA100Controller.h"
+
+// Checks every fresh status sample against the amplifier's safe limits.
+//
+// The backend runs check() right after each poll, on the answered fields
+// only, and puts the amp into bypass on a trip before anything else is sent.
+// SWR is only judged above a minimum forward power, where the reading means
+// something. A fault code other than "no fault" always trips.
+class ProtectionEngine {
+public:
+  enum Trip : uint8_t {
+    TRIP_NONE = 0,
+    TRIP_FAULT,
+    TRIP_SWR,
+    TRIP_TEMP,
+    TRIP_VOLTAGE_LOW,
+    TRIP_VOLTAGE_HIGH,
+    TRIP_COUNT
+  };
+
+  struct Limits {
+    int16_t swrMaxX10;          // SWR × 10
+    int16_t swrMinPowerX10;     // W × 10, SWR is ignored below this
+    int16_t tempMaxX10;         // °C × 10
+    int16_t voltageMinMv;
+    int16_t voltageMaxMv;
+  };
+
+  explicit ProtectionEngine(const Limits& limits);
+
+  // First limit crossed by the fields in `answered` (1 << PollParam)
+  Trip check(const KXPA100Controller::StatusSnapshot& status, uint16_t answered);
+
+  // The amp was sent to bypass because of `trip`
+  void record(Trip trip, bool bypassed);
+
+  const Limits& limits() const { return _limits; }
+  Trip lastTrip() const { return _lastTrip; }
+  KXPA100Controller::Fault lastFault() const { return _lastFault; }
+  uint32_t trips() const { return _trips; }
+  uint32_t failures() const { return _failures; }
+  static const char* name(Trip trip);
+
+  // Trip reason and the offending value, e.g. "SWR 3.4 > 3.0"
+  void describe(Trip trip, const KXPA100Controller::StatusSnapshot& status,
+                char* out, size_t len) const;
+
+private:
+  Limits _limits;
+  Trip _lastTrip;
+  KXPA100Controller::Fault _lastFault;
+  uint32_t _trips;
+  uint32_t _failures;
+};
+
+#endif // PROTECTIONENGINE_H
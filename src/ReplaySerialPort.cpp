@@ -0,0 +1,116 @@
+#include "ReplaySerialPort.h"
+#include <esp_timer.h>
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+ReplaySerialPort::ReplaySerialPort()
+    : _txValid(false), _rxValid(false), _station(0), _open(false), _beginUs(0),
+      _offsetUs(0), _gateUs(UINT32_MAX), _rxHead(0), _rxTail(0),
+      _txMatched(0), _txMismatched(0), _rxDelivered(0) {}
+
+bool ReplaySerialPort::load(const uint8_t* capture, size_t len, uint8_t station) {
+  _txReader = FrameLog::Reader(capture, len);
+  _rxReader = _txReader;
+  _station = station;
+  _txMatched = 0;
+  _txMismatched = 0;
+  _rxDelivered = 0;
+  advance(_txReader, FrameLog::KXPA_TX, _tx, _txValid);
+  advance(_rxReader, FrameLog::KXPA_RX, _rx, _rxValid);
+  return _txReader.valid();
+}
+
+void ReplaySerialPort::begin(uint32_t, int, int, bool) {
+  // The first record of either direction plays right away
+  uint32_t firstUs = UINT32_MAX;
+  if (_txValid) firstUs = _tx.timeUs;
+  if (_rxValid && _rx.timeUs < firstUs) firstUs = _rx.timeUs;
+
+  _beginUs = esp_timer_get_time();
+  _offsetUs.store(firstUs == UINT32_MAX ? 0 : -(int32_t)firstUs, std::memory_order_release);
+  _gateUs.store(_txValid ? _tx.timeUs : UINT32_MAX, std::memory_order_release);
+  _open = true;
+}
+
+int ReplaySerialPort::available() {
+  uint16_t head = _rxHead.load(std::memory_order_acquire);
+  return (head - _rxTail.load(std::memory_order_relaxed) + RX_SIZE) % RX_SIZE;
+}
+
+int ReplaySerialPort::read() {
+  uint16_t tail = _rxTail.load(std::memory_order_relaxed);
+  if (tail == _rxHead.load(std::memory_order_acquire)) {
+    return -1;
+  }
+  char c = _rxBuf[tail];
+  _rxTail.store((tail + 1) % RX_SIZE, std::memory_order_release);
+  return (unsigned char)c;
+}
+
+size_t ReplaySerialPort::write(const char* data) {
+  size_t len = strlen(data);
+  int64_t replayUs = esp_timer_get_time() - _beginUs;
+
+  if (!_txValid) {
+    _txMismatched++;            // beyond the end of the capture
+    return len;
+  }
+  if (len == _tx.len && memcmp(data, _tx.data, len) == 0) {
+    _txMatched++;
+  } else {
+    _txMismatched++;
+  }
+
+  // Offset first: a pump that sees the new gate also sees the new timeline
+  _offsetUs.store((int32_t)(replayUs - (int64_t)_tx.timeUs), std::memory_order_release);
+  advance(_txReader, FrameLog::KXPA_TX, _tx, _txValid);
+  _gateUs.store(_txValid ? _tx.timeUs : UINT32_MAX, std::memory_order_release);
+  return len;
+}
+
+void ReplaySerialPort::pump(int64_t nowUs) {
+  bool delivered = false;
+
+  while (_open && nextDueUs() <= nowUs) {
+    uint16_t head = _rxHead.load(std::memory_order_relaxed);
+    for (uint8_t i = 0; i < _rx.len; ++i) {
+      uint16_t next = (head + 1) % RX_SIZE;
+      if (next == _rxTail.load(std::memory_order_acquire)) break;   // overflow, like a UART FIFO
+      _rxBuf[head] = (char)_rx.data[i];
+      head = next;
+    }
+    _rxHead.store(head, std::memory_order_release);
+    _rxDelivered++;
+    delivered = true;
+    advance(_rxReader, FrameLog::KXPA_RX, _rx, _rxValid);
+  }
+
+  if (delivered && _callback) {
+    _callback();
+  }
+}
+
+int64_t ReplaySerialPort::nextDueUs() const {
+  if (!_open || !_rxValid || _rx.timeUs > _gateUs.load(std::memory_order_acquire)) {
+    return INT64_MAX;
+  }
+  return _beginUs + (int64_t)_rx.timeUs + _offsetUs.load(std::memory_order_acquire);
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+bool ReplaySerialPort::advance(FrameLog::Reader& reader, FrameLog::Kind kind,
+                               FrameLog::Record& rec, bool& valid) {
+  while (reader.next(rec)) {
+    if (rec.station == _station && rec.kind == kind) {
+      valid = true;
+      return true;
+    }
+  }
+  valid = false;
+  return false;
+}
@@ -0,0 +1,82 @@
+#ifndef REPLAYSERIALPORT_H
+#define REPLAYSERIALPORT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <limits.h>
+#include "SerialPort.h"
+#include "FrameLog.h"
+
+// A captured KXPA100 (see FrameLog) on the other end of the line.
+//
+// Every RX frame of one station is played back at its captured distance to
+// the last TX before it: each command the controller writes is matched
+// against the next captured TX and re-anchors the timeline there, so reply
+// latencies, late frames and timeouts repeat even when the controller sends
+// a little earlier or later than it did in the field. Commands that differ
+// from the capture are counted, the replay carries on in capture order.
+//
+// Something has to call pump() like the UART event task would: a pump task
+// on the bench (KXPA_REPLAY), a sim device in the native tests. pump() runs
+// on that task only and not before begin(); write() on the controller's
+// task. They share the timeline through two atomics and the RX buffer is
+// SPSC, like the controller's own frame queue.
+class ReplaySerialPort : public SerialPort {
+public:
+  ReplaySerialPort();
+
+  // Capture image (FrameLog::dump()), stays owned by the caller; false if it is none
+  bool load(const uint8_t* capture, size_t len, uint8_t station);
+
+  // SerialPort
+  void begin(uint32_t baud, int rxPin, int txPin, bool inverted) override;
+  bool isOpen() override { return _open; }
+  int available() override;
+  int read() override;
+  size_t write(const char* data) override;
+  void onReceive(std::function<void(void)> callback) override { _callback = callback; }
+
+  // Moves every frame due by nowUs (esp_timer) into the RX buffer, then calls back
+  void pump(int64_t nowUs);
+
+  // esp_timer time of the next RX frame, INT64_MAX while it waits for a TX or at the end
+  int64_t nextDueUs() const;
+
+  bool finished() const { return !_rxValid && !_txValid; }
+  uint32_t txMatched() const { return _txMatched; }
+  uint32_t txMismatched() const { return _txMismatched; }
+  uint32_t rxDelivered() const { return _rxDelivered; }
+
+private:
+  static const uint16_t RX_SIZE = 256;
+
+  // Next record of this station's KXPA link of the given kind
+  bool advance(FrameLog::Reader& reader, FrameLog::Kind kind, FrameLog::Record& rec, bool& valid);
+
+  FrameLog::Reader _txReader;
+  FrameLog::Reader _rxReader;
+  FrameLog::Record _tx;         // next captured command
+  FrameLog::Record _rx;         // next captured frame from the amp
+  bool _txValid;
+  bool _rxValid;
+  uint8_t _station;
+  bool _open;
+
+  // Timeline: replay time since begin() = capture time + offset, moved by
+  // every TX; RX frames captured after the next TX (gate) wait for it
+  int64_t _beginUs;
+  std::atomic<int32_t> _offsetUs;
+  std::atomic<uint32_t> _gateUs;  // UINT32_MAX = no TX left
+
+  // SPSC: pump() -> read()
+  char _rxBuf[RX_SIZE];
+  std::atomic<uint16_t> _rxHead;
+  std::atomic<uint16_t> _rxTail;
+  std::function<void(void)> _callback;
+
+  uint32_t _txMatched;
+  uint32_t _txMismatched;
+  uint32_t _rxDelivered;
+};
+
+#endif // REPLAYSERIALPORT_H
@@ -0,0 +1,23 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+// Byte stream the KXPA100 is attached to.
+//
+// The firmware uses HardwareSerialPort (see HardwareSerialPort.h), the native
+// test environment a scripted amplifier emulator. Only what the controller
+// really needs is here: the UART is driven entirely by the receive callback.
+class SerialPort {
+public:
+  virtual ~SerialPort() {}
+
+  virtual void begin(uint32_t baud, int rxPin, int txPin, bool inverted) = 0;
+  virtual bool isOpen() = 0;
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual size_t write(const char* data) = 0;
+
+  // Called from the UART event task whenever bytes have arrived
+  virtual void onReceive(std::function<void(void)> callback) = 0;
+};
@@ -0,0 +1,219 @@
+#include "SettingsStore.h"
+
+//-----------------------------------------------------------------------------
+// Constants
+//-----------------------------------------------------------------------------
+
+static const char* const NAMESPACE = "kxpa";
+static const char* const TUNE_KEY = "tune";
+static const char* const STATE_KEY = "state";
+static const char* const WIFI_KEY = "wifi";
+
+// Console names and accepted ranges, in the order of get()/set()
+const SettingsStore::Key SettingsStore::KEYS[] = {
+  {"baud",    4800,  38400},
+  {"delay",   1,     500},
+  {"catpoll", 10,    1000},
+  {"dwell",   0,     5000},
+  {"ant2",    0,     (1 << 11) - 1}
+};
+
+const uint8_t SettingsStore::KEY_COUNT = sizeof(KEYS) / sizeof(KEYS[0]);
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+SettingsStore::SettingsStore(const Tuning& defaults)
+  : _defaults(defaults)
+  , _tuning(defaults)
+  , _dirty(false)
+  , _changedAt(0)
+  , _writes(0)
+{
+  // Blobs are compared byte for byte, padding included
+  memset(&_state, 0, sizeof(_state));
+  _state.version = VERSION;
+  for (uint8_t i = 0; i < STATION_MAX; ++i) {
+    _state.stations[i].band = -1;
+    _state.stations[i].mode = -1;
+  }
+  _saved = _state;
+  memset(&_wifi, 0, sizeof(_wifi));
+  _wifi.version = VERSION;
+  _wifiSaved = _wifi;
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void SettingsStore::begin() {
+  if (!_tunePrefs.begin(NAMESPACE, false) || !_statePrefs.begin(NAMESPACE, false)) {
+    Serial.println("NVS not available, using defaults");
+    return;
+  }
+
+  TuneBlob tune;
+  if (_tunePrefs.getBytesLength(TUNE_KEY) == sizeof(tune) &&
+      _tunePrefs.getBytes(TUNE_KEY, &tune, sizeof(tune)) == sizeof(tune) &&
+      tune.version == VERSION) {
+    _tuning = tune.tuning;
+  }
+
+  StateBlob state;
+  if (_statePrefs.getBytesLength(STATE_KEY) == sizeof(state) &&
+      _statePrefs.getBytes(STATE_KEY, &state, sizeof(state)) == sizeof(state) &&
+      state.version == VERSION) {
+    for (uint8_t i = 0; i < STATION_MAX; ++i) {
+      state.stations[i].catHost[HOST_MAX - 1] = '\0';
+    }
+    _state = state;
+    _saved = state;
+  }
+
+  WifiBlob wifi;
+  if (_statePrefs.getBytesLength(WIFI_KEY) == sizeof(wifi) &&
+      _statePrefs.getBytes(WIFI_KEY, &wifi, sizeof(wifi)) == sizeof(wifi) &&
+      wifi.version == VERSION) {
+    wifi.cache.ssid[sizeof(wifi.cache.ssid) - 1] = '\0';
+    _wifi = wifi;
+    _wifiSaved = wifi;
+  }
+}
+
+// Checked against KEYS[], saved at once; false for an unknown key or a value out of range
+bool SettingsStore::setTuning(const char* key, uint32_t value) {
+  for (uint8_t k = 0; k < KEY_COUNT; ++k) {
+    if (strcmp(key, KEYS[k].name) != 0) continue;
+    if (value < KEYS[k].min || value > KEYS[k].max) return false;
+
+    set(_tuning, k, value);
+    TuneBlob tune;
+    memset(&tune, 0, sizeof(tune));
+    tune.version = VERSION;
+    tune.tuning = _tuning;
+    return _tunePrefs.putBytes(TUNE_KEY, &tune, sizeof(tune)) == sizeof(tune);
+  }
+  return false;
+}
+
+void SettingsStore::resetTuning() {
+  _tuning = _defaults;
+  _tunePrefs.remove(TUNE_KEY);
+}
+
+void SettingsStore::printTuning(Print& out) const {
+  for (uint8_t k = 0; k < KEY_COUNT; ++k) {
+    out.print(KEYS[k].name);
+    out.print(" = ");
+    out.print((unsigned long)get(_tuning, k));
+    out.print(" (default ");
+    out.print((unsigned long)get(_defaults, k));
+    out.print(", ");
+    out.print((unsigned long)KEYS[k].min);
+    out.print("..");
+    out.print((unsigned long)KEYS[k].max);
+    out.println(")");
+  }
+}
+
+const SettingsStore::StationState& SettingsStore::station(uint8_t index) const {
+  return _state.stations[index < STATION_MAX ? index : 0];
+}
+
+void SettingsStore::setBand(uint8_t index, int8_t band, unsigned long now) {
+  if (index >= STATION_MAX || _state.stations[index].band == band) return;
+  _state.stations[index].band = band;
+  stateChanged(now);
+}
+
+void SettingsStore::setMode(uint8_t index, int8_t mode, unsigned long now) {
+  if (index >= STATION_MAX || _state.stations[index].mode == mode) return;
+  _state.stations[index].mode = mode;
+  stateChanged(now);
+}
+
+void SettingsStore::setCatEndpoint(uint8_t index, const char* host, uint16_t port, unsigned long now) {
+  if (index >= STATION_MAX || host == NULL) return;
+  StationState& s = _state.stations[index];
+  if (s.catPort == port && strncmp(s.catHost, host, HOST_MAX - 1) == 0) return;
+
+  memset(s.catHost, 0, sizeof(s.catHost));
+  strncpy(s.catHost, host, HOST_MAX - 1);
+  s.catPort = port;
+  stateChanged(now);
+}
+
+void SettingsStore::setWifiCache(const WifiCache& cache, unsigned long now) {
+  if (memcmp(&_wifi.cache, &cache, sizeof(cache)) == 0) return;
+  _wifi.cache = cache;
+  stateChanged(now);
+}
+
+// Writes what changed once it has been stable for SAVE_DELAY_MS; true if it did
+bool SettingsStore::update(unsigned long now) {
+  if (!_dirty || now - _changedAt < SAVE_DELAY_MS) {
+    return false;
+  }
+  _dirty = false;
+
+  // Changed and changed back: nothing to write
+  bool wrote = false;
+  if (memcmp(&_state, &_saved, sizeof(_state)) != 0) {
+    if (_statePrefs.putBytes(STATE_KEY, &_state, sizeof(_state)) == sizeof(_state)) {
+      _saved = _state;
+      _writes++;
+      wrote = true;
+    } else {
+      Serial.println("NVS: state not saved");
+    }
+  }
+  if (memcmp(&_wifi, &_wifiSaved, sizeof(_wifi)) != 0) {
+    if (_statePrefs.putBytes(WIFI_KEY, &_wifi, sizeof(_wifi)) == sizeof(_wifi)) {
+      _wifiSaved = _wifi;
+      _writes++;
+      wrote = true;
+    } else {
+      Serial.println("NVS: wifi not saved");
+    }
+  }
+  return wrote;
+}
+
+unsigned long SettingsStore::msUntilSave(unsigned long now) const {
+  if (!_dirty) return ULONG_MAX;
+  unsigned long elapsed = now - _changedAt;
+  return elapsed >= SAVE_DELAY_MS ? 0 : SAVE_DELAY_MS - elapsed;
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+uint32_t SettingsStore::get(const Tuning& t, uint8_t key) {
+  switch (key) {
+    case 0: return t.baud;
+    case 1: return t.delayCommMs;
+    case 2: return t.catPollMs;
+    case 3: return t.bandDwellMs;
+    case 4: return t.ant2Mask;
+  }
+  return 0;
+}
+
+void SettingsStore::set(Tuning& t, uint8_t key, uint32_t value) {
+  switch (key) {
+    case 0: t.baud = value; break;
+    case 1: t.delayCommMs = (uint16_t)value; break;
+    case 2: t.catPollMs = (uint16_t)value; break;
+    case 3: t.bandDwellMs = (uint16_t)value; break;
+    case 4: t.ant2Mask = (uint16_t)value; break;
+  }
+}
+
+// Every change restarts the delay
+void SettingsStore::stateChanged(unsigned long now) {
+  _dirty = true;
+  _changedAt = now;
+}
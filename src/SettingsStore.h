@@ -0,0 +1,106 @@
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include <Preferences.h>
+#include "WifiCache.h"
+
+// Settings that survive a reboot, kept in NVS (namespace "kxpa").
+//
+// Two groups of blobs with one writer each. "tune" holds the tuning parameters: loaded
+// at boot, changed from the serial console (UI task) and applied on the next
+// boot. "state" holds what the backend last saw per station - band, mode and
+// the CAT endpoint that last answered - and "wifi" the last association
+// (see WifiCache); both are written by the backend task.
+// State changes are saved once they have been stable for SAVE_DELAY_MS, so a
+// QSY across several bands costs one flash write, and an unchanged blob is
+// never rewritten. A blob with the wrong size or version is ignored and the
+// compiled defaults are used.
+class SettingsStore {
+public:
+  static const uint8_t VERSION = 1;
+  static const uint8_t STATION_MAX = 2;
+  static const uint8_t HOST_MAX = 40;
+  static const uint16_t SAVE_DELAY_MS = 5000;
+
+  struct Tuning {
+    uint32_t baud;
+    uint16_t delayCommMs;         // assumed KXPA turnaround until measured
+    uint16_t catPollMs;
+    uint16_t bandDwellMs;
+    uint16_t ant2Mask;            // bit (1 << band) = ANT2
+  };
+
+  struct StationState {
+    int8_t band;                  // -1 = none saved
+    int8_t mode;                  // KXPA100Controller::Mode, MODE_UNKNOWN = none saved
+    uint16_t catPort;
+    char catHost[HOST_MAX];       // "" = none saved
+  };
+
+  explicit SettingsStore(const Tuning& defaults);
+
+  // Loads both blobs, call before the tasks start
+  void begin();
+
+  // Tuning (UI task after begin)
+  const Tuning& tuning() const { return _tuning; }
+  bool setTuning(const char* key, uint32_t value);
+  void resetTuning();
+  void printTuning(Print& out) const;
+
+  // State (backend task after begin)
+  const StationState& station(uint8_t index) const;
+  void setBand(uint8_t index, int8_t band, unsigned long now);
+  void setMode(uint8_t index, int8_t mode, unsigned long now);
+  void setCatEndpoint(uint8_t index, const char* host, uint16_t port, unsigned long now);
+  const WifiCache& wifiCache() const { return _wifi.cache; }
+  void setWifiCache(const WifiCache& cache, unsigned long now);
+  bool update(unsigned long now);
+  unsigned long msUntilSave(unsigned long now) const;
+  uint32_t writes() const { return _writes; }       // state and wifi blob writes
+
+private:
+  struct TuneBlob {
+    uint8_t version;
+    Tuning tuning;
+  };
+
+  struct StateBlob {
+    uint8_t version;
+    StationState stations[STATION_MAX];
+  };
+
+  struct WifiBlob {
+    uint8_t version;
+    WifiCache cache;
+  };
+
+  struct Key {
+    const char* name;
+    uint32_t min;
+    uint32_t max;
+  };
+
+  static const Key KEYS[];
+  static const uint8_t KEY_COUNT;
+
+  static uint32_t get(const Tuning& t, uint8_t key);
+  static void set(Tuning& t, uint8_t key, uint32_t value);
+  void stateChanged(unsigned long now);
+
+  Preferences _tunePrefs;         // UI task
+  Preferences _statePrefs;        // backend task
+  const Tuning _defaults;
+  Tuning _tuning;
+  StateBlob _state;
+  StateBlob _saved;               // as in flash
+  WifiBlob _wifi;
+  WifiBlob _wifiSaved;
+  bool _dirty;
+  unsigned long _changedAt;
+  uint32_t _writes;
+};
+
+#endif // SETTINGSSTORE_H
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free single-producer / single-consumer ring buffer.
+// One slot is kept free to tell "full" from "empty", so it holds N - 1 items.
+template <typename T, uint8_t N>
+class SpscQueue {
+public:
+  SpscQueue() : _head(0), _tail(0) {}
+
+  // Producer side; returns false if the queue is full
+  bool push(const T& item) {
+    uint8_t head = _head.load(std::memory_order_relaxed);
+    uint8_t next = (head + 1) % N;
+    if (next == _tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    _items[head] = item;
+    _head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side; returns false if the queue is empty
+  bool pop(T& item) {
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = _items[tail];
+    _tail.store((tail + 1) % N, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return _tail.load(std::memory_order_acquire) ==
+           _head.load(std::memory_order_acquire);
+  }
+
+private:
+  T _items[N];
+  std::atomic<uint8_t> _head;
+  std::atomic<uint8_t> _tail;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+#include "CatSource.h"
+#include "LatencyStats.h"
+
+// Scripted rig for the soak benchmark: no radio, no network.
+//
+// The frequency walks through a fixed table, one entry every stepMs, and
+// starts over at the end, so a run of any length keeps the backend switching
+// bands. Queries are answered replyMs after requestFrequency() like a rigctld
+// on the LAN, through the same takeFrequency() path as the real sources.
+class SweepCatSource : public CatSource {
+public:
+  SweepCatSource(const uint32_t* freqs, uint8_t count, unsigned long stepMs, unsigned long replyMs)
+      : _freqs(freqs), _count(count), _stepMs(stepMs > 0 ? stepMs : 1), _replyMs(replyMs),
+        _connected(false), _startMs(0), _requestPending(false), _requestSentAt(0),
+        _requestSentUs(0), _freq(0), _freqFresh(false) {}
+
+  void begin() override {
+    _connected = _count > 0;
+    _startMs = millis();
+  }
+
+  void update() override {
+    if (!_requestPending || millis() - _requestSentAt < _replyMs) {
+      return;
+    }
+    _freq = frequency(millis());
+
+    char line[12];
+    snprintf(line, sizeof(line), "%lu", (unsigned long)_freq);
+    logFrame(FrameLog::CAT_RX, line, strlen(line));
+    LatencyStats::record(LatencyStats::T_CAT_REPLY, (uint32_t)(esp_timer_get_time() - _requestSentUs));
+    _freqFresh = true;
+    _requestPending = false;
+  }
+
+  bool isConnected() override { return _connected; }
+
+  bool requestFrequency() override {
+    if (!_connected || _requestPending) {
+      return false;
+    }
+    logFrame(FrameLog::CAT_TX, "+f", 2);
+    _requestPending = true;
+    _requestSentAt = millis();
+    _requestSentUs = esp_timer_get_time();
+    return true;
+  }
+
+  bool takeFrequency(uint32_t& freq) override {
+    if (!_freqFresh) {
+      return false;
+    }
+    freq = _freq;
+    _freqFresh = false;
+    return true;
+  }
+
+  unsigned long msUntilWork(unsigned long now) override {
+    if (!_requestPending) {
+      return ULONG_MAX;
+    }
+    unsigned long elapsed = now - _requestSentAt;
+    return elapsed >= _replyMs ? 0 : _replyMs - elapsed;
+  }
+
+  // Where the rig is at the given time
+  uint32_t frequency(unsigned long now) const {
+    return _count > 0 ? _freqs[((now - _startMs) / _stepMs) % _count] : 0;
+  }
+
+private:
+  const uint32_t* _freqs;
+  uint8_t _count;
+  unsigned long _stepMs;
+  unsigned long _replyMs;
+  bool _connected;
+  unsigned long _startMs;
+
+  bool _requestPending;
+  unsigned long _requestSentAt;
+  int64_t _requestSentUs;
+  uint32_t _freq;
+  bool _freqFresh;
+};
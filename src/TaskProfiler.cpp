@@ -0,0 +1,211 @@
+#include "TaskProfiler.h"
+#include <esp_heap_caps.h>
+
+//-----------------------------------------------------------------------------
+// Storage
+//-----------------------------------------------------------------------------
+
+TaskProfiler::LoopCounters TaskProfiler::_loops[LOOP_COUNT];
+TaskProfiler::Watched TaskProfiler::_watched[WATCH_MAX];
+uint8_t TaskProfiler::_watchCount = 0;
+
+static const char* const LOOP_NAMES[] = { "ui", "backend" };
+
+static_assert(sizeof(LOOP_NAMES) / sizeof(LOOP_NAMES[0]) == TaskProfiler::LOOP_COUNT,
+              "one name per loop");
+
+// Reader side (sample() only): the snapshot and what the previous one saw
+static TaskStatus_t statusBuf[TaskProfiler::TASKS_MAX];
+static TaskHandle_t prevTask[TaskProfiler::TASKS_MAX];
+static uint32_t prevRun[TaskProfiler::TASKS_MAX];
+static uint8_t prevCount = 0;
+static uint32_t prevTotalRun = 0;
+static int64_t prevSampleUs = 0;
+static uint32_t prevPasses[TaskProfiler::LOOP_COUNT];
+static uint32_t prevBusyUs[TaskProfiler::LOOP_COUNT];
+
+static uint16_t permille(uint32_t part, uint32_t whole) {
+  if (whole == 0) return TaskProfiler::UNKNOWN;
+  uint32_t p = (uint32_t)((uint64_t)part * 1000 / whole);
+  return p > 1000 ? 1000 : (uint16_t)p;
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void TaskProfiler::pass(Loop loop, uint32_t busyUs) {
+  LoopCounters& c = _loops[loop];
+  c.passes.fetch_add(1, std::memory_order_relaxed);
+  c.busyUs.fetch_add(busyUs, std::memory_order_relaxed);
+  // Only this task raises it, sample() may reset it in between (one pass lost)
+  if (busyUs > c.maxUs.load(std::memory_order_relaxed)) {
+    c.maxUs.store(busyUs, std::memory_order_relaxed);
+  }
+}
+
+bool TaskProfiler::watch(TaskHandle_t task, uint32_t stackSize, int8_t core) {
+  if (task == NULL || _watchCount >= WATCH_MAX) {
+    return false;
+  }
+  _watched[_watchCount].task = task;
+  _watched[_watchCount].stackSize = stackSize;
+  _watched[_watchCount].core = core;
+  _watchCount++;
+  return true;
+}
+
+void TaskProfiler::sample(Report& out) {
+  memset(&out, 0, sizeof(out));
+  int64_t nowUs = esp_timer_get_time();
+  uint32_t periodUs = (uint32_t)(nowUs - prevSampleUs);
+  out.periodMs = periodUs / 1000;
+  prevSampleUs = nowUs;
+
+  // Loops: deltas of counters that only ever grow
+  for (uint8_t i = 0; i < LOOP_COUNT; ++i) {
+    uint32_t passes = _loops[i].passes.load(std::memory_order_relaxed);
+    uint32_t busyUs = _loops[i].busyUs.load(std::memory_order_relaxed);
+    LoopRow& row = out.loops[i];
+    row.passes = passes - prevPasses[i];
+    row.hz = out.periodMs > 0 ? (uint16_t)min((uint32_t)UINT16_MAX,
+                                              (uint32_t)((uint64_t)row.passes * 1000 / out.periodMs)) : 0;
+    row.busyPermille = permille(busyUs - prevBusyUs[i], periodUs);
+    row.maxUs = _loops[i].maxUs.exchange(0, std::memory_order_relaxed);
+    prevPasses[i] = passes;
+    prevBusyUs[i] = busyUs;
+  }
+
+  // Heap: the largest block is what the next sprite can get
+  out.heapFree = ESP.getFreeHeap();
+  out.heapMinFree = ESP.getMinFreeHeap();
+  out.heapLargest = ESP.getMaxAllocHeap();
+  out.heapFragPct = out.heapFree > 0 ? (uint8_t)(100 - (uint64_t)out.heapLargest * 100 / out.heapFree) : 0;
+  out.dmaFree = heap_caps_get_free_size(MALLOC_CAP_DMA);
+  out.dmaLargest = heap_caps_get_largest_free_block(MALLOC_CAP_DMA);
+
+  // Tasks: one snapshot, the scheduler is suspended while it is taken
+  uint32_t totalRun = 0;
+  out.taskTotal = (uint8_t)min((UBaseType_t)UINT8_MAX, uxTaskGetNumberOfTasks());
+  uint8_t count = (uint8_t)uxTaskGetSystemState(statusBuf, TASKS_MAX, &totalRun);
+  uint32_t runPeriod = totalRun - prevTotalRun;
+  bool runStats = totalRun != 0;
+
+  out.coreLoadPermille[0] = UNKNOWN;
+  out.coreLoadPermille[1] = UNKNOWN;
+  TaskHandle_t idle[2] = { xTaskGetIdleTaskHandleForCPU(0), xTaskGetIdleTaskHandleForCPU(1) };
+
+  for (uint8_t i = 0; i < count; ++i) {
+    const TaskStatus_t& st = statusBuf[i];
+    TaskRow& row = out.tasks[i];
+    strncpy(row.name, st.pcTaskName, sizeof(row.name) - 1);
+    row.stackFree = st.usStackHighWaterMark;
+    row.core = -1;
+    row.cpuPermille = UNKNOWN;
+
+#if configTASKLIST_INCLUDE_COREID
+    row.core = st.xCoreID == tskNO_AFFINITY ? -1 : (int8_t)st.xCoreID;
+#endif
+    for (uint8_t w = 0; w < _watchCount; ++w) {
+      if (_watched[w].task == st.xHandle) {
+        row.stackSize = _watched[w].stackSize;
+        row.core = _watched[w].core;
+      }
+    }
+
+    if (runStats) {
+      // A task born since the previous sample has no baseline yet
+      bool known = prevTotalRun == 0;
+      uint32_t before = 0;
+      for (uint8_t p = 0; p < prevCount; ++p) {
+        if (prevTask[p] == st.xHandle) {
+          before = prevRun[p];
+          known = true;
+        }
+      }
+      if (known) {
+        row.cpuPermille = permille(st.ulRunTimeCounter - before, runPeriod);
+      }
+    }
+
+    for (uint8_t c = 0; c < 2; ++c) {
+      if (st.xHandle == idle[c]) {
+        row.core = c;
+        if (row.cpuPermille != UNKNOWN) {
+          out.coreLoadPermille[c] = 1000 - row.cpuPermille;
+        }
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < count; ++i) {
+    prevTask[i] = statusBuf[i].xHandle;
+    prevRun[i] = statusBuf[i].ulRunTimeCounter;
+  }
+  prevCount = count;
+  prevTotalRun = totalRun;
+
+  // Tightest stack first
+  for (uint8_t i = 1; i < count; ++i) {
+    TaskRow row = out.tasks[i];
+    uint8_t j = i;
+    while (j > 0 && out.tasks[j - 1].stackFree > row.stackFree) {
+      out.tasks[j] = out.tasks[j - 1];
+      --j;
+    }
+    out.tasks[j] = row;
+  }
+  out.taskCount = count;
+}
+
+void TaskProfiler::formatShare(char* out, size_t len, uint16_t permille) {
+  if (permille == UNKNOWN) {
+    snprintf(out, len, "-");
+  } else {
+    snprintf(out, len, "%u.%u%%", permille / 10, permille % 10);
+  }
+}
+
+void TaskProfiler::print(Print& out, const Report& r) {
+  char line[80];
+  char load[2][8];
+
+  snprintf(line, sizeof(line), "heap free %lu, min %lu, largest %lu (%u%% fragmented), dma %lu / %lu",
+           (unsigned long)r.heapFree, (unsigned long)r.heapMinFree, (unsigned long)r.heapLargest,
+           r.heapFragPct, (unsigned long)r.dmaFree, (unsigned long)r.dmaLargest);
+  out.println(line);
+
+  formatShare(load[0], sizeof(load[0]), r.coreLoadPermille[0]);
+  formatShare(load[1], sizeof(load[1]), r.coreLoadPermille[1]);
+  snprintf(line, sizeof(line), "core load: 0 %s, 1 %s over %lu ms", load[0], load[1],
+           (unsigned long)r.periodMs);
+  out.println(line);
+
+  out.println("loop        passes     Hz    busy  max us");
+  for (uint8_t i = 0; i < LOOP_COUNT; ++i) {
+    const LoopRow& l = r.loops[i];
+    formatShare(load[0], sizeof(load[0]), l.busyPermille);
+    snprintf(line, sizeof(line), "%-10s %7lu %6u %7s %7lu", LOOP_NAMES[i],
+             (unsigned long)l.passes, l.hz, load[0], (unsigned long)l.maxUs);
+    out.println(line);
+  }
+
+  out.println("task             core   stack    free     cpu  [bytes]");
+  for (uint8_t i = 0; i < r.taskCount; ++i) {
+    const TaskRow& t = r.tasks[i];
+    char core[4];
+    char size[12];
+    if (t.core < 0) snprintf(core, sizeof(core), "-");
+    else snprintf(core, sizeof(core), "%d", t.core);
+    if (t.stackSize == 0) snprintf(size, sizeof(size), "-");
+    else snprintf(size, sizeof(size), "%lu", (unsigned long)t.stackSize);
+    formatShare(load[0], sizeof(load[0]), t.cpuPermille);
+    snprintf(line, sizeof(line), "%-16s %4s %7s %7lu %7s", t.name, core, size,
+             (unsigned long)t.stackFree, load[0]);
+    out.println(line);
+  }
+  if (r.taskCount == 0 && r.taskTotal > 0) {
+    snprintf(line, sizeof(line), "%u tasks, the snapshot holds %u: raise TASKS_MAX", r.taskTotal, TASKS_MAX);
+    out.println(line);
+  }
+}
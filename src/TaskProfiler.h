@@ -0,0 +1,115 @@
+#ifndef TASKPROFILER_H
+#define TASKPROFILER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Where the CPU and RAM actually go, both cores.
+//
+// The UI loop and the backend task report every pass (wake-up to going back
+// to sleep) through a Scope, which gives their iteration rate and busy share
+// without any FreeRTOS support. sample() then takes one uxTaskGetSystemState()
+// snapshot: the stack high-water mark of every task (bytes on the ESP32),
+// their run-time share where the core was built with run-time stats, and the
+// heap (free, minimum free, largest block). Sampling walks every task list
+// with the scheduler suspended, so it only runs while someone is looking
+// (profiling page, serial "prof").
+class TaskProfiler {
+public:
+  enum Loop : uint8_t {
+    LOOP_UI,                                  // loop(), core 1
+    LOOP_BACKEND,                             // backendTask(), core 0
+    LOOP_COUNT
+  };
+
+  // Rows of one snapshot. uxTaskGetSystemState() fills nothing when there are
+  // more tasks than rows, and WiFi, BT, the web server and the UART drivers
+  // already bring a build to about 25, so this leaves plenty of headroom
+  static const uint8_t TASKS_MAX = 48;
+  static const uint8_t WATCH_MAX = 6;         // tasks with a known stack size
+  static const uint16_t UNKNOWN = 0xFFFF;     // no run-time stats in this build
+
+  struct TaskRow {
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t stackSize;                       // 0 = not watched
+    uint32_t stackFree;                       // smallest ever, bytes
+    uint16_t cpuPermille;                     // of one core, or UNKNOWN
+    int8_t core;                              // -1 = not pinned / unknown
+  };
+
+  struct LoopRow {
+    uint32_t passes;
+    uint16_t hz;
+    uint16_t busyPermille;                    // of its core
+    uint32_t maxUs;                           // longest pass
+  };
+
+  struct Report {
+    uint32_t periodMs;                        // since the previous sample
+    uint32_t heapFree;
+    uint32_t heapMinFree;
+    uint32_t heapLargest;
+    uint8_t heapFragPct;                      // 100 - largest / free
+    uint32_t dmaFree;                         // sprites and DMA transfers come from here
+    uint32_t dmaLargest;
+    uint16_t coreLoadPermille[2];             // 1000 - idle share, or UNKNOWN
+    LoopRow loops[LOOP_COUNT];
+    TaskRow tasks[TASKS_MAX];
+    uint8_t taskCount;
+    uint8_t taskTotal;                        // > TASKS_MAX: taskCount is 0, no table
+  };
+
+  // Times one pass of an instrumented loop (owner task only)
+  class Scope {
+  public:
+    explicit Scope(Loop loop) : _loop(loop), _start(esp_timer_get_time()), _open(true) {}
+    ~Scope() { end(); }
+
+    // Call before going back to sleep, the wait is not part of the pass
+    void end() {
+      if (_open) {
+        TaskProfiler::pass(_loop, (uint32_t)(esp_timer_get_time() - _start));
+        _open = false;
+      }
+    }
+  private:
+    Loop _loop;
+    int64_t _start;
+    bool _open;
+  };
+
+  static void pass(Loop loop, uint32_t busyUs);
+
+  // Before sample(): stack size and core of a task we created (setup only)
+  static bool watch(TaskHandle_t task, uint32_t stackSize, int8_t core);
+
+  // Rates and shares over the time since the previous call (one reader task)
+  static void sample(Report& out);
+
+  static void print(Print& out, const Report& r);
+
+  // "12.3%", or "-" for UNKNOWN
+  static void formatShare(char* out, size_t len, uint16_t permille);
+
+private:
+  struct LoopCounters {
+    std::atomic<uint32_t> passes;
+    std::atomic<uint32_t> busyUs;             // wraps after 71 min, only deltas are used
+    std::atomic<uint32_t> maxUs;              // taken (reset) by sample()
+  };
+
+  struct Watched {
+    TaskHandle_t task;
+    uint32_t stackSize;
+    int8_t core;
+  };
+
+  static LoopCounters _loops[LOOP_COUNT];
+  static Watched _watched[WATCH_MAX];
+  static uint8_t _watchCount;
+};
+
+#endif // TASKPROFILER_H
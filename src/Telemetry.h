@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "KXPA100Controller.h"
+
+// One station's state as published by the backend: read by the UI through a
+// TripleBuffer and exported by TelemetryPublisher.
+struct Telemetry {
+  int8_t bandIndex = -1;      // -1 = not known yet
+  int16_t powerX10 = 0;       // W × 10
+  int16_t tempX10 = 0;        // °C × 10
+  int16_t swrX10 = 10;        // SWR × 10
+  int8_t antenna = 0;         // 1/2, 0 = unknown
+  int8_t mode = KXPA100Controller::MODE_UNKNOWN;
+  char faults[KXPA100Controller::FAULTS_MAX] = "";
+  int16_t voltageMv = 0;      // mV
+  
+  bool catConnected = false;
+  bool kxpaConnected = false;
+  
+  // Sequence number of the last command the backend has applied
+  uint32_t commandAck = 0;
+};
+
+// Dirty bits for optimized rendering, set by the backend, taken by the UI
+enum : uint32_t {
+  DIRTY_BAND       = 1 << 0,
+  DIRTY_POWER      = 1 << 1,
+  DIRTY_TEMP       = 1 << 2,
+  DIRTY_SWR        = 1 << 3,
+  DIRTY_ANTENNA    = 1 << 4,
+  DIRTY_MODE       = 1 << 5,
+  DIRTY_FAULTS     = 1 << 6,
+  DIRTY_VOLTAGE    = 1 << 7,
+  DIRTY_CONNECTION = 1 << 8,
+  DIRTY_ALL        = 0x01FF
+};
+
+// Dirty bits for every field that differs between two snapshots
+inline uint32_t diffTelemetry(const Telemetry& a, const Telemetry& b) {
+  uint32_t mask = 0;
+  if (a.bandIndex != b.bandIndex) mask |= DIRTY_BAND;
+  if (a.powerX10 != b.powerX10) mask |= DIRTY_POWER;
+  if (a.tempX10 != b.tempX10) mask |= DIRTY_TEMP;
+  if (a.swrX10 != b.swrX10) mask |= DIRTY_SWR;
+  if (a.antenna != b.antenna) mask |= DIRTY_ANTENNA;
+  if (a.mode != b.mode) mask |= DIRTY_MODE;
+  if (strcmp(a.faults, b.faults) != 0) mask |= DIRTY_FAULTS;
+  if (a.voltageMv != b.voltageMv) mask |= DIRTY_VOLTAGE;
+  if (a.kxpaConnected != b.kxpaConnected || a.catConnected != b.catConnected) {
+    mask |= DIRTY_CONNECTION;
+  }
+  return mask;
+}
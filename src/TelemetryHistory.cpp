@@ -0,0 +1,242 @@
+#include "TelemetryHistory.h"
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Rollup Configuration
+//-----------------------------------------------------------------------------
+
+// Level 0 buckets span 1 s, every further level folds this many of the one below
+const uint8_t TelemetryHistory::ROLLUP[LEVEL_COUNT] = { 1, 10, 6 };
+
+static const uint32_t BASE_PERIOD_MS = 1000;
+
+// Beyond this gap the history is stale anyway, start over instead of
+// closing thousands of empty buckets
+static const uint32_t MAX_GAP_MS = 60UL * 60UL * 1000UL;
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+TelemetryHistory::TelemetryHistory()
+  : _seq(0)
+{
+  clear();
+}
+
+//-----------------------------------------------------------------------------
+// Writer Side
+//-----------------------------------------------------------------------------
+
+void TelemetryHistory::clear() {
+  beginWrite();
+  for (uint8_t c = 0; c < CHANNEL_COUNT; ++c) {
+    ChannelHistory& h = _channels[c];
+    h.rawHead = 0;
+    h.rawFilled = 0;
+    h.openStart = 0;
+    h.started = false;
+    for (uint8_t l = 0; l < LEVEL_COUNT; ++l) {
+      h.levels[l].head = 0;
+      h.levels[l].filled = 0;
+      h.levels[l].children = 0;
+      resetBucket(h.levels[l].open);
+    }
+  }
+  endWrite();
+}
+
+void TelemetryHistory::append(Channel ch, int16_t value, uint32_t now) {
+  if (ch >= CHANNEL_COUNT || value == KXPA100Controller::INVALID_VALUE) {
+    return;
+  }
+  ChannelHistory& h = _channels[ch];
+
+  beginWrite();
+  advance(h, now);
+
+  h.raw[h.rawHead].at = now;
+  h.raw[h.rawHead].value = value;
+  h.rawHead = (h.rawHead + 1) % RAW_LEN;
+  if (h.rawFilled < RAW_LEN) h.rawFilled++;
+
+  Bucket& open = h.levels[LEVEL_1S].open;
+  if (open.count == 0 || value < open.min) open.min = value;
+  if (open.count == 0 || value > open.max) open.max = value;
+  open.sum += value;
+  open.count++;
+  endWrite();
+}
+
+// Feed the answered fields of one poll (bit 1 << PollParam in answeredMask)
+void TelemetryHistory::appendStatus(const KXPA100Controller::StatusSnapshot& status,
+                                    uint16_t answeredMask, uint32_t now) {
+  if (answeredMask & (1 << KXPA100Controller::PARAM_POWER)) append(CH_POWER, status.powerX10, now);
+  if (answeredMask & (1 << KXPA100Controller::PARAM_SWR)) append(CH_SWR, status.swrX10, now);
+  if (answeredMask & (1 << KXPA100Controller::PARAM_TEMP)) append(CH_TEMP, status.tempX10, now);
+  if (answeredMask & (1 << KXPA100Controller::PARAM_VOLTAGE)) append(CH_VOLTAGE, status.voltageMv, now);
+}
+
+//-----------------------------------------------------------------------------
+// Reader Side
+//-----------------------------------------------------------------------------
+
+bool TelemetryHistory::sample(Channel ch, uint8_t age, Sample& out) const {
+  if (ch >= CHANNEL_COUNT) return false;
+  const ChannelHistory& h = _channels[ch];
+
+  uint32_t seq;
+  bool found;
+  do {
+    seq = _seq.load(std::memory_order_acquire);
+    found = !(seq & 1) && age < h.rawFilled;
+    if (found) {
+      out = h.raw[(h.rawHead + RAW_LEN - 1 - age) % RAW_LEN];
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != _seq.load(std::memory_order_relaxed));
+  return found;
+}
+
+bool TelemetryHistory::bucket(Channel ch, Level level, uint8_t age, Stats& out) const {
+  if (ch >= CHANNEL_COUNT || level >= LEVEL_COUNT) return false;
+  const Ring& r = _channels[ch].levels[level];
+
+  uint32_t seq;
+  Bucket b;
+  do {
+    seq = _seq.load(std::memory_order_acquire);
+    if (age < r.filled) {
+      b = r.buckets[(r.head + BUCKETS - 1 - age) % BUCKETS];
+    } else {
+      resetBucket(b);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != _seq.load(std::memory_order_relaxed));
+
+  toStats(b, b.sum, out);
+  return b.count > 0;
+}
+
+// Merge the last n completed buckets of one level, e.g. 5 × LEVEL_1MIN; O(n)
+bool TelemetryHistory::window(Channel ch, Level level, uint8_t buckets, Stats& out) const {
+  if (ch >= CHANNEL_COUNT || level >= LEVEL_COUNT || buckets == 0) return false;
+  const Ring& r = _channels[ch].levels[level];
+
+  // The merged sum can pass 32 bits (an hour of mV at 1 ms), min/max/count
+  // are merged like mergeBucket() does
+  uint32_t seq;
+  Bucket acc;
+  int64_t sum;
+  do {
+    seq = _seq.load(std::memory_order_acquire);
+    resetBucket(acc);
+    sum = 0;
+    uint8_t n = min(buckets, r.filled);
+    for (uint8_t i = 0; i < n; ++i) {
+      const Bucket& b = r.buckets[(r.head + BUCKETS - 1 - i) % BUCKETS];
+      if (b.count == 0) continue;
+      if (acc.count == 0 || b.min < acc.min) acc.min = b.min;
+      if (acc.count == 0 || b.max > acc.max) acc.max = b.max;
+      acc.count += b.count;
+      sum += b.sum;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || seq != _seq.load(std::memory_order_relaxed));
+
+  toStats(acc, sum, out);
+  return acc.count > 0;
+}
+
+uint32_t TelemetryHistory::periodMs(Level level) {
+  uint32_t period = BASE_PERIOD_MS;
+  for (uint8_t l = 1; l <= level && l < LEVEL_COUNT; ++l) {
+    period *= ROLLUP[l];
+  }
+  return period;
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+// Close every 1 s bucket that ended before now, cascading into the upper levels
+void TelemetryHistory::advance(ChannelHistory& h, uint32_t now) {
+  if (!h.started || now - h.openStart >= MAX_GAP_MS) {
+    for (uint8_t l = 0; l < LEVEL_COUNT; ++l) {
+      h.levels[l].head = 0;
+      h.levels[l].filled = 0;
+      h.levels[l].children = 0;
+      resetBucket(h.levels[l].open);
+    }
+    h.openStart = now - now % BASE_PERIOD_MS;
+    h.started = true;
+
+    // Align the upper levels to whole 10 s / 1 min periods of millis()
+    uint32_t index = h.openStart / BASE_PERIOD_MS;
+    for (uint8_t l = 1; l < LEVEL_COUNT; ++l) {
+      h.levels[l].children = index % ROLLUP[l];
+      index /= ROLLUP[l];
+    }
+    return;
+  }
+
+  while (now - h.openStart >= BASE_PERIOD_MS) {
+    closeBucket(h, LEVEL_1S);
+    h.openStart += BASE_PERIOD_MS;
+  }
+}
+
+void TelemetryHistory::closeBucket(ChannelHistory& h, uint8_t level) {
+  Ring& r = h.levels[level];
+  r.buckets[r.head] = r.open;
+  r.head = (r.head + 1) % BUCKETS;
+  if (r.filled < BUCKETS) r.filled++;
+
+  if (level + 1 < LEVEL_COUNT) {
+    Ring& up = h.levels[level + 1];
+    mergeBucket(up.open, r.open);
+    if (++up.children >= ROLLUP[level + 1]) {
+      closeBucket(h, level + 1);
+      up.children = 0;
+    }
+  }
+  resetBucket(r.open);
+}
+
+void TelemetryHistory::resetBucket(Bucket& b) {
+  b.min = 0;
+  b.max = 0;
+  b.sum = 0;
+  b.count = 0;
+}
+
+void TelemetryHistory::mergeBucket(Bucket& into, const Bucket& from) {
+  if (from.count == 0) return;
+  if (into.count == 0 || from.min < into.min) into.min = from.min;
+  if (into.count == 0 || from.max > into.max) into.max = from.max;
+  into.sum += from.sum;
+  into.count += from.count;
+}
+
+void TelemetryHistory::toStats(const Bucket& b, int64_t sum, Stats& out) {
+  out.min = b.min;
+  out.max = b.max;
+  out.count = b.count;
+  if (b.count == 0) {
+    out.avg = 0;
+    return;
+  }
+  // Round half away from zero, like formatFixed()
+  int64_t half = b.count / 2;
+  out.avg = (int16_t)((sum >= 0 ? sum + half : sum - half) / (int64_t)b.count);
+}
+
+void TelemetryHistory::beginWrite() {
+  _seq.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void TelemetryHistory::endWrite() {
+  _seq.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,109 @@
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "KXPA100Controller.h"
+
+// Recent history of the polled fixed-point values, in a static arena.
+//
+// Every channel keeps its last RAW_LEN raw samples plus three rollup levels
+// (1 s, 10 s, 1 min) of BUCKETS min/max/sum/count buckets each. A sample is
+// folded into the open 1 s bucket, closed buckets cascade upwards, so append
+// is O(1) and the last completed bucket of a level (bucket()) is the 1 s /
+// 10 s / 1 min window, also O(1). window() merges n whole buckets of one
+// level, O(n). Buckets are aligned to whole periods of millis(), not to the
+// wall clock (there is none).
+//
+// One writer (the backend task); readers on other tasks get consistent
+// copies through a sequence counter and never block the writer. A reader
+// must not preempt the writer on its own core, it would spin until the
+// writer runs again.
+class TelemetryHistory {
+public:
+  enum Channel : uint8_t {
+    CH_POWER = 0,      // W × 10
+    CH_SWR,            // SWR × 10
+    CH_TEMP,           // °C × 10
+    CH_VOLTAGE,        // mV
+    CHANNEL_COUNT
+  };
+
+  enum Level : uint8_t {
+    LEVEL_1S = 0,
+    LEVEL_10S,
+    LEVEL_1MIN,
+    LEVEL_COUNT
+  };
+
+  static const uint8_t RAW_LEN = 64;
+  static const uint8_t BUCKETS = 60;
+
+  struct Sample {
+    uint32_t at;       // millis()
+    int16_t value;
+  };
+
+  struct Stats {
+    int16_t min;
+    int16_t max;
+    int16_t avg;
+    uint32_t count;    // samples aggregated, 0 = no data in this window
+  };
+
+  TelemetryHistory();
+
+  // Writer side
+  void append(Channel ch, int16_t value, uint32_t now);
+  void appendStatus(const KXPA100Controller::StatusSnapshot& status, uint16_t answeredMask, uint32_t now);
+  void clear();
+
+  // Reader side, age 0 = newest sample / last completed bucket
+  bool sample(Channel ch, uint8_t age, Sample& out) const;
+  bool bucket(Channel ch, Level level, uint8_t age, Stats& out) const;
+  bool window(Channel ch, Level level, uint8_t buckets, Stats& out) const;
+
+  static uint32_t periodMs(Level level);
+
+private:
+  struct Bucket {
+    int16_t min;
+    int16_t max;
+    int32_t sum;               // one bucket: <= 60 s of samples, fits
+    uint32_t count;            // a 1 ms poll fills 60000 per minute
+  };
+
+  struct Ring {
+    Bucket buckets[BUCKETS];
+    uint8_t head;              // next slot to write
+    uint8_t filled;
+    Bucket open;               // still accumulating
+    uint8_t children;          // closed lower-level buckets folded into open
+  };
+
+  struct ChannelHistory {
+    Sample raw[RAW_LEN];
+    uint8_t rawHead;
+    uint8_t rawFilled;
+    uint32_t openStart;        // start of the open 1 s bucket
+    bool started;
+    Ring levels[LEVEL_COUNT];
+  };
+
+  void advance(ChannelHistory& h, uint32_t now);
+  void closeBucket(ChannelHistory& h, uint8_t level);
+
+  static void resetBucket(Bucket& b);
+  static void mergeBucket(Bucket& into, const Bucket& from);
+  static void toStats(const Bucket& b, int64_t sum, Stats& out);
+
+  void beginWrite();
+  void endWrite();
+
+  ChannelHistory _channels[CHANNEL_COUNT];
+  std::atomic<uint32_t> _seq;
+
+  static const uint8_t ROLLUP[LEVEL_COUNT];   // children per bucket
+};
+
+#endif // TELEMETRYHISTORY_H
@@ -0,0 +1,221 @@
+#include "TelemetryPublisher.h"
+#include "BandPlan.h"
+
+static_assert(sizeof(TelemetryPublisher::Datagram) == 34, "datagram layout is part of the protocol");
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+TelemetryPublisher::TelemetryPublisher(DatagramSocket& socket, const char* host, uint16_t port,
+                                       uint8_t formats, unsigned long minIntervalMs,
+                                       unsigned long heartbeatMs)
+  : _socket(socket)
+  , _host(host)
+  , _port(port)
+  , _formats(formats)
+  , _minIntervalMs(minIntervalMs)
+  , _heartbeatMs(heartbeatMs)
+  , _linkUp(false)
+  , _deferring(false)
+  , _deferredAt(0)
+  , _sent(0)
+  , _coalesced(0)
+  , _failed(0)
+{
+  for (uint8_t i = 0; i < STATION_MAX; ++i) {
+    _slots[i].pending = 0;
+    _slots[i].sequence = 0;
+    _slots[i].lastSentAt = 0;
+    _slots[i].valid = false;
+    _slots[i].everSent = false;
+  }
+  memset(&_datagram, 0, sizeof(_datagram));
+  _json[0] = '\0';
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void TelemetryPublisher::offer(uint8_t station, const Telemetry& t, uint32_t changed) {
+  if (station >= STATION_MAX) return;
+
+  Slot& slot = _slots[station];
+  if (!slot.valid) {
+    slot.valid = true;
+    changed = DIRTY_ALL;    // the receiver has not seen this station yet
+  }
+  if (changed == 0) {
+    slot.latest = t;        // a command ack alone is not worth a datagram
+    return;
+  }
+
+  // Only the newest values go out, the changed bits accumulate
+  if (slot.pending != 0) {
+    _coalesced++;
+  }
+  slot.latest = t;
+  slot.pending |= changed;
+}
+
+void TelemetryPublisher::update(unsigned long now, bool linkUp, bool linkBusy) {
+  _linkUp = linkUp;
+  if (!linkUp) {
+    // Changes wait for the link, the next datagram carries all of them
+    _deferring = false;
+    return;
+  }
+
+  bool anyDue = false;
+  for (uint8_t i = 0; i < STATION_MAX; ++i) {
+    anyDue = anyDue || due(_slots[i], now);
+  }
+  if (!anyDue) {
+    _deferring = false;
+    return;
+  }
+
+  // Let a CAT reply through first, but don't starve the export
+  if (linkBusy) {
+    if (!_deferring) {
+      _deferring = true;
+      _deferredAt = now;
+    }
+    if (now - _deferredAt < BUSY_DEFER_MAX_MS) return;
+  }
+  _deferring = false;
+
+  for (uint8_t i = 0; i < STATION_MAX; ++i) {
+    if (due(_slots[i], now)) {
+      sendSlot(i, _slots[i], now);
+    }
+  }
+}
+
+unsigned long TelemetryPublisher::msUntilWork(unsigned long now) const {
+  if (!_linkUp) return ULONG_MAX;   // the WiFi events wake the backend
+
+  unsigned long wait = ULONG_MAX;
+  for (uint8_t i = 0; i < STATION_MAX; ++i) {
+    const Slot& slot = _slots[i];
+    if (!slot.valid) continue;
+
+    unsigned long interval = slot.pending != 0 ? _minIntervalMs : _heartbeatMs;
+    unsigned long elapsed = now - slot.lastSentAt;
+    if (!slot.everSent || elapsed >= interval) {
+      wait = 0;
+      break;
+    }
+    wait = min(wait, interval - elapsed);
+  }
+
+  // Held back for a CAT reply: its arrival wakes the backend anyway
+  if (wait == 0 && _deferring) {
+    unsigned long held = now - _deferredAt;
+    wait = held >= BUSY_DEFER_MAX_MS ? 0 : BUSY_DEFER_MAX_MS - held;
+  }
+  return wait;
+}
+
+//-----------------------------------------------------------------------------
+// Encoders
+//-----------------------------------------------------------------------------
+
+void TelemetryPublisher::encodeBinary(uint8_t station, uint32_t sequence, uint32_t uptimeMs,
+                                      uint32_t changed, const Telemetry& t, Datagram& out) {
+  out.magic[0] = 'K';
+  out.magic[1] = 'X';
+  out.version = VERSION;
+  out.station = station;
+  out.sequence = sequence;
+  out.uptimeMs = uptimeMs;
+  out.changed = (uint16_t)changed;
+  out.flags = (t.kxpaConnected ? FLAG_KXPA_CONNECTED : 0) |
+              (t.catConnected ? FLAG_CAT_CONNECTED : 0) |
+              (changed == 0 ? FLAG_HEARTBEAT : 0);
+  out.bandIndex = t.bandIndex;
+  out.powerX10 = t.powerX10;
+  out.swrX10 = t.swrX10;
+  out.tempX10 = t.tempX10;
+  out.voltageMv = (uint16_t)t.voltageMv;
+  out.antenna = t.antenna;
+  out.mode = t.mode;
+  memset(out.faults, 0, sizeof(out.faults));
+  strncpy(out.faults, t.faults, sizeof(out.faults) - 1);
+}
+
+// "-1.5" from -15 and 10; decimals follow the scale
+static void formatScaled(char* out, size_t len, int32_t value, int32_t scale, uint8_t decimals) {
+  int32_t whole = value / scale;
+  int32_t frac = value % scale;
+  if (frac < 0) frac = -frac;
+  snprintf(out, len, "%s%ld.%0*ld", value < 0 && whole == 0 ? "-" : "", (long)whole,
+           (int)decimals, (long)frac);
+}
+
+size_t TelemetryPublisher::encodeJson(const Datagram& d, char* out, size_t len) {
+  char power[8], swr[8], temp[8], volt[8];
+  formatScaled(power, sizeof(power), d.powerX10, 10, 1);
+  formatScaled(swr, sizeof(swr), d.swrX10, 10, 1);
+  formatScaled(temp, sizeof(temp), d.tempX10, 10, 1);
+  formatScaled(volt, sizeof(volt), d.voltageMv, 1000, 3);
+
+  // Fault codes are the amp's raw text, keep only what needs no escaping
+  char faults[sizeof(d.faults)];
+  size_t n = 0;
+  for (size_t i = 0; i < sizeof(d.faults) && d.faults[i] != '\0'; ++i) {
+    char c = d.faults[i];
+    if (c >= ' ' && c <= '~' && c != '"' && c != '\\') faults[n++] = c;
+  }
+  faults[n] = '\0';
+
+  const char* band = d.bandIndex >= 0 && d.bandIndex < (int)BandPlan::BAND_COUNT
+                     ? BandPlan::BANDS[d.bandIndex].name : "";
+
+  int written = snprintf(out, len,
+      "{\"station\":%u,\"seq\":%lu,\"uptime\":%lu,\"changed\":%u,\"heartbeat\":%s,"
+      "\"kxpa\":%s,\"cat\":%s,\"band\":\"%s\",\"power\":%s,\"swr\":%s,\"temp\":%s,"
+      "\"voltage\":%s,\"antenna\":%d,\"mode\":%d,\"faults\":\"%s\"}",
+      (unsigned)d.station, (unsigned long)d.sequence, (unsigned long)d.uptimeMs,
+      (unsigned)d.changed, (d.flags & FLAG_HEARTBEAT) ? "true" : "false",
+      (d.flags & FLAG_KXPA_CONNECTED) ? "true" : "false",
+      (d.flags & FLAG_CAT_CONNECTED) ? "true" : "false",
+      band, power, swr, temp, volt, (int)d.antenna, (int)d.mode, faults);
+  if (written < 0 || (size_t)written >= len) return 0;
+  return (size_t)written;
+}
+
+//-----------------------------------------------------------------------------
+// Private Methods
+//-----------------------------------------------------------------------------
+
+bool TelemetryPublisher::due(const Slot& slot, unsigned long now) const {
+  if (!slot.valid) return false;
+  if (!slot.everSent) return true;
+  unsigned long elapsed = now - slot.lastSentAt;
+  return slot.pending != 0 ? elapsed >= _minIntervalMs : elapsed >= _heartbeatMs;
+}
+
+void TelemetryPublisher::sendSlot(uint8_t station, Slot& slot, unsigned long now) {
+  encodeBinary(station, ++slot.sequence, now, slot.pending, slot.latest, _datagram);
+  slot.pending = 0;
+  slot.lastSentAt = now;
+  slot.everSent = true;
+
+  bool ok = true;
+  if (_formats & FORMAT_BINARY) {
+    ok = _socket.send(_host, _port, (const uint8_t*)&_datagram, sizeof(_datagram)) && ok;
+  }
+  if (_formats & FORMAT_JSON) {
+    size_t len = encodeJson(_datagram, _json, sizeof(_json));
+    ok = len > 0 && _socket.send(_host, _port + 1, (const uint8_t*)_json, len) && ok;
+  }
+
+  // A lost datagram is not repeated, the next one carries the full state
+  if (ok) {
+    _sent++;
+  } else {
+    _failed++;
+  }
+}
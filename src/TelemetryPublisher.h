@@ -0,0 +1,118 @@
+#ifndef TELEMETRYPUBLISHER_H
+#define TELEMETRYPUBLISHER_H
+
+#include <Arduino.h>
+#include <limits.h>
+#include "Telemetry.h"
+#include "DatagramSocket.h"
+
+// Pushes station telemetry to the LAN as UDP datagrams.
+//
+// Change-driven: the backend offers every snapshot it publishes, changes are
+// coalesced per station and sent at most once per minimum interval, with a
+// heartbeat while nothing changes. A send is held back while a CAT query is
+// in flight on the same WiFi link (for at most BUSY_DEFER_MAX_MS), so the
+// export never delays a frequency reply. The datagrams are encoded in place,
+// nothing is allocated per message.
+//
+// Binary datagram (Datagram below), version 1, little endian, 34 bytes:
+//   0  char[2]  magic "KX"            16  int16    power W × 10
+//   2  uint8    version               18  int16    SWR × 10
+//   3  uint8    station (0 = A)       20  int16    temperature °C × 10
+//   4  uint32   sequence per station  22  uint16   voltage mV
+//   8  uint32   uptime ms             24  int8     antenna (0 = unknown)
+//  12  uint16   changed (DIRTY_*)     25  int8     mode (-1 = unknown)
+//  14  uint8    flags (FLAG_*)        26  char[8]  fault code, NUL padded
+//  15  int8     band index (-1 = unknown)
+//
+// FORMAT_JSON sends the same content as one JSON object to port + 1.
+class TelemetryPublisher {
+public:
+  static const uint8_t STATION_MAX = 2;
+  static const uint8_t VERSION = 1;
+  static const unsigned long BUSY_DEFER_MAX_MS = 20;
+  static const size_t JSON_MAX = 192;
+
+  enum Format : uint8_t {
+    FORMAT_BINARY = 1 << 0,
+    FORMAT_JSON   = 1 << 1
+  };
+
+  enum Flag : uint8_t {
+    FLAG_KXPA_CONNECTED = 1 << 0,
+    FLAG_CAT_CONNECTED  = 1 << 1,
+    FLAG_HEARTBEAT      = 1 << 2    // nothing changed since the last datagram
+  };
+
+  struct __attribute__((packed)) Datagram {
+    char magic[2];
+    uint8_t version;
+    uint8_t station;
+    uint32_t sequence;
+    uint32_t uptimeMs;
+    uint16_t changed;
+    uint8_t flags;
+    int8_t bandIndex;
+    int16_t powerX10;
+    int16_t swrX10;
+    int16_t tempX10;
+    uint16_t voltageMv;
+    int8_t antenna;
+    int8_t mode;
+    char faults[KXPA100Controller::FAULTS_MAX];
+  };
+
+  TelemetryPublisher(DatagramSocket& socket, const char* host, uint16_t port, uint8_t formats,
+                     unsigned long minIntervalMs, unsigned long heartbeatMs);
+
+  // Latest snapshot of a station and what changed in it
+  void offer(uint8_t station, const Telemetry& t, uint32_t changed);
+
+  // Send what is due; linkBusy = a CAT query is waiting for its reply
+  void update(unsigned long now, bool linkUp, bool linkBusy);
+
+  // How long update() may be left alone, ULONG_MAX = nothing to send
+  unsigned long msUntilWork(unsigned long now) const;
+
+  uint32_t sent() const { return _sent; }
+  uint32_t coalesced() const { return _coalesced; }
+  uint32_t failed() const { return _failed; }
+
+  // Encoders, public for the receiver side of the tests
+  static void encodeBinary(uint8_t station, uint32_t sequence, uint32_t uptimeMs,
+                           uint32_t changed, const Telemetry& t, Datagram& out);
+  static size_t encodeJson(const Datagram& d, char* out, size_t len);
+
+private:
+  struct Slot {
+    Telemetry latest;
+    uint32_t pending;      // DIRTY_* bits not sent yet
+    uint32_t sequence;
+    unsigned long lastSentAt;
+    bool valid;
+    bool everSent;
+  };
+
+  bool due(const Slot& slot, unsigned long now) const;
+  void sendSlot(uint8_t station, Slot& slot, unsigned long now);
+
+  DatagramSocket& _socket;
+  const char* _host;
+  uint16_t _port;
+  uint8_t _formats;
+  unsigned long _minIntervalMs;
+  unsigned long _heartbeatMs;
+  bool _linkUp;
+  bool _deferring;
+  unsigned long _deferredAt;
+
+  Slot _slots[STATION_MAX];
+  Datagram _datagram;
+  char _json[JSON_MAX];
+
+  uint32_t _sent;
+  uint32_t _coalesced;
+  uint32_t _failed;
+};
+
+#endif // TELEMETRYPUBLISHER_H
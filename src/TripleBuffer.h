@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+// Wait-free single-writer / single-reader snapshot exchange.
+//
+// The writer always owns one buffer, the reader another, and the third sits
+// in between. publish() swaps the writer's buffer into the middle, update()
+// swaps the middle into the reader's hands if it is newer. Neither side ever
+// blocks or retries, and the reader can never see a half-written value.
+template <typename T>
+class TripleBuffer {
+public:
+  TripleBuffer() : _back(0), _middle(1), _front(2) {}
+
+  // Writer side (one task only)
+  void publish(const T& value) {
+    _buf[_back] = value;
+    uint8_t prev = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+    _back = prev & INDEX_MASK;
+  }
+
+  // Reader side (one task only); returns true if a newer value was picked up
+  bool update() {
+    if (!(_middle.load(std::memory_order_relaxed) & FRESH)) {
+      return false;
+    }
+    uint8_t prev = _middle.exchange(_front, std::memory_order_acq_rel);
+    _front = prev & INDEX_MASK;
+    return true;
+  }
+
+  // Stays stable until the reader calls update() again
+  const T& front() const { return _buf[_front]; }
+
+private:
+  static const uint8_t INDEX_MASK = 0x03;
+  static const uint8_t FRESH = 0x04;
+
+  T _buf[3];
+  uint8_t _back;
+  std::atomic<uint8_t> _middle;
+  uint8_t _front;
+};
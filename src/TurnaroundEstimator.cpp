@@ -0,0 +1,53 @@
+#include "TurnaroundEstimator.h"
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+TurnaroundEstimator::TurnaroundEstimator()
+  : _meanUs(0)
+  , _devUs(0)
+  , _minTimeoutUs(0)
+  , _maxTimeoutUs(0)
+  , _samples(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void TurnaroundEstimator::seed(uint32_t expectedUs, uint32_t minTimeoutUs, uint32_t maxTimeoutUs) {
+  _meanUs = expectedUs;
+  _minTimeoutUs = minTimeoutUs;
+  _maxTimeoutUs = maxTimeoutUs;
+  _samples = 0;
+
+  // Wide enough that the first timeouts sit at the ceiling
+  _devUs = maxTimeoutUs / 4;
+}
+
+void TurnaroundEstimator::sample(uint32_t us) {
+  if (_samples == 0) {
+    // The first measurement replaces the prior
+    _meanUs = us;
+    _devUs = max(us / 2, _devUs / 2);
+  } else {
+    int32_t err = (int32_t)us - (int32_t)_meanUs;
+    uint32_t absErr = err < 0 ? (uint32_t)-err : (uint32_t)err;
+    _meanUs = (uint32_t)((int32_t)_meanUs + err / 8);
+    _devUs = (uint32_t)((int32_t)_devUs + ((int32_t)absErr - (int32_t)_devUs) / 4);
+  }
+  _samples++;
+}
+
+void TurnaroundEstimator::timedOut() {
+  _devUs = min(_devUs * 2 + 1000, _maxTimeoutUs);
+}
+
+uint32_t TurnaroundEstimator::timeoutUs() const {
+  uint32_t t = _meanUs + 4 * _devUs;
+  if (t < _minTimeoutUs) t = _minTimeoutUs;
+  if (t > _maxTimeoutUs) t = _maxTimeoutUs;
+  return t;
+}
@@ -0,0 +1,35 @@
+#ifndef TURNAROUNDESTIMATOR_H
+#define TURNAROUNDESTIMATOR_H
+
+#include <Arduino.h>
+
+// Learns how long the amplifier takes to answer one kind of command.
+//
+// Smoothed mean and mean deviation of the measured turnaround (EWMA with
+// gains 1/8 and 1/4, as in TCP's RTT estimator). The timeout is the mean
+// plus four deviations, clamped to a floor and a ceiling. It starts at the
+// ceiling and comes down as samples arrive. A timeout doubles the deviation,
+// so a slower amp is learned within a few misses instead of losing replies.
+class TurnaroundEstimator {
+public:
+  TurnaroundEstimator();
+
+  void seed(uint32_t expectedUs, uint32_t minTimeoutUs, uint32_t maxTimeoutUs);
+  void sample(uint32_t us);
+  void timedOut();
+
+  uint32_t expectedUs() const { return _meanUs; }
+  uint32_t deviationUs() const { return _devUs; }
+  uint32_t timeoutUs() const;
+  uint16_t timeoutMs() const { return (uint16_t)((timeoutUs() + 999) / 1000); }
+  uint32_t samples() const { return _samples; }
+
+private:
+  uint32_t _meanUs;
+  uint32_t _devUs;
+  uint32_t _minTimeoutUs;
+  uint32_t _maxTimeoutUs;
+  uint32_t _samples;
+};
+
+#endif // TURNAROUNDESTIMATOR_H
@@ -0,0 +1,67 @@
+#pragma once
+#include <M5Unified.h>
+#include <string.h>
+#include "DmaPusher.h"
+#include "UiPalette.h"
+#include "LatencyStats.h"
+
+// One value on screen, rendered in its own small canvas.
+//
+// draw() only touches the display when the text or colour differs from what
+// is already shown, and then pushes just this box instead of a whole panel
+// (by DMA if a DmaPusher is given).
+class UiField {
+public:
+  static const uint8_t TEXT_MAX = 24;
+
+  UiField(LovyanGFX* lcd, int16_t x, int16_t y, int16_t w, int16_t h, const lgfx::IFont* font)
+      : _canvas(lcd), _x(x), _y(y), _w(w), _h(h), _font(font),
+        _dma(NULL), _background(UI_WHITE), _color(UI_WHITE), _valid(false) {
+    _text[0] = '\0';
+  }
+
+  void begin(UiColor background, DmaPusher* dma = NULL) {
+    _background = background;
+    _dma = dma;
+    createUiCanvas(_canvas, _w, _h);
+    _canvas.setFont(_font);
+  }
+
+  // Returns true if the box was redrawn
+  bool draw(const char* text, UiColor color) {
+    if (_valid && color == _color && strncmp(text, _text, TEXT_MAX) == 0) {
+      return false;
+    }
+    strncpy(_text, text, TEXT_MAX - 1);
+    _text[TEXT_MAX - 1] = '\0';
+    _color = color;
+    _valid = true;
+    LatencyStats::Scope timing(LatencyStats::T_RENDER_FIELD);
+
+    if (_dma != NULL) {
+      _dma->reclaim(_canvas);
+    }
+    _canvas.fillSprite(_background);
+    _canvas.setTextColor(color);
+    _canvas.drawString(_text, 0, 0);
+    if (_dma != NULL) {
+      _dma->push(_canvas, _x, _y);
+    } else {
+      _canvas.pushSprite(_x, _y);
+    }
+    return true;
+  }
+
+  // Forget what is on screen, the next draw() always pushes
+  void invalidate() { _valid = false; }
+
+private:
+  M5Canvas _canvas;
+  int16_t _x, _y, _w, _h;
+  const lgfx::IFont* _font;
+  DmaPusher* _dma;
+  UiColor _background;
+  UiColor _color;
+  bool _valid;
+  char _text[TEXT_MAX];
+};
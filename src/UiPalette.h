@@ -0,0 +1,33 @@
+#pragma once
+#include <M5Unified.h>
+
+// Colours of the UI canvases. The canvases are 4 bpp with a palette, so
+// drawing into them takes one of these indices instead of an RGB565 value.
+enum UiColor : uint8_t {
+  UI_WHITE = 0,
+  UI_DARKGREY,
+  UI_RED,
+  UI_BLUE,
+  UI_DARKGREEN,
+  UI_ORANGE,
+  UI_COLOR_COUNT
+};
+
+static const uint8_t UI_COLOR_DEPTH = 4;
+
+// Allocate a palette canvas and load the UI colours into it
+inline bool createUiCanvas(M5Canvas& canvas, int16_t w, int16_t h) {
+  static const uint16_t rgb565[UI_COLOR_COUNT] = {
+    WHITE, DARKGREY, RED, BLUE, DARKGREEN, ORANGE
+  };
+
+  canvas.setColorDepth(UI_COLOR_DEPTH);
+  if (canvas.createSprite((w + 1) & ~1, h) == NULL) {   // 4 bpp rows are whole bytes
+    Serial.println("Canvas allocation failed");
+    return false;
+  }
+  for (uint8_t i = 0; i < UI_COLOR_COUNT; ++i) {
+    canvas.setPaletteColor(i, rgb565[i]);
+  }
+  return true;
+}
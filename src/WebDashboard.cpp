@@ -0,0 +1,444 @@
+#include "WebDashboard.h"
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/version.h>
+#include "BandPlan.h"
+#include "DashboardPage.h"
+
+// WebSocket opcodes (RFC 6455)
+static const uint8_t WS_TEXT   = 0x1;
+static const uint8_t WS_BINARY = 0x2;
+static const uint8_t WS_CLOSE  = 0x8;
+static const uint8_t WS_PING   = 0x9;
+static const uint8_t WS_PONG   = 0xA;
+
+static const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+//-----------------------------------------------------------------------------
+// Constructor
+//-----------------------------------------------------------------------------
+
+WebDashboard::WebDashboard(uint16_t port)
+  : _server(port)
+  , _taskHandle(NULL)
+  , _notifyTask(NULL)
+  , _notifyBits(0)
+  , _stationCount(0)
+{
+  for (uint8_t i = 0; i < STATION_MAX; ++i) {
+    _labels[i] = "";
+    _telemetry[i] = NULL;
+  }
+  for (uint8_t i = 0; i < CLIENTS_MAX; ++i) {
+    _clients[i].open = false;
+    _clients[i].rxLen = 0;
+  }
+  _request[0] = '\0';
+}
+
+//-----------------------------------------------------------------------------
+// Public Methods
+//-----------------------------------------------------------------------------
+
+void WebDashboard::attach(uint8_t station, const char* label, TripleBuffer<Telemetry>& telemetry) {
+  if (station >= STATION_MAX) return;
+  _labels[station] = label;
+  _telemetry[station] = &telemetry;
+  if (station >= _stationCount) {
+    _stationCount = station + 1;
+  }
+}
+
+bool WebDashboard::begin(TaskHandle_t notifyTask, uint32_t notifyBits) {
+  _notifyTask = notifyTask;
+  _notifyBits = notifyBits;
+
+  // lwIP accepts the listening socket before the station has an address
+  _server.begin();
+  _server.setNoDelay(true);
+
+  BaseType_t created = xTaskCreatePinnedToCore(
+    taskEntry,     // Function
+    "WebTask",     // Name
+    TASK_STACK,    // Stack size
+    this,          // Params
+    0,             // Priority (below the backend)
+    &_taskHandle,  // Handle (for telemetry notifications)
+    0              // Core ID (0)
+  );
+  if (created != pdPASS) {
+    Serial.println("Dashboard: failed to create web task");
+    return false;
+  }
+  return true;
+}
+
+void WebDashboard::notify() {
+  if (_taskHandle != NULL) {
+    xTaskNotifyGive(_taskHandle);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Task
+//-----------------------------------------------------------------------------
+
+void WebDashboard::taskEntry(void* arg) {
+  static_cast<WebDashboard*>(arg)->run();
+}
+
+void WebDashboard::run() {
+  while (true) {
+    bool anyOpen = false;
+    for (uint8_t i = 0; i < CLIENTS_MAX; ++i) {
+      anyOpen = anyOpen || _clients[i].open;
+    }
+
+    // New telemetry wakes us at once, socket reads wait for the poll period
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(anyOpen ? POLL_MS : IDLE_POLL_MS));
+
+    if (WiFi.status() != WL_CONNECTED) {
+      for (uint8_t i = 0; i < CLIENTS_MAX; ++i) {
+        closeClient(_clients[i]);
+      }
+      continue;
+    }
+
+    acceptClient();
+
+    for (uint8_t s = 0; s < _stationCount; ++s) {
+      if (_telemetry[s] != NULL) {
+        _telemetry[s]->update();
+      }
+    }
+
+    for (uint8_t i = 0; i < CLIENTS_MAX; ++i) {
+      Client& c = _clients[i];
+      if (!c.open) continue;
+      serviceClient(c);
+      if (c.open) {
+        pushTelemetry(c);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// HTTP
+//-----------------------------------------------------------------------------
+
+void WebDashboard::acceptClient() {
+  WiFiClient http = _server.available();
+  if (!http) return;
+
+  if (readRequest(http)) {
+    handleRequest(http);
+  } else {
+    http.stop();
+  }
+}
+
+// Request line and headers into _request; false on timeout or overflow
+bool WebDashboard::readRequest(WiFiClient& http) {
+  size_t len = 0;
+  unsigned long start = millis();
+
+  while (millis() - start < REQUEST_TIMEOUT_MS) {
+    if (!http.available()) {
+      if (!http.connected()) return false;
+      vTaskDelay(1);
+      continue;
+    }
+    char c = (char)http.read();
+    if (len >= REQUEST_MAX - 1) return false;
+    _request[len++] = c;
+    if (len >= 4 && memcmp(_request + len - 4, "\r\n\r\n", 4) == 0) {
+      _request[len] = '\0';
+      return true;
+    }
+  }
+  return false;
+}
+
+// Value of a request header, running to the end of its line; NULL if absent
+const char* WebDashboard::header(const char* name) const {
+  size_t nameLen = strlen(name);
+  const char* line = strstr(_request, "\r\n");
+  while (line != NULL && line[2] != '\r') {
+    line += 2;
+    if (strncasecmp(line, name, nameLen) == 0 && line[nameLen] == ':') {
+      const char* value = line + nameLen + 1;
+      while (*value == ' ') value++;
+      return value;
+    }
+    line = strstr(line, "\r\n");
+  }
+  return NULL;
+}
+
+void WebDashboard::handleRequest(WiFiClient& http) {
+  if (strncmp(_request, "GET / ", 6) == 0) {
+    char head[160];
+    int len = snprintf(head, sizeof(head),
+                       "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/html\r\n"
+                       "Content-Encoding: gzip\r\n"
+                       "Content-Length: %u\r\n"
+                       "Connection: close\r\n\r\n",
+                       (unsigned)DASHBOARD_PAGE_GZ_LEN);
+    http.write((const uint8_t*)head, len);
+    http.write(DASHBOARD_PAGE_GZ, DASHBOARD_PAGE_GZ_LEN);   // straight from flash
+    http.stop();
+    return;
+  }
+
+  const char* key = header("Sec-WebSocket-Key");
+  if (strncmp(_request, "GET /ws ", 8) == 0 && key != NULL) {
+    upgrade(http, key);
+    return;
+  }
+
+  http.print("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+  http.stop();
+}
+
+void WebDashboard::upgrade(WiFiClient& http, const char* key) {
+  Client* slot = NULL;
+  for (uint8_t i = 0; i < CLIENTS_MAX && slot == NULL; ++i) {
+    if (!_clients[i].open) slot = &_clients[i];
+  }
+  if (slot == NULL) {
+    http.print("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    http.stop();
+    return;
+  }
+
+  // Sec-WebSocket-Accept = base64(SHA-1(key + GUID))
+  char input[64 + sizeof(WS_GUID)];
+  size_t keyLen = strcspn(key, "\r ");
+  if (keyLen > 64) keyLen = 64;
+  memcpy(input, key, keyLen);
+  memcpy(input + keyLen, WS_GUID, sizeof(WS_GUID));
+
+  uint8_t digest[20];
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+  mbedtls_sha1((const uint8_t*)input, keyLen + sizeof(WS_GUID) - 1, digest);
+#else
+  mbedtls_sha1_ret((const uint8_t*)input, keyLen + sizeof(WS_GUID) - 1, digest);
+#endif
+  char accept[32];
+  size_t acceptLen = 0;
+  mbedtls_base64_encode((uint8_t*)accept, sizeof(accept) - 1, &acceptLen, digest, sizeof(digest));
+  accept[acceptLen] = '\0';
+
+  char head[160];
+  int len = snprintf(head, sizeof(head),
+                     "HTTP/1.1 101 Switching Protocols\r\n"
+                     "Upgrade: websocket\r\n"
+                     "Connection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: %s\r\n\r\n",
+                     accept);
+  http.write((const uint8_t*)head, len);
+
+  slot->socket = http;
+  slot->open = true;
+  slot->rxLen = 0;
+  for (uint8_t s = 0; s < STATION_MAX; ++s) {
+    slot->synced[s] = false;
+  }
+  sendHello(*slot);
+  Serial.println("Dashboard: browser connected");
+}
+
+//-----------------------------------------------------------------------------
+// WebSocket
+//-----------------------------------------------------------------------------
+
+void WebDashboard::serviceClient(Client& c) {
+  if (!c.socket.connected()) {
+    closeClient(c);
+    return;
+  }
+
+  while (c.rxLen < RX_MAX && c.socket.available()) {
+    c.rx[c.rxLen++] = (uint8_t)c.socket.read();
+  }
+
+  // Browsers send short masked frames; anything else ends the session
+  while (c.rxLen >= 2) {
+    uint8_t opcode = c.rx[0] & 0x0F;
+    bool fin = c.rx[0] & 0x80;
+    bool masked = c.rx[1] & 0x80;
+    uint8_t len = c.rx[1] & 0x7F;
+    if (!fin || !masked || len > 125) {
+      closeClient(c);
+      return;
+    }
+    size_t total = 2 + 4 + len;
+    if (c.rxLen < total) break;
+
+    uint8_t* mask = c.rx + 2;
+    uint8_t* payload = c.rx + 6;
+    for (uint8_t i = 0; i < len; ++i) {
+      payload[i] ^= mask[i & 3];
+    }
+
+    if (opcode == WS_TEXT) {
+      char text[126];
+      memcpy(text, payload, len);
+      text[len] = '\0';
+      handleText(text);
+    } else if (opcode == WS_PING) {
+      sendFrame(c, WS_PONG, payload, len);
+    } else if (opcode == WS_CLOSE) {
+      sendFrame(c, WS_CLOSE, NULL, 0);
+      closeClient(c);
+      return;
+    }
+
+    memmove(c.rx, c.rx + total, c.rxLen - total);
+    c.rxLen -= total;
+  }
+}
+
+void WebDashboard::handleText(const char* text) {
+  char verb[8];
+  unsigned station = 0;
+  int value = 0;
+  if (sscanf(text, "%7s %u %d", verb, &station, &value) != 3 || station >= _stationCount) {
+    Serial.println("Dashboard: bad command");
+    return;
+  }
+
+  BackendCommand cmd;
+  cmd.station = (uint8_t)station;
+  cmd.value = (int8_t)value;
+  cmd.seq = 0;    // not a button press, the UI's sequence stays untouched
+
+  if (strcmp(verb, "band") == 0 && value >= 0 && value < (int)BandPlan::BAND_COUNT) {
+    cmd.type = BackendCommand::SET_BAND;
+  } else if (strcmp(verb, "mode") == 0 && value >= KXPA100Controller::MODE_BYPASS &&
+             value <= KXPA100Controller::MODE_AUTO) {
+    cmd.type = BackendCommand::SET_MODE;
+  } else if (strcmp(verb, "antenna") == 0 && (value == 1 || value == 2)) {
+    cmd.type = BackendCommand::SET_ANTENNA;
+  } else {
+    Serial.println("Dashboard: bad command");
+    return;
+  }
+
+  if (!_commands.push(cmd)) {
+    Serial.println("Dashboard: command queue full");
+    return;
+  }
+  if (_notifyTask != NULL) {
+    xTaskNotify(_notifyTask, _notifyBits, eSetBits);
+  }
+}
+
+void WebDashboard::sendHello(Client& c) {
+  char hello[TX_MAX - 4];
+  size_t len = snprintf(hello, sizeof(hello), "{\"stations\":[");
+  for (uint8_t s = 0; s < _stationCount && len < sizeof(hello); ++s) {
+    len += snprintf(hello + len, sizeof(hello) - len, "%s\"%s\"", s ? "," : "", _labels[s]);
+  }
+  if (len < sizeof(hello)) {
+    len += snprintf(hello + len, sizeof(hello) - len, "],\"bands\":[");
+  }
+  for (size_t b = 0; b < BandPlan::BAND_COUNT && len < sizeof(hello); ++b) {
+    len += snprintf(hello + len, sizeof(hello) - len, "%s\"%s\"", b ? "," : "", BandPlan::BANDS[b].name);
+  }
+  if (len < sizeof(hello)) {
+    len += snprintf(hello + len, sizeof(hello) - len, "]}");
+  }
+  if (len >= sizeof(hello)) {
+    Serial.println("Dashboard: hello too long");
+    closeClient(c);
+    return;
+  }
+  sendFrame(c, WS_TEXT, (const uint8_t*)hello, len);
+}
+
+void WebDashboard::pushTelemetry(Client& c) {
+  uint8_t frame[DELTA_MAX];
+  for (uint8_t s = 0; s < _stationCount && c.open; ++s) {
+    if (_telemetry[s] == NULL) continue;
+
+    const Telemetry& t = _telemetry[s]->front();
+    uint32_t changed = c.synced[s] ? diffTelemetry(c.sent[s], t) : DIRTY_ALL;
+    if (changed == 0) continue;
+
+    size_t len = encodeDelta(s, changed, t, frame);
+    if (sendFrame(c, WS_BINARY, frame, len)) {
+      c.sent[s] = t;
+      c.synced[s] = true;
+    }
+  }
+}
+
+bool WebDashboard::sendFrame(Client& c, uint8_t opcode, const uint8_t* data, size_t len) {
+  if (len > TX_MAX - 4) return false;
+
+  // Header and payload in one write, unmasked from the server
+  size_t head;
+  _tx[0] = 0x80 | opcode;
+  if (len < 126) {
+    _tx[1] = (uint8_t)len;
+    head = 2;
+  } else {
+    _tx[1] = 126;
+    _tx[2] = (uint8_t)(len >> 8);
+    _tx[3] = (uint8_t)len;
+    head = 4;
+  }
+  if (len > 0) {
+    memcpy(_tx + head, data, len);
+  }
+
+  if (c.socket.write(_tx, head + len) != head + len) {
+    closeClient(c);
+    return false;
+  }
+  return true;
+}
+
+void WebDashboard::closeClient(Client& c) {
+  if (!c.open) return;
+  c.socket.stop();
+  c.open = false;
+  c.rxLen = 0;
+  Serial.println("Dashboard: browser disconnected");
+}
+
+//-----------------------------------------------------------------------------
+// Encoder
+//-----------------------------------------------------------------------------
+
+static uint8_t* putInt16(uint8_t* p, int16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)((uint16_t)v >> 8);
+  return p + 2;
+}
+
+size_t WebDashboard::encodeDelta(uint8_t station, uint32_t changed, const Telemetry& t, uint8_t* out) {
+  uint8_t* p = out;
+  *p++ = station;
+  p = putInt16(p, (int16_t)changed);
+
+  if (changed & DIRTY_BAND) *p++ = (uint8_t)t.bandIndex;
+  if (changed & DIRTY_POWER) p = putInt16(p, t.powerX10);
+  if (changed & DIRTY_TEMP) p = putInt16(p, t.tempX10);
+  if (changed & DIRTY_SWR) p = putInt16(p, t.swrX10);
+  if (changed & DIRTY_ANTENNA) *p++ = (uint8_t)t.antenna;
+  if (changed & DIRTY_MODE) *p++ = (uint8_t)t.mode;
+  if (changed & DIRTY_FAULTS) {
+    memset(p, 0, KXPA100Controller::FAULTS_MAX);
+    strncpy((char*)p, t.faults, KXPA100Controller::FAULTS_MAX - 1);
+    p += KXPA100Controller::FAULTS_MAX;
+  }
+  if (changed & DIRTY_VOLTAGE) p = putInt16(p, t.voltageMv);
+  if (changed & DIRTY_CONNECTION) {
+    *p++ = (t.kxpaConnected ? 1 : 0) | (t.catConnected ? 2 : 0);
+  }
+  return (size_t)(p - out);
+}
@@ -0,0 +1,101 @@
+#ifndef WEBDASHBOARD_H
+#define WEBDASHBOARD_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "Telemetry.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "BackendCommand.h"
+
+// Browser dashboard: one static page and a WebSocket, served by a task of its own.
+//
+// GET / returns the gzipped page straight from flash (DashboardPage.h, built
+// from web/dashboard.html), GET /ws upgrades to a WebSocket. Every socket
+// gets a hello text frame with the station labels and band names, then a
+// binary delta frame per station whenever the backend publishes a change:
+//   station uint8, changed uint16 (DIRTY_*), then only the changed fields in
+//   bit order: band int8, power int16, temp int16, SWR int16, antenna int8,
+//   mode int8, faults char[8], voltage uint16, link uint8 (1 KXPA, 2 CAT)
+// Text frames "band <station> <index>", "mode <station> <0-2>" and
+// "antenna <station> <1|2>" become BackendCommands in a queue of their own,
+// drained by the backend next to the button queue.
+//
+// The task runs below the backend on core 0 and only touches the sockets, the
+// telemetry buffers and its queue, so a slow browser stalls nothing but itself.
+class WebDashboard {
+public:
+  static const uint8_t STATION_MAX = 2;
+  static const uint8_t CLIENTS_MAX = 2;
+  static const uint8_t COMMAND_QUEUE_LEN = 8;
+  static const unsigned long POLL_MS = 20;            // WiFiClient cannot wake the task
+  static const unsigned long IDLE_POLL_MS = 200;      // no browser connected
+  static const unsigned long REQUEST_TIMEOUT_MS = 500;
+  static const uint32_t TASK_STACK = 4096;
+
+  typedef SpscQueue<BackendCommand, COMMAND_QUEUE_LEN> CommandQueue;
+
+  explicit WebDashboard(uint16_t port);
+
+  // Before begin(): one buffer per station, published by the backend, read only here
+  void attach(uint8_t station, const char* label, TripleBuffer<Telemetry>& telemetry);
+
+  // Starts the server task; notifyBits are set on notifyTask for every queued command
+  bool begin(TaskHandle_t notifyTask, uint32_t notifyBits);
+
+  // Backend side: a new snapshot was published
+  void notify();
+
+  // Backend side: commands from the browsers
+  CommandQueue& commands() { return _commands; }
+
+  // NULL before begin()
+  TaskHandle_t task() const { return _taskHandle; }
+
+private:
+  static const size_t REQUEST_MAX = 512;
+  static const size_t RX_MAX = 2 + 4 + 125;   // one masked frame with a short payload
+  static const size_t TX_MAX = 4 + 256;
+  static const size_t DELTA_MAX = 32;
+
+  struct Client {
+    WiFiClient socket;
+    bool open;
+    bool synced[STATION_MAX];        // the browser has a full snapshot
+    Telemetry sent[STATION_MAX];     // what the browser shows
+    uint8_t rx[RX_MAX];
+    size_t rxLen;
+  };
+
+  static void taskEntry(void* arg);
+  void run();
+  void acceptClient();
+  bool readRequest(WiFiClient& http);
+  void handleRequest(WiFiClient& http);
+  void upgrade(WiFiClient& http, const char* key);
+  void serviceClient(Client& c);
+  void handleText(const char* text);
+  void pushTelemetry(Client& c);
+  void sendHello(Client& c);
+  bool sendFrame(Client& c, uint8_t opcode, const uint8_t* data, size_t len);
+  void closeClient(Client& c);
+  const char* header(const char* name) const;
+
+  static size_t encodeDelta(uint8_t station, uint32_t changed, const Telemetry& t, uint8_t* out);
+
+  WiFiServer _server;
+  TaskHandle_t _taskHandle;
+  TaskHandle_t _notifyTask;
+  uint32_t _notifyBits;
+
+  uint8_t _stationCount;
+  const char* _labels[STATION_MAX];
+  TripleBuffer<Telemetry>* _telemetry[STATION_MAX];
+
+  CommandQueue _commands;
+  Client _clients[CLIENTS_MAX];
+  char _request[REQUEST_MAX];
+  uint8_t _tx[TX_MAX];
+};
+
+#endif // WEBDASHBOARD_H
@@ -0,0 +1,36 @@
+#pragma once
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "DatagramSocket.h"
+
+// DatagramSocket on a WiFiUDP socket.
+//
+// The host is resolved once (DNS would block the backend on every packet).
+// WiFiUDP allocates its packet buffer at the first beginPacket() and keeps it.
+class WiFiDatagramSocket : public DatagramSocket {
+public:
+  WiFiDatagramSocket() : _host(NULL), _started(false) {}
+
+  bool send(const char* host, uint16_t port, const uint8_t* data, size_t len) override {
+    if (host != _host) {
+      if (!_remote.fromString(host) && !WiFi.hostByName(host, _remote)) {
+        return false;
+      }
+      _host = host;
+    }
+    if (!_started) {
+      _started = _udp.begin(0) != 0;   // any local port
+    }
+    if (!_udp.beginPacket(_remote, port)) {
+      return false;
+    }
+    _udp.write(data, len);
+    return _udp.endPacket() != 0;
+  }
+
+private:
+  WiFiUDP _udp;
+  IPAddress _remote;
+  const char* _host;
+  bool _started;
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <WiFi.h>
+#include "NetClient.h"
+
+// NetClient on a WiFiClient socket
+class WiFiNetClient : public NetClient {
+public:
+  // Without a timeout WiFiClient waits its default of about 3 s
+  int connect(const char* host, uint16_t port, uint16_t timeoutMs) override {
+    return _client.connect(host, port, (int32_t)timeoutMs);
+  }
+  bool connected() override { return _client.connected(); }
+  int available() override { return _client.available(); }
+  int read() override { return _client.read(); }
+  size_t print(const char* data) override { return _client.print(data); }
+  void stop() override { _client.stop(); }
+
+private:
+  WiFiClient _client;
+};
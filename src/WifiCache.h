@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+// What a fast reconnect needs from the last association: the access point
+// (BSSID and channel skip the scan) and the address (reused as a static IP,
+// skipping DHCP). Addresses are in lwIP byte order, as held by IPAddress.
+struct WifiCache {
+  char ssid[33];                // network the rest belongs to, "" = empty
+  uint8_t bssid[6];
+  uint8_t channel;              // 0 = unknown
+  uint32_t ip;                  // 0 = none
+  uint32_t gateway;
+  uint32_t mask;
+  uint32_t dns;
+};
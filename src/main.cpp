@@ -12,22 +12,53 @@ an ICOM IC-705 transceiver.
 Architecture overview:
 1. Core 1 (UI Task): Handles Button inputs and Display updates. High responsiveness.
 2. Core 0 (Backend Task): Handles WiFi (CAT) and Serial (KXPA) communication.
-   Data is exchanged via Mutex-protected shared variables.
+   Telemetry is published as a triple-buffered snapshot, no locks involved.
+3. One backend serves up to two stations (KXPA100 + CAT source each); their
+   polls are interleaved, BtnA+BtnC switches the station on screen.
+4. Tuning and the last band/mode/CAT endpoint live in NVS: the screen shows
+   the saved state at once, the amp only gets the writes it needs.
 
 
 ---------------------------------------------------------------------------------
 */
 
 #include <M5Unified.h>
+#include <SPIFFS.h>
 #include "KXPA100Controller.h"
+#include "HardwareSerialPort.h"
 #include "CatWifiClient.h"
+#include "WiFiNetClient.h"
+#include "CivBluetoothClient.h"
+#include "TripleBuffer.h"
+#include "Telemetry.h"
+#include "SpscQueue.h"
+#include "BackendCommand.h"
+#include "InputEvent.h"
+#include "KxpaScheduler.h"
+#include "TelemetryHistory.h"
+#include "BandSelector.h"
+#include "ProtectionEngine.h"
+#include "UiField.h"
+#include "MeterBar.h"
+#include "DmaPusher.h"
+#include "UiPalette.h"
+#include "PowerManager.h"
+#include "LatencyStats.h"
+#include "TelemetryPublisher.h"
+#include "WiFiDatagramSocket.h"
+#include "WebDashboard.h"
+#include "SettingsStore.h"
+#include "TaskProfiler.h"
+#include "FrameLog.h"
+#include "ReplaySerialPort.h"
+#include "SweepCatSource.h"
 #include "Secrets.h"
 
 #define TITLE_VERSION   "KXPA100 Control"
 #define MIN_POS         0      
 #define MAX_POS         10     
 
-// Serial Configuration
+// Serial Configuration (baud and delay are defaults, see "set" on the console)
 #define RX_PIN          16
 #define TX_PIN          17
 #define BAUD_RATE       38400  
@@ -35,13 +66,56 @@ Architecture overview:
 #define INVERTED        true   
 #define BAUD_DEBUG      115200 
 
+// Stations: 1 = one KXPA100 on Serial2, 2 = a second one on Serial1 (M5Stack Port B)
+// with its own rigctld (CAT_SERVER_2 / RIGCTLD_PORT_2)
+#ifndef STATION_COUNT
+#define STATION_COUNT   1
+#endif
+#define RX2_PIN         36
+#define TX2_PIN         26
+
+#if STATION_COUNT < 1 || STATION_COUNT > 2
+#error "STATION_COUNT must be 1 or 2 (Serial1 and Serial2 are the free UARTs)"
+#endif
+
 // Timing Constants
 #define DISPLAY_UPDATE_MS       500
 #define POWEROFF_TIMEOUT_MS     30000  // 30 seconds
 #define POWEROFF_WARNING_MS     25000  // Warn at 25 seconds
-#define BACKEND_POLL_MS         200    // Reduced from 50ms - saves power
-#define MUTEX_TIMEOUT_MS        50
-#define SEMAPHORE_TIMEOUT_TICKS pdMS_TO_TICKS(MUTEX_TIMEOUT_MS)
+#define METER_FRAME_MS          40     // meter view refresh (25 fps)
+#define METER_AUTO_TX           1      // switch to the meter view while transmitting
+#define METER_HOLD_MS           3000   // stay on the meter this long after TX ends
+#define DIAG_REFRESH_MS         1000   // diagnostics and profiling page refresh
+#define PROFILE_HOLD_MS         2000   // BtnA+BtnC held this long opens the profiling page
+#define PROFILE_STACK_LOW       512    // stack bytes never used below this are shown in red
+#define SERIAL_CMD_MAX          32     // debug console line length
+#define CAT_POLL_MS             50     // CAT frequency query interval (non-blocking), NVS "catpoll"
+#define KXPA_SERVICE_MS         20     // re-check while KXPA requests are in flight
+#define KXPA_POLL_BUDGET        6      // max. status queries per poll cycle
+#define COMMAND_QUEUE_LEN       8
+#define INPUT_QUEUE_LEN         16
+#define INPUT_SCAN_MS           5      // button scan period of the input task
+#define BAND_DWELL_MS           250    // CAT band must be stable this long before switching, NVS "dwell"
+#define BOOT_BAND               5      // 20m, until a band has been saved
+#define BOOT_MODE               KXPA100Controller::MODE_AUTO
+#define KXPA_PROBE_MS           3000   // the saved state is shown this long before "No KXPA100"
+#define POWER_IDLE_MS           20000  // no button, CAT or amp change this long -> idle profile
+#define POWER_IDLE_BRIGHTNESS   16     // backlight while idle
+#define POWER_IDLE_CPU_MHZ      80     // lowest clock that keeps APB (UART, WiFi, SPI) at 80 MHz
+#define POWER_POLL_BACKOFF      5      // idle poll periods are stretched this much in standby
+#define DISPLAY_IDLE_UPDATE_MS  5000   // forced redraw interval while idle
+#define UI_ACTIVE_WAIT_MS       10     // UI loop sleep, cut short by input or new telemetry
+#define UI_IDLE_WAIT_MS         100
+#define INPUT_IDLE_SCAN_MS      20     // button scan period while idle
+#define BACKEND_STACK_SIZE      8192
+#define INPUT_STACK_SIZE        3072
+
+// Protection: a crossed limit puts the amp into bypass right after the sample that shows it
+#define PROTECT_SWR_MAX_X10       30     // SWR 3.0
+#define PROTECT_SWR_MIN_POWER_X10 50     // SWR is judged from 5 W forward power
+#define PROTECT_TEMP_MAX_X10      700    // 70 °C
+#define PROTECT_VOLTAGE_MIN_MV    10500
+#define PROTECT_VOLTAGE_MAX_MV    15500
 
 // Sprite Dimensions
 #define IMG0_WIDTH      320
@@ -54,8 +128,58 @@ Architecture overview:
 #define IMG2_HEIGHT     30
 
 // CAT Configuration
-const unsigned long CAT_TIMEOUT_MS = 10000; 
-const char* CAT_COMMAND = "f\n";
+// CAT_SOURCE_CIV_BT 0: rigctld over WiFi, 1: CI-V transceive directly from the IC-705 via Bluetooth
+#ifndef CAT_SOURCE_CIV_BT
+#define CAT_SOURCE_CIV_BT       0
+#endif
+#define CIV_BT_DEVICE           "ICOM BT(IC-705)"
+#define CIV_RADIO_ADDR          0xA4   // IC-705 default CI-V address
+#define CIV_CTRL_ADDR           0xE0
+const unsigned long CAT_TIMEOUT_MS = 1000;   // per outstanding request
+
+// WiFi fast reconnect: join the saved AP on its channel without a scan; with
+// WIFI_REUSE_IP also take the last DHCP address as a static IP (DHCP again if
+// the CAT server can't be reached with it)
+#ifndef WIFI_REUSE_IP
+#define WIFI_REUSE_IP           1
+#endif
+
+// Telemetry export: UDP datagrams to TELEMETRY_HOST:TELEMETRY_PORT (Secrets.h) while WiFi is up
+#ifndef TELEMETRY_UDP
+#define TELEMETRY_UDP           1
+#endif
+#define TELEMETRY_FORMATS       TelemetryPublisher::FORMAT_BINARY   // | FORMAT_JSON, sent to port + 1
+#define TELEMETRY_MIN_INTERVAL_MS 100  // changes are coalesced, max. 10 datagrams/s per station
+#define TELEMETRY_HEARTBEAT_MS  5000   // resend the unchanged state this often
+
+// Browser dashboard on http://<M5Stack IP>/, needs WiFi (rigctld or a second station)
+#ifndef WEB_DASHBOARD
+#define WEB_DASHBOARD           (!CAT_SOURCE_CIV_BT || STATION_COUNT > 1)
+#endif
+#define WEB_PORT                80
+
+// Frame capture of the KXPA links and CAT sources (serial "cap ..."), the ring is
+// allocated on the first start, from PSRAM when the board has it
+#define FRAME_LOG_BYTES         16384
+#define FRAME_LOG_PSRAM_BYTES   262144
+#define FRAME_LOG_AT_BOOT       0      // 1 = capture from power-on
+#define FRAME_LOG_PATH          "/kxpa.cap"
+#define CAPTURE_SAVE_STACK_SIZE 4096
+// Bench: station A talks to the capture in FRAME_LOG_PATH instead of its UART
+#ifndef KXPA_REPLAY
+#define KXPA_REPLAY             0
+#endif
+#define REPLAY_PUMP_STACK_SIZE  2048
+
+// Soak benchmark (pio run -e soak): a scripted rig walks the bands, backend
+// and UI run flat out, a CSV row of latencies and heap every SOAK_REPORT_MS
+#ifndef SOAK_BENCH
+#define SOAK_BENCH              0
+#endif
+#define SOAK_QSY_MS             1000   // the rig moves to the next band this often
+#define SOAK_CAT_REPLY_MS       5      // scripted rigctld turnaround
+#define SOAK_UI_WAIT_MS         1      // UI loop sleep, one tick keeps the idle task alive
+#define SOAK_REPORT_MS          60000
 
 // Layout Constants
 const int LINE1_Y       = 15;
@@ -64,75 +188,320 @@ const int LINE3_Y       = LINE2_Y + 35;
 const int LINE4_Y       = LINE3_Y + 35;
 const int LINE_LEFT_X   = 5;
 const int VALUES_X      = 105;
+const int PANEL_Y       = IMG0_HEIGHT;      // top of the left/right panels
+const int RIGHT_X       = IMG1_WIDTH;       // left edge of the right panel
+const int BIG_FIELD_H   = LINE2_Y - LINE1_Y;
+const int FIELD_H       = 30;
 
 // Button Repeat Configuration
 const unsigned long BTN_REPEAT_DELAY_INITIAL_MS = 400;
 const unsigned long BTN_REPEAT_RATE_MS = 150;
 
 // -----------------------------------------------------------------------------------------
-// SHARED DATA STRUCT (Protected by Mutex)
+// SHARED TELEMETRY (Backend publishes, UI reads, both wait-free)
 // -----------------------------------------------------------------------------------------
-struct SharedData {
-  int bandIndex = 0;
-  String bandName = "";
-  String power = "0";
-  String temp = "0";
-  String swr = "1.0";
-  String antenna = "";
-  String mode = "";
-  String faults = "";
-  String voltage = "";
-  
-  bool catConnected = false;
-  bool kxpaConnected = false;
-  
-  // Manual band change request
-  volatile bool manualChangeReq = false; 
-  int manualTargetBand = 0;
-  
-  // Dirty flags for optimized rendering
-  bool bandDirty = true;
-  bool powerDirty = true;
-  bool tempDirty = true;
-  bool swrDirty = true;
-  bool antennaDirty = true;
-  bool modeDirty = true;
-  bool faultsDirty = true;
-  bool voltageDirty = true;
-  bool connectionDirty = true;
+// Snapshot and dirty bits: see Telemetry.h
+
+// NVS: tuning (UI task) and last state (backend task), loaded before the tasks start
+const SettingsStore::Tuning TUNING_DEFAULTS = {
+  BAUD_RATE, DELAY_COMM_MS, CAT_POLL_MS, BAND_DWELL_MS, BANDPLAN_ANT2_MASK
+};
+SettingsStore settings(TUNING_DEFAULTS);
+unsigned long catPollMs = CAT_POLL_MS;
+
+static_assert(STATION_COUNT <= SettingsStore::STATION_MAX, "SettingsStore keeps the state of two stations");
+
+// Rollups of the polled values of the first station (static arena, written by the backend only)
+TelemetryHistory history;
+
+const ProtectionEngine::Limits PROTECT_LIMITS = {
+  PROTECT_SWR_MAX_X10, PROTECT_SWR_MIN_POWER_X10, PROTECT_TEMP_MAX_X10,
+  PROTECT_VOLTAGE_MIN_MV, PROTECT_VOLTAGE_MAX_MV
 };
 
-SharedData sharedState;
-SemaphoreHandle_t dataMutex;
+// -----------------------------------------------------------------------------------------
+// STATIONS (one KXPA100 and its CAT source each, all served by the backend task)
+// -----------------------------------------------------------------------------------------
+struct Station {
+  Station(uint8_t num, const char* name, KXPA100Controller& amp, CatSource& rig,
+          TelemetryHistory* rollups)
+    : index(num), label(name), kxpa(amp), cat(rig), scheduler(KXPA_POLL_BUDGET),
+      selector(amp, BAND_DWELL_MS), protection(PROTECT_LIMITS),
+      history(rollups), dirty(DIRTY_ALL),
+      currentBandIdx(0), lastCatPoll(0), lastCatFreq(0), catBandSinceUs(0),
+      restoreBand(BOOT_BAND), restoreMode(BOOT_MODE), restoreSeen(0), restorePending(true), manualReq(false),
+      justSwitched(false), bandKnown(false), catOk(false), freqNew(false), pollDue(false) {
+    const char* sep = name[0] != '\0' ? ": " : "";
+    snprintf(titleCat, sizeof(titleCat), ">>  %s%sCAT Control  <<", name, sep);
+    snprintf(titleManual, sizeof(titleManual), ">>  %s%sManual Control  <<", name, sep);
+    snprintf(titleNoKxpa, sizeof(titleNoKxpa), "%s%sNo KXPA100", name, sep);
+    snprintf(titleStart, sizeof(titleStart), "%s%sConnecting...", name, sep);
+
+    memset(&status, 0, sizeof(status));
+    status.band = -1;
+    status.mode = KXPA100Controller::MODE_UNKNOWN;
+  }
+
+  const uint8_t index;               // into stations[]
+  const char* label;                 // "" with a single station
+  KXPA100Controller& kxpa;
+  CatSource& cat;
+  KxpaScheduler scheduler;
+  BandSelector selector;
+  ProtectionEngine protection;
+  TelemetryHistory* history;         // NULL = not recorded
+
+  // Backend -> UI
+  TripleBuffer<Telemetry> telemetry;
+  std::atomic<uint32_t> dirty;
+#if WEB_DASHBOARD
+  TripleBuffer<Telemetry> webTelemetry;   // Backend -> web task
+#endif
+
+  // Status line texts, built once so showStatusLine() can compare pointers
+  char titleCat[32];
+  char titleManual[32];
+  char titleNoKxpa[24];
+  char titleStart[24];
+
+  // Backend task only; the snapshot persists, every poll refreshes the scheduled fields
+  KXPA100Controller::StatusSnapshot status;
+  KxpaScheduler::PollPlan plan;
+  Telemetry published;
+  int currentBandIdx;
+  unsigned long lastCatPoll;
+  uint32_t lastCatFreq;
+  int64_t catBandSinceUs;            // first CAT frequency of the pending band, 0 = none
+
+  // Warm start: band and mode from NVS, applied once both have been polled
+  int8_t restoreBand;
+  int8_t restoreMode;
+  uint16_t restoreSeen;              // PollParam bits answered since boot
+  bool restorePending;
+
+  // State of the current backend pass
+  bool manualReq;
+  bool justSwitched;
+  bool bandKnown;
+  bool catOk;
+  bool freqNew;
+  bool pollDue;
+};
+
+// Commands (UI -> backend), the backend is woken by a task notification
+SpscQueue<BackendCommand, COMMAND_QUEUE_LEN> commandQueue;
+TaskHandle_t backendTaskHandle = NULL;
+
+// Backend wake-up reasons (task notification bits), timers are the wait timeout
+enum : uint32_t {
+  EVT_COMMAND = 1 << 0,    // UI pushed a command
+  EVT_KXPA    = 1 << 1,    // unsolicited KXPA frame
+  EVT_CAT     = 1 << 2,    // CAT source has news (link change, data)
+  EVT_POWER   = 1 << 3     // power level changed
+};
+uint32_t uiCommandSeq = 0;
+
+// Buttons (input task -> UI loop), scanned at a fixed rate independent of rendering
+SpscQueue<InputEvent, INPUT_QUEUE_LEN> inputQueue;
+TaskHandle_t uiTaskHandle = NULL;    // loop(), notified on input and new telemetry
+TaskHandle_t inputTaskHandle = NULL;
+
+// Set by every task that sees activity, the UI applies the level
+PowerManager power(POWER_IDLE_MS, POWER_IDLE_BRIGHTNESS, POWER_IDLE_CPU_MHZ);
 
 // Global objects
-M5Canvas img0(&M5.Lcd);
-M5Canvas img1(&M5.Lcd);
-M5Canvas img1a(&M5.Lcd);
-M5Canvas img2(&M5.Lcd);
+DmaPusher dma(M5.Lcd);
+// Status line (top) and menu bar (bottom) are rendered in turn through one scratch canvas
+#if IMG0_WIDTH != IMG2_WIDTH || IMG0_HEIGHT != IMG2_HEIGHT
+#error "status line and menu bar share barCanvas, keep their sizes equal"
+#endif
+M5Canvas barCanvas(&M5.Lcd);
+
+// Value boxes (screen coordinates), the static labels are drawn once by drawLayout()
+UiField fieldBand(&M5.Lcd, LINE_LEFT_X, PANEL_Y + LINE1_Y, IMG1_WIDTH - LINE_LEFT_X, BIG_FIELD_H, &fonts::FreeSansBold24pt7b);
+UiField fieldPower(&M5.Lcd, VALUES_X, PANEL_Y + LINE2_Y, IMG1_WIDTH - VALUES_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+UiField fieldTemp(&M5.Lcd, VALUES_X, PANEL_Y + LINE3_Y, IMG1_WIDTH - VALUES_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+UiField fieldSwr(&M5.Lcd, VALUES_X, PANEL_Y + LINE4_Y, IMG1_WIDTH - VALUES_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+UiField fieldAntenna(&M5.Lcd, RIGHT_X + LINE_LEFT_X, PANEL_Y + LINE1_Y, IMG1a_WIDTH - LINE_LEFT_X, BIG_FIELD_H, &fonts::FreeSansBold24pt7b);
+UiField fieldMode(&M5.Lcd, RIGHT_X + LINE_LEFT_X, PANEL_Y + LINE2_Y, IMG1a_WIDTH - LINE_LEFT_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+UiField fieldFaults(&M5.Lcd, RIGHT_X + LINE_LEFT_X, PANEL_Y + LINE3_Y, IMG1a_WIDTH - LINE_LEFT_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+UiField fieldSupply(&M5.Lcd, RIGHT_X + LINE_LEFT_X, PANEL_Y + LINE4_Y, IMG1a_WIDTH - LINE_LEFT_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+
+UiField* const valueFields[] = {
+  &fieldBand, &fieldPower, &fieldTemp, &fieldSwr,
+  &fieldAntenna, &fieldMode, &fieldFaults, &fieldSupply
+};
+
+// Meter view: forward power 0-100 W, SWR 1.0-3.0 (orange from 1.5/2.0)
+const int METER_X       = LINE_LEFT_X;
+const int METER_W       = IMG1_WIDTH + IMG1a_WIDTH - 2 * LINE_LEFT_X;
+const int METER_BAR_H   = 30;
+const int METER_PWR_Y   = PANEL_Y + 10;
+const int METER_SWR_Y   = PANEL_Y + 95;
+const int METER_VALUE_X = 220;
+
+UiField meterPowerField(&M5.Lcd, METER_VALUE_X, METER_PWR_Y, METER_W + METER_X - METER_VALUE_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+UiField meterSwrField(&M5.Lcd, METER_VALUE_X, METER_SWR_Y, METER_W + METER_X - METER_VALUE_X, FIELD_H, &fonts::FreeSansBold12pt7b);
+MeterBar meterPower(&M5.Lcd, METER_X + 1, METER_PWR_Y + FIELD_H + 1, METER_W - 2, METER_BAR_H - 2,
+                    0, 1000, 1000, DARKGREEN, RED, WHITE);
+MeterBar meterSwr(&M5.Lcd, METER_X + 1, METER_SWR_Y + FIELD_H + 1, METER_W - 2, METER_BAR_H - 2,
+                  10, 30, 20, DARKGREEN, ORANGE, WHITE);
+
+// What the panels currently show, so the layout is only drawn on a change
+enum UiView : uint8_t {
+  VIEW_NONE,       // unknown (boot, overwritten by the power-off warning)
+  VIEW_BLANK,      // no KXPA
+  VIEW_VALUES,
+  VIEW_METER,      // PF/SWR bar graphs
+  VIEW_DIAG,       // latency stats (serial "diag")
+  VIEW_PROFILE     // tasks, stacks and heap (BtnA+BtnC held)
+};
+
+enum MenuBar : uint8_t {
+  MENU_NONE,
+  MENU_BLANK,
+  MENU_CAT,
+  MENU_MANUAL
+};
+
+UiView uiView = VIEW_NONE;
+MenuBar uiMenu = MENU_NONE;
+bool uiMeterPinned = false;     // BtnB in CAT mode
+bool uiDiagShown = false;       // toggled from the serial console, any button closes it
+bool uiProfileShown = false;    // opened by a long BtnA+BtnC, any button closes it
+unsigned long timerMeter = 0;
+unsigned long timerMeterHistory = 0;   // 0 = draw the history rows with the next frame
+unsigned long timerLastTx = 0;
+unsigned long timerDiag = 0;
+TaskProfiler::Report profile;   // UI task, page and serial "prof"
+
+// Backend task only (the serial console goes through BackendCommand::CAPTURE);
+// while captureSaving is set the stopped ring belongs to captureSaveTask
+FrameLog frameLog;
+std::atomic<bool> captureSaving(false);
+TaskHandle_t captureSaveTaskHandle = NULL;
+bool spiffsMounted = false;     // setup(), formatted there on the first boot
+
+#if KXPA_REPLAY
+ReplaySerialPort kxpaPort;
+#else
+HardwareSerialPort kxpaPort(Serial2);
+#endif
+KXPA100Controller kxpa(kxpaPort, RX_PIN, TX_PIN, BAUD_RATE, DELAY_COMM_MS, INVERTED);
+#if SOAK_BENCH
+// One frequency per band, shuffled so most steps change the band filter and antenna
+static const uint32_t SOAK_QSY[] = {
+  7100000UL, 21200000UL, 3600000UL, 28400000UL, 10120000UL, 1850000UL,
+  18100000UL, 50150000UL, 24950000UL, 14250000UL, 5355000UL
+};
+const uint8_t SOAK_QSY_COUNT = sizeof(SOAK_QSY) / sizeof(SOAK_QSY[0]);
+
+// Every periodic parameter on every pass; ^I keeps its period so the budget still fits
+static const KxpaScheduler::ParamConfig SOAK_POLL[] = {
+  // param                           prio  idle  tx
+  {KXPA100Controller::PARAM_SWR,     0,    1,    1},
+  {KXPA100Controller::PARAM_POWER,   0,    1,    1},
+  {KXPA100Controller::PARAM_FAULTS,  1,    1,    1},
+  {KXPA100Controller::PARAM_BAND,    2,    1,    1},
+  {KXPA100Controller::PARAM_TEMP,    4,    1,    1},
+  {KXPA100Controller::PARAM_VOLTAGE, 4,    1,    1}
+};
+
+SweepCatSource catClient(SOAK_QSY, SOAK_QSY_COUNT, SOAK_QSY_MS, SOAK_CAT_REPLY_MS);
+#elif CAT_SOURCE_CIV_BT
+CivBluetoothClient catClient(CIV_BT_DEVICE, CIV_RADIO_ADDR, CIV_CTRL_ADDR, CAT_TIMEOUT_MS);
+#else
+WiFiNetClient catSocket;
+CatWifiClient catClient(catSocket, ssid, password, CAT_SERVER, RIGCTLD_PORT, CAT_TIMEOUT_MS);
+#endif
+Station stationA(0, STATION_COUNT > 1 ? "A" : "", kxpa, catClient, &history);
+
+#if STATION_COUNT > 1
+// The IC-705 Bluetooth link is taken by station A, station B always uses rigctld
+HardwareSerialPort kxpaPort2(Serial1);
+KXPA100Controller kxpa2(kxpaPort2, RX2_PIN, TX2_PIN, BAUD_RATE, DELAY_COMM_MS, INVERTED);
+#if SOAK_BENCH
+SweepCatSource catClient2(SOAK_QSY, SOAK_QSY_COUNT, SOAK_QSY_MS, SOAK_CAT_REPLY_MS);
+#else
+WiFiNetClient catSocket2;
+CatWifiClient catClient2(catSocket2, ssid, password, CAT_SERVER_2, RIGCTLD_PORT_2, CAT_TIMEOUT_MS);
+#endif
+Station stationB(1, "B", kxpa2, catClient2, NULL);
+
+Station* const stations[] = { &stationA, &stationB };
+#else
+Station* const stations[] = { &stationA };
+#endif
+
+uint8_t uiStation = 0;          // shown and controlled on screen
 
-KXPA100Controller kxpa(Serial2, RX_PIN, TX_PIN, BAUD_RATE, DELAY_COMM_MS, INVERTED);
-CatWifiClient cat(ssid, password, CAT_SERVER, RIGCTLD_PORT, CAT_TIMEOUT_MS);
+#if TELEMETRY_UDP
+// Backend task only
+WiFiDatagramSocket telemetrySocket;
+TelemetryPublisher telemetryPublisher(telemetrySocket, TELEMETRY_HOST, TELEMETRY_PORT, TELEMETRY_FORMATS,
+                                      TELEMETRY_MIN_INTERVAL_MS, TELEMETRY_HEARTBEAT_MS);
+#endif
+
+#if WEB_DASHBOARD
+// Own task; browser commands arrive through dashboard.commands()
+WebDashboard dashboard(WEB_PORT);
+#endif
 
 // UI Local Variables
 int uiBandCounter = 0;
 bool uiUpdatingBand = false;
+int uiPendingBand = 0;          // shown until the backend acks the request
+uint32_t uiPendingSeq = 0;
+uint8_t uiPendingStation = 0;
 unsigned long timerDisplay = 0;
 unsigned long timerLastKxpaConnection = 0;
 bool powerOffWarningShown = false;
 
-// Button Repeat Logic
-unsigned long btnRepeatTimer = 0;
-
 // -----------------------------------------------------------------------------------------
 // PROTOTYPES
 // -----------------------------------------------------------------------------------------
 void backendTask(void * pvParameters);
-void drawLeftSprite(const String& band, const String& power, const String& temp, const String& swr, bool catConn);
-void drawRightSprite(const String& antRaw, const String& mode, const String& faults, const String& voltage);
-void showStatusLine(const String& text, int color);
+void inputTask(void * pvParameters);
+void drawLayout();
+void drawMeterLayout();
+void drawMeter(const Telemetry& t);
+void drawMeterHistory(const TelemetryHistory& h);
+void drawMenuBar(MenuBar menu);
+void drawLeftPanel(const char* band, int16_t powerX10, int16_t tempX10, int16_t swrX10, bool catConn);
+void drawRightPanel(int8_t antenna, int8_t mode, const char* faults, int16_t voltageMv);
+void showStatusLine(const char* text, UiColor color);
 void showPowerOffWarning();
-bool checkStringChanged(const String& newVal, const String& oldVal);
+void drawDiagLayout();
+void drawDiag();
+void drawProfileLayout();
+void drawProfile();
+void handleSerialConsole();
+void formatFixed(char* out, size_t len, int16_t value, int16_t scale, uint8_t decimals);
+bool sendCommand(BackendCommand::Type type, int8_t value);
+bool runCommand(Station& s, const BackendCommand& cmd);
+void dispatchCommand(const BackendCommand& cmd);
+bool prepareStation(Station& s, unsigned long now);
+unsigned long stationWait(Station& s, unsigned long now);
+void finishStationPoll(Station& s);
+void protectStation(Station& s, uint16_t answered);
+void restoreStation(Station& s, uint16_t answered);
+void rememberStation(Station& s, uint32_t changed);
+void applyCatBand(Station& s);
+void publishStation(Station& s, uint32_t handledSeq);
+void selectNextStation();
+void runCapture(int8_t action);
+bool startCapture();
+bool saveCapture();
+void captureSaveTask(void * pvParameters);
+void printCapture();
+#if SOAK_BENCH
+void printSoakHeader();
+void printSoakRow();
+#endif
+#if KXPA_REPLAY
+bool loadReplay();
+void replayPumpTask(void * pvParameters);
+#endif
 
 // -----------------------------------------------------------------------------------------
 // SETUP
@@ -142,70 +511,100 @@ void setup() {
   M5.begin(cfg);
   M5.Power.begin();
   
+  // setup() runs in the loop task
+  uiTaskHandle = xTaskGetCurrentTaskHandle();
+  power.setWakeTask(uiTaskHandle);
+  power.begin(millis());
+  
   Serial.begin(BAUD_DEBUG);
   M5.Lcd.setTextSize(2);
   M5.Lcd.setCursor(0, 0);
   M5.Lcd.println("Booting...");
 
-  // Create Mutex for thread safety
-  dataMutex = xSemaphoreCreateMutex();
-  if (dataMutex == NULL) {
-    Serial.println("FATAL: Failed to create mutex");
-    while(1) delay(1000); // Halt
+  // Saved tuning first, the pins stay compile-time
+  settings.begin();
+  const SettingsStore::Tuning& tune = settings.tuning();
+  catPollMs = tune.catPollMs;
+#if SOAK_BENCH
+  catPollMs = 0;      // next query as soon as the last reply is in
+  printSoakHeader();
+#endif
+  CatWifiClient::setWifiCache(settings.wifiCache(), WIFI_REUSE_IP);
+
+  // Formats an empty partition here rather than on the first "cap save"
+  spiffsMounted = SPIFFS.begin(true);
+  if (!spiffsMounted) {
+    Serial.println("SPIFFS not available, no frame capture files");
+  }
+
+#if KXPA_REPLAY
+  if (!loadReplay()) {
+    Serial.println("KXPA replay: no capture in " FRAME_LOG_PATH);
   }
+#endif
+#if FRAME_LOG_AT_BOOT
+  startCapture();     // before the backend exists, afterwards it owns the log
+#endif
 
-  // Initialize Hardware
-  kxpa.begin();
-  cat.begin();
+  // Initialize Hardware: WiFi associates and the amps are probed by the
+  // backend while the UI already shows the saved state, nothing waits here
+  for (Station* s : stations) {
+    const SettingsStore::StationState& saved = settings.station(s->index);
+    s->kxpa.setLink(tune.baud, tune.delayCommMs);
+    s->kxpa.setAntennaMask(tune.ant2Mask);
+    s->selector.setTiming(tune.bandDwellMs);
+    s->cat.preferEndpoint(saved.catHost, saved.catPort);
+    s->kxpa.setFrameLog(&frameLog, s->index);
+#if SOAK_BENCH
+    for (const KxpaScheduler::ParamConfig& c : SOAK_POLL) {
+      s->scheduler.configure(c.param, c.priority, c.periodMs, c.txPeriodMs);
+    }
+#endif
+    s->cat.setFrameLog(&frameLog, s->index);
+    if (saved.band >= MIN_POS && saved.band <= MAX_POS) {
+      s->restoreBand = saved.band;
+    }
+    if (saved.mode >= KXPA100Controller::MODE_BYPASS && saved.mode <= KXPA100Controller::MODE_AUTO) {
+      s->restoreMode = saved.mode;
+    }
+    
+    s->kxpa.begin();
+    s->cat.begin();
+    
+    s->published.bandIndex = s->restoreBand;
+    s->published.antenna = s->kxpa.getAntennaCmd(s->restoreBand)[3] - '0';
+    s->published.mode = s->restoreMode;
+    s->telemetry.publish(s->published);
+  }
+
+#if KXPA_REPLAY
+  // Stands in for the UART event task of station A, above the backend
+  xTaskCreatePinnedToCore(replayPumpTask, "ReplayPump", REPLAY_PUMP_STACK_SIZE, NULL, 2, NULL, 0);
+#endif
 
   // Initialize Sprites
-  img0.setColorDepth(8); 
-  img0.createSprite(IMG0_WIDTH, IMG0_HEIGHT); 
-  img0.fillSprite(WHITE);
-  
-  img1.setColorDepth(8); 
-  img1.setTextSize(1); 
-  img1.createSprite(IMG1_WIDTH, IMG1_HEIGHT); 
-  img1.fillSprite(WHITE);
+  createUiCanvas(barCanvas, IMG0_WIDTH, IMG0_HEIGHT);
+  barCanvas.fillSprite(UI_WHITE);
   
-  img1a.setColorDepth(8); 
-  img1a.createSprite(IMG1a_WIDTH, IMG1a_HEIGHT); 
-  img1a.fillSprite(WHITE);
+  dma.begin();
+  for (UiField* field : valueFields) {
+    field->begin(UI_WHITE, &dma);
+  }
+  meterPowerField.begin(UI_WHITE, &dma);
+  meterSwrField.begin(UI_WHITE, &dma);
   
-  img2.setColorDepth(8); 
-  img2.setFont(&fonts::FreeSans12pt7b); 
-  img2.createSprite(IMG2_WIDTH, IMG2_HEIGHT);
   
   // Initial Push
-  img0.pushSprite(0, 0);
-  img1.pushSprite(0, 30);
-  img1a.pushSprite(160, 30);
-  img2.pushSprite(0, 211);
-  
-  // Initial wait for KXPA (with timeout)
-  Serial.println("Waiting for KXPA100...");
-  unsigned long startWait = millis();
-  while (!kxpa.checkConnection() && millis() - startWait < 5000) { 
-    delay(100); 
-  }
-  
-  if (kxpa.checkConnection()) {
-    Serial.println("KXPA100 connected");
-    // Initial Settings
-    kxpa.setBand(5);  // Start at 20m
-    kxpa.setMode("^MDA;");  // Automatic mode
-  } else {
-    Serial.println("KXPA100 not detected - will retry");
-  }
+  M5.Lcd.fillRect(0, 0, IMG0_WIDTH, M5.Lcd.height(), WHITE);
   
   // Start Backend Task on Core 0
   BaseType_t taskCreated = xTaskCreatePinnedToCore(
     backendTask,   // Function
     "BackendTask", // Name
-    8192,          // Stack size
+    BACKEND_STACK_SIZE, // Stack size
     NULL,          // Params
     1,             // Priority
-    NULL,          // Handle
+    &backendTaskHandle, // Handle (for command notifications)
     0              // Core ID (0)
   );
   
@@ -214,158 +613,453 @@ void setup() {
     while(1) delay(1000); // Halt
   }
 
+#if WEB_DASHBOARD
+  // Browser commands wake the backend like button presses
+  for (Station* s : stations) {
+    dashboard.attach(s->index, s->label, s->webTelemetry);
+  }
+  dashboard.begin(backendTaskHandle, EVT_COMMAND);
+#endif
+
+  // Button scanning on Core 1 above loop(), so redraws never delay it
+  taskCreated = xTaskCreatePinnedToCore(
+    inputTask,     // Function
+    "InputTask",   // Name
+    INPUT_STACK_SIZE, // Stack size
+    NULL,          // Params
+    2,             // Priority (above loop)
+    &inputTaskHandle, // Handle (profiling)
+    1              // Core ID (1)
+  );
+  
+  if (taskCreated != pdPASS) {
+    Serial.println("FATAL: Failed to create input task");
+    while(1) delay(1000); // Halt
+  }
+
+  // Flash writes of "cap save", below the UI so they only take its idle time
+  taskCreated = xTaskCreatePinnedToCore(
+    captureSaveTask, // Function
+    "CaptureSave", // Name
+    CAPTURE_SAVE_STACK_SIZE, // Stack size
+    NULL,          // Params
+    0,             // Priority (idle, below loop)
+    &captureSaveTaskHandle, // Handle (cap save)
+    1              // Core ID (1)
+  );
+  if (taskCreated != pdPASS) {
+    Serial.println("Capture: no task for cap save");
+  }
+
+  // Stack sizes for the profiling page, the system tasks only report what is left
+  TaskProfiler::watch(uiTaskHandle, CONFIG_ARDUINO_LOOP_STACK_SIZE, 1);
+  TaskProfiler::watch(backendTaskHandle, BACKEND_STACK_SIZE, 0);
+  TaskProfiler::watch(inputTaskHandle, INPUT_STACK_SIZE, 1);
+  TaskProfiler::watch(captureSaveTaskHandle, CAPTURE_SAVE_STACK_SIZE, 1);
+#if WEB_DASHBOARD
+  TaskProfiler::watch(dashboard.task(), WebDashboard::TASK_STACK, 0);
+#endif
+
   timerDisplay = millis();
   timerLastKxpaConnection = millis();
 }
 
+// -----------------------------------------------------------------------------------------
+// INPUT TASK (Core 1)
+// Scans the buttons every INPUT_SCAN_MS and generates press/repeat events
+// -----------------------------------------------------------------------------------------
+void inputTask(void * pvParameters) {
+  typedef decltype(M5.BtnA) Button;
+  Button* const buttons[InputEvent::BUTTON_COUNT] = { &M5.BtnA, &M5.BtnB, &M5.BtnC };
+  unsigned long repeatAt[InputEvent::BUTTON_COUNT] = { 0 };
+  bool comboHeld = false;
+  bool comboLong = false;
+  unsigned long comboSince = 0;
+  TickType_t lastWake = xTaskGetTickCount();
+
+  while (true) {
+    M5.update();
+    unsigned long now = millis();
+
+    // BtnA+BtnC: one COMBO_AC event, and no auto-repeat while both are held
+    bool combo = M5.BtnA.isPressed() && M5.BtnC.isPressed();
+    if (combo && !comboHeld) {
+      InputEvent ev;
+      ev.type = InputEvent::COMBO_AC;
+      ev.button = InputEvent::BTN_A;
+      if (!inputQueue.push(ev)) {
+        Serial.println("Input queue full");
+      }
+      xTaskNotifyGive(uiTaskHandle);
+      comboSince = now;
+      comboLong = false;
+    }
+    // ... held on: one HOLD_AC, the hidden way to the profiling page
+    if (combo && !comboLong && now - comboSince >= PROFILE_HOLD_MS) {
+      InputEvent ev;
+      ev.type = InputEvent::HOLD_AC;
+      ev.button = InputEvent::BTN_A;
+      if (!inputQueue.push(ev)) {
+        Serial.println("Input queue full");
+      }
+      xTaskNotifyGive(uiTaskHandle);
+      comboLong = true;
+    }
+    comboHeld = combo;
+
+    for (uint8_t i = 0; i < InputEvent::BUTTON_COUNT; ++i) {
+      InputEvent ev;
+      ev.button = (InputEvent::Button)i;
+
+      if (buttons[i]->wasPressed()) {
+        ev.type = InputEvent::PRESS;
+        repeatAt[i] = now + BTN_REPEAT_DELAY_INITIAL_MS;
+      } else if (i != InputEvent::BTN_B && !combo && buttons[i]->isPressed() &&
+                 (long)(now - repeatAt[i]) >= 0) {
+        ev.type = InputEvent::REPEAT;
+        repeatAt[i] += BTN_REPEAT_RATE_MS;   // fixed cadence, no drift
+      } else {
+        continue;
+      }
+
+      if (!inputQueue.push(ev)) {
+        Serial.println("Input queue full");
+      }
+      xTaskNotifyGive(uiTaskHandle);
+    }
+
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(power.idle() ? INPUT_IDLE_SCAN_MS : INPUT_SCAN_MS));
+  }
+}
+
 // -----------------------------------------------------------------------------------------
 // BACKEND TASK (Core 0)
 // Handles WiFi, CAT, and Serial Comm
 // -----------------------------------------------------------------------------------------
 void backendTask(void * pvParameters) {
-  int currentBandIdx = 0;
-  unsigned long lastPoll = 0;
+  bool powerSave = false;
+  uint32_t handledSeq = 0;
+
+  // Everything that can have work for us wakes this task directly
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  for (Station* s : stations) {
+    s->kxpa.setFrameNotify(self, EVT_KXPA);
+    s->cat.setNotify(self, EVT_CAT);
+  }
 
   while (true) {
+    TaskProfiler::Scope pass(TaskProfiler::LOOP_BACKEND);
     unsigned long now = millis();
     
-    // Update CAT client state machine (non-blocking)
-    cat.update();
+    // Follow the power level: modem sleep, and slower polls while an amp is in standby
+    bool powerChanged = power.idle() != powerSave;
+    powerSave = power.idle();
     
-    // Poll at reduced rate to save power
-    if (now - lastPoll < BACKEND_POLL_MS) {
-      vTaskDelay(pdMS_TO_TICKS(10));
-      continue;
+    for (Station* s : stations) {
+      if (powerChanged) {
+        s->cat.setPowerSave(powerSave);
+      }
+      bool standby = s->status.connected && s->status.mode == KXPA100Controller::MODE_BYPASS;
+      s->scheduler.setBackoff(powerSave && standby ? POWER_POLL_BACKOFF : 1);
+      
+      // Deliver unsolicited KXPA frames, expire stale requests
+      s->kxpa.service();
+      
+      // Update CAT client state machine (non-blocking)
+      s->cat.update();
+      
+      s->manualReq = false;
+      s->justSwitched = false;
+      s->bandKnown = false;
     }
-    lastPoll = now;
     
-    // 1. Handle Manual Band Change Request from UI
-    bool manualReq = false;
-    int target = 0;
+    // 1. Commands from the UI run first and preempt any scheduled poll
+    BackendCommand cmd;
+    
+    while (commandQueue.pop(cmd)) {
+      dispatchCommand(cmd);
+      handledSeq = cmd.seq;
+    }
+#if WEB_DASHBOARD
+    // Browser commands carry no UI sequence number, the ack stays with the buttons
+    while (dashboard.commands().pop(cmd)) {
+      dispatchCommand(cmd);
+    }
+#endif
     
-    if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-      if (sharedState.manualChangeReq) {
-        manualReq = true;
-        target = sharedState.manualTargetBand;
-        sharedState.manualChangeReq = false;
+    // 2. + 3. CAT queries, then: anything to do? Otherwise sleep until the next timer or event
+    bool work = false;
+    unsigned long wait = ULONG_MAX;
+    for (Station* s : stations) {
+      if (prepareStation(*s, now)) {
+        work = true;
+      } else {
+        wait = min(wait, stationWait(*s, now));
       }
-      xSemaphoreGive(dataMutex);
-    }
-
-    // Local vars for this iteration - pre-reserve to avoid fragmentation
-    String p_bandName, p_power, p_temp, p_swr;
-    String p_ant, p_mode, p_fault, p_volt;
-    p_bandName.reserve(8);
-    p_power.reserve(8);
-    p_temp.reserve(8);
-    p_swr.reserve(8);
-    p_ant.reserve(16);
-    p_mode.reserve(16);
-    p_fault.reserve(16);
-    p_volt.reserve(8);
+    }
     
-    bool justSwitched = false;
-
-    if (manualReq) {
-      kxpa.setBand(target);
-      currentBandIdx = target;
-      p_bandName = kxpa.getBandName(target);
-      justSwitched = true; 
+#if TELEMETRY_UDP
+    // Queued datagrams go out between CAT queries, never while one waits for its reply
+    bool catBusy = false;
+    for (Station* s : stations) {
+      catBusy = catBusy || s->cat.requestPending();
     }
-
-    // 2. Poll KXPA Status
-    bool kxpaOk = kxpa.checkConnection();
+    telemetryPublisher.update(now, WiFi.status() == WL_CONNECTED, catBusy);
+    wait = min(wait, telemetryPublisher.msUntilWork(now));
+#endif
     
-    if (kxpaOk) {
-      if (!justSwitched) {
-        int newBand = kxpa.getBand();
-        if (newBand >= 0) {  // Check for error
-          currentBandIdx = newBand;
-          p_bandName = kxpa.getBandName(currentBandIdx);
-        }
+    // Settled state changes go to flash (a few ms, only after SAVE_DELAY_MS without changes)
+    WifiCache association;
+    if (CatWifiClient::takeWifiCache(association)) {
+      settings.setWifiCache(association, now);
+    }
+    settings.update(now);
+    wait = min(wait, settings.msUntilSave(now));
+    
+    if (!work) {
+      // Any bit just means "look again"
+      uint32_t events = 0;
+      pass.end();
+      xTaskNotifyWait(0, 0xFFFFFFFF, &events, wait == ULONG_MAX ? portMAX_DELAY : pdMS_TO_TICKS(wait));
+      continue;
+    }
+
+    // 4. KXPA status polls: every due station sends its queries before any
+    // replies are collected, so the amps answer in parallel on their own UARTs
+    for (Station* s : stations) {
+      if (s->pollDue) {
+        s->kxpa.startPoll(s->status, s->plan.params, s->plan.count);
       }
-      
-      // Read other values
-      p_power = kxpa.getPower();
-      p_temp  = kxpa.getTemperature();
-      p_swr   = kxpa.getSWR();
-      p_ant   = kxpa.getAntenna();
-      p_mode  = kxpa.getMode();
-      p_fault = kxpa.getFaultCodes();
-      p_volt  = kxpa.getVoltage();
-    }
-
-    // 3. Handle CAT Control (only if not doing manual override)
-    bool catOk = cat.isConnected();
-    if (catOk && !manualReq) {
-      String freqStr = cat.sendCommand(CAT_COMMAND);
-      if (freqStr.length() > 0) {
-        long freq = freqStr.toInt();
-        int newIdx = kxpa.getBandIndexByFrequency(freq);
-        
-        if (newIdx >= MIN_POS && newIdx <= MAX_POS && newIdx != currentBandIdx) {
-          kxpa.setBand(newIdx);
-          currentBandIdx = newIdx;
-          p_bandName = kxpa.getBandName(currentBandIdx);
-        }
+    }
+    for (Station* s : stations) {
+      if (s->pollDue) {
+        finishStationPoll(*s);
       }
     }
 
-    // 4. Update Shared State with Dirty Flags
-    if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-      bool connChanged = (sharedState.kxpaConnected != kxpaOk) || 
-                        (sharedState.catConnected != catOk);
-      
-      sharedState.kxpaConnected = kxpaOk;
-      sharedState.catConnected = catOk;
-      
-      // Only update if not racing with a new manual request
-      if (!sharedState.manualChangeReq) {
-        if (sharedState.bandIndex != currentBandIdx || sharedState.bandName != p_bandName) {
-          sharedState.bandIndex = currentBandIdx;
-          sharedState.bandName = p_bandName;
-          sharedState.bandDirty = true;
-        }
-      }
+    // 5. CAT band switches, then publish a new snapshot if anything changed
+    for (Station* s : stations) {
+      applyCatBand(*s);
+      publishStation(*s, handledSeq);
+    }
+    // No sleep here, the next pass computes how long there is nothing to do
+  }
+}
 
-      // Set dirty flags for changed values
-      if (sharedState.power != p_power) {
-        sharedState.power = p_power;
-        sharedState.powerDirty = true;
-      }
-      if (sharedState.temp != p_temp) {
-        sharedState.temp = p_temp;
-        sharedState.tempDirty = true;
-      }
-      if (sharedState.swr != p_swr) {
-        sharedState.swr = p_swr;
-        sharedState.swrDirty = true;
-      }
-      if (sharedState.antenna != p_ant) {
-        sharedState.antenna = p_ant;
-        sharedState.antennaDirty = true;
-      }
-      if (sharedState.mode != p_mode) {
-        sharedState.mode = p_mode;
-        sharedState.modeDirty = true;
-      }
-      if (sharedState.faults != p_fault) {
-        sharedState.faults = p_fault;
-        sharedState.faultsDirty = true;
-      }
-      if (sharedState.voltage != p_volt) {
-        sharedState.voltage = p_volt;
-        sharedState.voltageDirty = true;
-      }
-      
-      if (connChanged) {
-        sharedState.connectionDirty = true;
-      }
-      
-      xSemaphoreGive(dataMutex);
+// CAT query and frequency of one station; true if it has work in this pass
+bool prepareStation(Station& s, unsigned long now) {
+  // CAT: queue the next query, replies are collected by cat.update()
+  s.catOk = s.cat.isConnected();
+  bool catPollDue = !s.cat.needsPolling() || now - s.lastCatPoll >= catPollMs;
+  if (s.catOk && catPollDue && s.cat.requestFrequency()) {
+    s.lastCatPoll = now;
+  }
+  
+  uint32_t catFreq = 0;
+  s.freqNew = s.cat.takeFrequency(catFreq) && !s.manualReq;
+  if (s.freqNew) {
+    s.selector.feed(catFreq, now);
+    if (catFreq != s.lastCatFreq) {
+      s.lastCatFreq = catFreq;
+      power.activity(now);    // the operator is tuning
+    }
+  }
+  if (s.manualReq) {
+    power.activity(now);
+  }
+  if (!s.catOk || s.manualReq) {
+    s.selector.reset();   // manual selection wins over a pending CAT band
+  }
+  if (s.selector.pending() && s.catBandSinceUs == 0) {
+    s.catBandSinceUs = esp_timer_get_time();
+  }
+  
+  s.pollDue = s.scheduler.plan(now, s.plan);
+  bool linkChanged = s.catOk != s.published.catConnected;
+  
+  return s.manualReq || s.freqNew || s.pollDue || linkChanged ||
+         s.selector.msUntilDecision(now) == 0;
+}
+
+// How long a station without work can be left alone, ULONG_MAX = until notified
+unsigned long stationWait(Station& s, unsigned long now) {
+  unsigned long wait = min(s.scheduler.msUntilDue(now), s.selector.msUntilDecision(now));
+  wait = min(wait, s.cat.msUntilWork(now));
+  if (s.catOk && s.cat.needsPolling()) {
+    unsigned long sincePoll = now - s.lastCatPoll;
+    wait = min(wait, sincePoll >= catPollMs ? 0UL : catPollMs - sincePoll);
+  }
+  if (!s.kxpa.idle()) {
+    wait = min(wait, (unsigned long)KXPA_SERVICE_MS);
+  }
+  return wait;
+}
+
+// Collect the replies of a poll started in this pass
+void finishStationPoll(Station& s) {
+  s.kxpa.finishPoll();
+  uint16_t missing = s.kxpa.lastPollMissing();
+  uint16_t answered = s.kxpa.lastPollMask() & ~missing;
+  protectStation(s, answered);
+  bool bandPolled = answered & (1 << KXPA100Controller::PARAM_BAND);
+  
+  if (s.status.connected && s.history != NULL) {
+    s.history->appendStatus(s.status, answered, millis());
+  }
+  
+  s.scheduler.complete(s.plan, missing, millis());
+  s.scheduler.setTransmitting(s.status.connected && s.status.powerX10 > 0);
+  
+  if (s.status.connected && bandPolled && !s.justSwitched && s.status.band >= 0) {  // Check for error
+    s.currentBandIdx = s.status.band;
+    s.bandKnown = true;
+  }
+  restoreStation(s, answered);
+}
+
+// Limits first: a trip sends ^MDB; before any other command of this pass
+void protectStation(Station& s, uint16_t answered) {
+  ProtectionEngine::Trip trip = s.protection.check(s.status, answered);
+  if (trip == ProtectionEngine::TRIP_NONE || s.status.mode == KXPA100Controller::MODE_BYPASS) {
+    return;
+  }
+  
+  bool ok = s.kxpa.setMode(KXPA100Controller::MODE_BYPASS);
+  s.protection.record(trip, ok);
+  LatencyStats::count(LatencyStats::C_PROTECT_TRIP);
+  s.scheduler.invalidate(1 << KXPA100Controller::PARAM_MODE);
+  if (ok) {
+    s.status.mode = KXPA100Controller::MODE_BYPASS;
+  }
+  
+  char reason[40];
+  s.protection.describe(trip, s.status, reason, sizeof(reason));
+  Serial.print(s.label);
+  Serial.print(s.label[0] != '\0' ? ": " : "");
+  Serial.print("PROTECT ");
+  Serial.print(reason);
+  Serial.println(ok ? " -> bypass" : " -> bypass FAILED");
+}
+
+// Warm start, once per boot: bring the amp to the saved band and mode, but only
+// write what differs. CAT, a command or a protection trip since boot wins.
+void restoreStation(Station& s, uint16_t answered) {
+  const uint16_t needed = (1 << KXPA100Controller::PARAM_BAND) | (1 << KXPA100Controller::PARAM_MODE);
+  if (!s.restorePending || !s.status.connected) {
+    return;
+  }
+  s.restoreSeen |= answered;
+  if ((s.restoreSeen & needed) != needed) {
+    return;
+  }
+  s.restorePending = false;
+  
+  bool bandOk = true;
+  bool modeOk = true;
+  bool bandSent = s.lastCatFreq == 0 && !s.justSwitched && s.status.band != s.restoreBand;
+  if (bandSent) {
+    bandOk = s.kxpa.setBand(s.restoreBand);
+    s.scheduler.invalidate((1 << KXPA100Controller::PARAM_ANTENNA) |
+                           (1 << KXPA100Controller::PARAM_MODE) |
+                           (bandOk ? 0 : 1 << KXPA100Controller::PARAM_BAND));
+    if (bandOk) {
+      s.currentBandIdx = s.restoreBand;
+      s.bandKnown = true;
+    }
+  }
+  bool modeSent = s.protection.trips() == 0 && s.status.mode != KXPA100Controller::MODE_UNKNOWN &&
+                  s.status.mode != s.restoreMode;
+  if (modeSent) {
+    s.scheduler.invalidate(1 << KXPA100Controller::PARAM_MODE);
+    modeOk = s.kxpa.setMode((KXPA100Controller::Mode)s.restoreMode);
+    if (modeOk) {
+      s.status.mode = s.restoreMode;
     }
+  }
+  
+  Serial.print(s.label);
+  Serial.print(s.label[0] != '\0' ? ": " : "");
+  Serial.print("KXPA100 connected, band ");
+  Serial.print(bandSent ? (bandOk ? "restored" : "restore FAILED") : "kept");
+  Serial.print(", mode ");
+  Serial.println(modeSent ? (modeOk ? "restored" : "restore FAILED") : "kept");
+}
 
-    vTaskDelay(pdMS_TO_TICKS(10));
+// Apply the CAT band once it has settled; skipped if the amp is already there
+void applyCatBand(Station& s) {
+  s.selector.setCurrent(s.currentBandIdx);
+  int newIdx;
+  if (!s.manualReq && s.selector.decide(millis(), newIdx) &&
+      newIdx >= MIN_POS && newIdx <= MAX_POS && newIdx != s.currentBandIdx) {
+    bool ok = s.kxpa.setBand(newIdx);
+    s.currentBandIdx = newIdx;
+    s.bandKnown = true;
+    s.selector.setCurrent(newIdx);
+    s.scheduler.invalidate((1 << KXPA100Controller::PARAM_ANTENNA) |
+                           (1 << KXPA100Controller::PARAM_MODE) |
+                           (ok ? 0 : 1 << KXPA100Controller::PARAM_BAND));
+    if (s.catBandSinceUs != 0) {
+      LatencyStats::record(LatencyStats::T_CAT_BAND, (uint32_t)(esp_timer_get_time() - s.catBandSinceUs));
+    }
+  }
+  if (!s.selector.pending()) {
+    s.catBandSinceUs = 0;     // switched, dropped, or the amp got there on its own
+  }
+}
+
+// Publish the station's snapshot if anything changed
+void publishStation(Station& s, uint32_t handledSeq) {
+  bool kxpaOk = s.status.connected;
+  Telemetry next = s.published;
+  next.kxpaConnected = kxpaOk;
+  next.catConnected = s.catOk;
+  next.commandAck = handledSeq;
+  
+  if (s.bandKnown) {
+    next.bandIndex = s.currentBandIdx;
+  }
+  
+  // Values are only valid if polled
+  if (kxpaOk) {
+    next.powerX10 = s.status.powerX10;
+    next.tempX10 = s.status.tempX10;
+    next.swrX10 = s.status.swrX10;
+    next.antenna = s.status.antenna;
+    next.mode = s.status.mode;
+    strcpy(next.faults, s.status.faults);
+    next.voltageMv = s.status.voltageMv;
+  }
+  
+  uint32_t changed = diffTelemetry(s.published, next);
+  if (changed || next.commandAck != s.published.commandAck) {
+    s.published = next;
+    s.telemetry.publish(s.published);
+    s.dirty.fetch_or(changed, std::memory_order_release);
+    xTaskNotifyGive(uiTaskHandle);
+#if TELEMETRY_UDP
+    telemetryPublisher.offer(s.index, s.published, changed);
+#endif
+    rememberStation(s, changed);
+#if WEB_DASHBOARD
+    s.webTelemetry.publish(s.published);
+    dashboard.notify();
+#endif
+    
+    // Temperature and voltage drift on their own, they don't keep the station awake
+    if (changed & ~(DIRTY_TEMP | DIRTY_VOLTAGE)) {
+      power.activity(millis());
+    }
+  }
+}
+
+// Hand what the next boot should start from to the NVS store (saved once it settles)
+void rememberStation(Station& s, uint32_t changed) {
+  const Telemetry& t = s.published;
+  if ((changed & (DIRTY_BAND | DIRTY_CONNECTION)) && t.kxpaConnected && t.bandIndex >= 0) {
+    settings.setBand(s.index, t.bandIndex, millis());
+  }
+  if ((changed & DIRTY_CONNECTION) && t.catConnected && s.cat.endpointHost() != NULL) {
+    settings.setCatEndpoint(s.index, s.cat.endpointHost(), s.cat.endpointPort(), millis());
   }
 }
 
@@ -374,41 +1068,37 @@ void backendTask(void * pvParameters) {
 // Handles UI and Buttons
 // -----------------------------------------------------------------------------------------
 void loop() {
-  M5.update();
+  // Sleep until the next frame, input or new telemetry wake us earlier
+#if SOAK_BENCH
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SOAK_UI_WAIT_MS));
+#else
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(power.idle() ? UI_IDLE_WAIT_MS : UI_ACTIVE_WAIT_MS));
+#endif
+  TaskProfiler::Scope pass(TaskProfiler::LOOP_UI);
   
-  // --- Local Data Copies ---
-  bool s_kxpaConn = false;
-  bool s_catConn = false;
-  int s_bandIdx = 0;
-  String s_bandName, s_pwr, s_temp, s_swr, s_ant, s_mode, s_fault, s_volt;
-  bool anyDirty = false;
-
-  // Read Shared Data safely
-  if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-    s_kxpaConn = sharedState.kxpaConnected;
-    s_catConn = sharedState.catConnected;
-    s_bandIdx = sharedState.bandIndex;
-    s_bandName = sharedState.bandName;
-    s_pwr = sharedState.power;
-    s_temp = sharedState.temp;
-    s_swr = sharedState.swr;
-    s_ant = sharedState.antenna;
-    s_mode = sharedState.mode;
-    s_fault = sharedState.faults;
-    s_volt = sharedState.voltage;
-    
-    // Check if anything is dirty
-    anyDirty = sharedState.bandDirty || sharedState.powerDirty || 
-               sharedState.tempDirty || sharedState.swrDirty ||
-               sharedState.antennaDirty || sharedState.modeDirty ||
-               sharedState.faultsDirty || sharedState.voltageDirty ||
-               sharedState.connectionDirty;
-    
-    xSemaphoreGive(dataMutex);
+  // Release the bus once the last DMA transfer is done (non-blocking)
+  dma.poll();
+  
+  // --- Latest Snapshots (wait-free, stay valid for this iteration) ---
+  Station& st = *stations[uiStation];
+  uint32_t dirty = st.dirty.exchange(0, std::memory_order_acquire);
+  bool anyKxpaConn = false;
+  for (Station* s : stations) {
+    s->telemetry.update();
+    anyKxpaConn = anyKxpaConn || s->telemetry.front().kxpaConnected;
   }
+  const Telemetry& t = st.telemetry.front();
+
+  bool s_kxpaConn = t.kxpaConnected;
+  bool s_catConn = t.catConnected;
+  bool anyDirty = dirty != 0;
 
-  // --- POWER OFF LOGIC with Warning ---
-  if (s_kxpaConn) {
+  // Hold the optimistic band until the backend has applied the request
+  bool bandPending = uiPendingStation == uiStation && (int32_t)(t.commandAck - uiPendingSeq) < 0;
+  int s_bandIdx = bandPending ? uiPendingBand : t.bandIndex;
+
+  // --- POWER OFF LOGIC with Warning (only once every station has lost its amp) ---
+  if (anyKxpaConn) {
     timerLastKxpaConnection = millis();
     powerOffWarningShown = false;
   }
@@ -423,11 +1113,11 @@ void loop() {
   
   // Power off at 30 seconds (unless button pressed to abort)
   if (disconnectTime > POWEROFF_TIMEOUT_MS) {
-    M5.update();
     if (M5.BtnA.isPressed() || M5.BtnB.isPressed() || M5.BtnC.isPressed()) {
       Serial.println("Power-off aborted by user");
       timerLastKxpaConnection = millis(); // Reset timer
       powerOffWarningShown = false;
+      uiView = VIEW_NONE;                 // clear the warning on the next refresh
     } else {
       Serial.println("KXPA timeout: Powering off.");
       M5.Lcd.fillScreen(BLACK);
@@ -439,55 +1129,82 @@ void loop() {
   }
 
   // --- Sync & UI Logic ---
-  if (!uiUpdatingBand) {
+  if (!uiUpdatingBand && s_bandIdx >= 0) {
     uiBandCounter = s_bandIdx;
   }
 
-  // --- Button Handling (Non-Blocking) ---
+  // --- Button Handling (events from inputTask, repeat timing is done there) ---
   bool manualAction = false;
+  InputEvent input;
 
-  if (!s_catConn) {
-    // Check Btn A (Up)
-    if (M5.BtnA.wasPressed()) {
-       if (uiBandCounter < MAX_POS) uiBandCounter++;
-       btnRepeatTimer = millis() + BTN_REPEAT_DELAY_INITIAL_MS;
-       manualAction = true;
-    } else if (M5.BtnA.isPressed() && millis() > btnRepeatTimer) {
-       if (uiBandCounter < MAX_POS) uiBandCounter++;
-       btnRepeatTimer = millis() + BTN_REPEAT_RATE_MS;
-       manualAction = true;
-    }
-
-    // Check Btn C (Down)
-    if (M5.BtnC.wasPressed()) {
-       if (uiBandCounter > MIN_POS) uiBandCounter--;
-       btnRepeatTimer = millis() + BTN_REPEAT_DELAY_INITIAL_MS;
-       manualAction = true;
-    } else if (M5.BtnC.isPressed() && millis() > btnRepeatTimer) {
-       if (uiBandCounter > MIN_POS) uiBandCounter--;
-       btnRepeatTimer = millis() + BTN_REPEAT_RATE_MS;
-       manualAction = true;
+  while (inputQueue.pop(input)) {
+    // The first press in the idle profile only wakes the station
+    bool asleep = power.idle();
+    power.activity(millis());
+    if (asleep) {
+      continue;
     }
     
-    // Check Btn B (OK/Set)
-    if (M5.BtnB.wasPressed()) {
-      if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-        sharedState.manualTargetBand = uiBandCounter;
-        sharedState.manualChangeReq = true;
-        
-        // Optimistic update
-        sharedState.bandIndex = uiBandCounter;
-        sharedState.bandName = kxpa.getBandName(uiBandCounter);
-        sharedState.bandDirty = true;
-        
-        xSemaphoreGive(dataMutex);
-      }
-      
-      s_bandIdx = uiBandCounter;
-      s_bandName = kxpa.getBandName(uiBandCounter);
-      
+    if (input.type == InputEvent::COMBO_AC) {
+      // The presses that formed the combo must not leave a band edit behind
+      selectNextStation();
+      manualAction = false;
+      continue;
+    }
+    
+    if (input.type == InputEvent::HOLD_AC) {
+      // Opens only, a second hold would start with presses that close it
+      uiProfileShown = true;
       uiUpdatingBand = false;
+      manualAction = false;
       timerDisplay = 0;
+      continue;
+    }
+    
+    if (uiDiagShown || uiProfileShown) {
+      if (input.type == InputEvent::PRESS) {
+        uiDiagShown = false;
+        uiProfileShown = false;
+        timerDisplay = 0;
+      }
+      continue;
+    }
+    
+    if (s_catConn) {
+      // CAT mode: Btn B toggles the meter view
+      if (input.button == InputEvent::BTN_B) {
+        uiMeterPinned = !uiMeterPinned;
+        timerDisplay = 0;
+      }
+      continue;
+    }
+
+    switch (input.button) {
+      case InputEvent::BTN_A:   // Up
+        if (uiBandCounter < MAX_POS) uiBandCounter++;
+        manualAction = true;
+        break;
+
+      case InputEvent::BTN_C:   // Down
+        if (uiBandCounter > MIN_POS) uiBandCounter--;
+        manualAction = true;
+        break;
+
+      case InputEvent::BTN_B:   // OK/Set
+        if (sendCommand(BackendCommand::SET_BAND, uiBandCounter)) {
+          // Optimistic update
+          uiPendingSeq = uiCommandSeq;
+          uiPendingBand = uiBandCounter;
+          uiPendingStation = uiStation;
+          s_bandIdx = uiBandCounter;
+        }
+        uiUpdatingBand = false;
+        manualAction = false;
+        timerDisplay = 0;
+        break;
+
+      default:
+        break;
     }
   }
 
@@ -496,63 +1213,121 @@ void loop() {
     timerDisplay = 0; 
   }
 
+  // --- Power Level: backlight and CPU clock here, the backend follows ---
+  if (power.update(millis())) {
+    xTaskNotify(backendTaskHandle, EVT_POWER, eSetBits);
+    timerDisplay = 0;
+  }
+
+  // --- View Selection: meter while pinned or (shortly after) transmitting ---
+  if (t.kxpaConnected && t.powerX10 > 0) {
+    timerLastTx = millis();
+  }
+  bool txRecent = METER_AUTO_TX && timerLastTx != 0 && millis() - timerLastTx < METER_HOLD_MS;
+  UiView wantView = (uiMeterPinned || txRecent) && !uiUpdatingBand ? VIEW_METER : VIEW_VALUES;
+  handleSerialConsole();
+  if (uiProfileShown) {
+    wantView = VIEW_PROFILE;
+  } else if (uiDiagShown) {
+    wantView = VIEW_DIAG;
+  }
+
+#if SOAK_BENCH
+  // --- Soak Report: before the frame is timed, the sample suspends the scheduler ---
+  static unsigned long timerSoak = 0;
+  if (millis() - timerSoak >= SOAK_REPORT_MS) {
+    timerSoak = millis();
+    printSoakRow();
+  }
+#endif
+
   // --- Display Update Logic (with Dirty Flags) ---
-  bool forceUpdate = (millis() - timerDisplay > DISPLAY_UPDATE_MS) || (timerDisplay == 0);
+  unsigned long displayPeriod = power.idle() ? DISPLAY_IDLE_UPDATE_MS : DISPLAY_UPDATE_MS;
+  bool forceUpdate = SOAK_BENCH || (millis() - timerDisplay > displayPeriod) || (timerDisplay == 0);
+  
+  // One frame = everything drawn from here on in this pass
+  LatencyStats::Scope frame(LatencyStats::T_RENDER_FRAME);
+  bool drawn = forceUpdate || anyDirty;
   
   if (forceUpdate || anyDirty) {
     timerDisplay = millis();
 
-    if (!s_kxpaConn) {
-      showStatusLine("No KXPA100", RED);
-      img1.fillSprite(WHITE); img1.pushSprite(0, 30);
-      img1a.fillSprite(WHITE); img1a.pushSprite(160, 30);
-      img2.fillSprite(WHITE); img2.pushSprite(0, 211);
-      
-      // Clear dirty flags
-      if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-        sharedState.connectionDirty = false;
-        xSemaphoreGive(dataMutex);
+    // Until the first probe is through, the saved band and mode are shown
+    static bool probing = true;
+    probing = probing && !anyKxpaConn && millis() < KXPA_PROBE_MS;
+    
+    if (!s_kxpaConn && !probing) {
+      showStatusLine(st.titleNoKxpa, UI_RED);
+      if (uiView != VIEW_BLANK) {
+        M5.Lcd.fillRect(0, PANEL_Y, IMG1_WIDTH + IMG1a_WIDTH, IMG1_HEIGHT, WHITE);
+        uiView = VIEW_BLANK;
       }
+      drawMenuBar(MENU_BLANK);
       return;
     }
 
-    // Top Status Line & Bottom Menu (only if connection state changed)
-    if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-      if (sharedState.connectionDirty || forceUpdate) {
-        if (s_catConn) {
-          showStatusLine(">>  CAT Control  <<", DARKGREEN);
-          img2.fillSprite(DARKGREEN);
-        } else {
-          showStatusLine(">>  Manual Control  <<", BLUE);
-          img2.fillSprite(BLUE);
-          img2.setTextColor(WHITE);
-          img2.drawString("Band -", 30, 4);
-          img2.drawString("OK", 138, 4);
-          img2.drawString("Band +", 228, 4);
-        }
-        img2.pushSprite(0, 211);
-        sharedState.connectionDirty = false;
+    // Top Status Line & Bottom Menu (both skip the push if nothing changed)
+    if (!s_kxpaConn) {
+      showStatusLine(st.titleStart, UI_BLUE);
+      drawMenuBar(MENU_BLANK);
+    } else if (s_catConn) {
+      showStatusLine(st.titleCat, UI_DARKGREEN);
+      drawMenuBar(MENU_CAT);
+    } else {
+      showStatusLine(st.titleManual, UI_BLUE);
+      drawMenuBar(MENU_MANUAL);
+    }
+
+    if (uiView != wantView) {
+      if (wantView == VIEW_METER) {
+        drawMeterLayout();
+      } else if (wantView == VIEW_DIAG) {
+        drawDiagLayout();
+      } else if (wantView == VIEW_PROFILE) {
+        drawProfileLayout();
+      } else {
+        drawLayout();
       }
-      xSemaphoreGive(dataMutex);
+      uiView = wantView;
+      timerMeter = 0;
+      timerDiag = 0;
     }
 
-    String dispBandName = uiUpdatingBand ? kxpa.getBandName(uiBandCounter) : s_bandName;
-    
-    drawLeftSprite(dispBandName, s_pwr, s_temp, s_swr, s_catConn);
-    drawRightSprite(s_ant, s_mode, s_fault, s_volt);
-    
-    // Clear all dirty flags
-    if (xSemaphoreTake(dataMutex, SEMAPHORE_TIMEOUT_TICKS)) {
-      sharedState.bandDirty = false;
-      sharedState.powerDirty = false;
-      sharedState.tempDirty = false;
-      sharedState.swrDirty = false;
-      sharedState.antennaDirty = false;
-      sharedState.modeDirty = false;
-      sharedState.faultsDirty = false;
-      sharedState.voltageDirty = false;
-      xSemaphoreGive(dataMutex);
+    // The meter view is drawn at its own frame rate below
+    if (uiView == VIEW_VALUES) {
+      int dispBand = uiUpdatingBand ? uiBandCounter : s_bandIdx;
+      const char* dispBandName = dispBand >= 0 ? st.kxpa.getBandName(dispBand) : "";
+      
+      drawLeftPanel(dispBandName, t.powerX10, t.tempX10, t.swrX10, s_catConn);
+      drawRightPanel(t.antenna, t.mode, t.faults, t.voltageMv);
+    }
+  }
+
+  // --- Meter View: own frame rate, fed by every new snapshot ---
+  if (uiView == VIEW_METER && millis() - timerMeter >= METER_FRAME_MS) {
+    timerMeter = millis();
+    drawMeter(t);
+    if (st.history != NULL && (timerMeterHistory == 0 || millis() - timerMeterHistory >= DIAG_REFRESH_MS)) {
+      timerMeterHistory = millis();
+      drawMeterHistory(*st.history);
+    }
+    drawn = true;
+  }
+
+  // --- Diagnostics and Profiling Pages ---
+  if ((uiView == VIEW_DIAG || uiView == VIEW_PROFILE) &&
+      (timerDiag == 0 || millis() - timerDiag >= DIAG_REFRESH_MS)) {
+    timerDiag = millis();
+    if (uiView == VIEW_DIAG) {
+      drawDiag();
+    } else {
+      drawProfile();
     }
+    drawn = true;
+  }
+  
+  if (!drawn) {
+    frame.cancel();
   }
 }
 
@@ -560,6 +1335,254 @@ void loop() {
 // HELPER FUNCTIONS
 // -----------------------------------------------------------------------------------------
 
+// Queue a command for the backend and wake it up (UI task only)
+bool sendCommand(BackendCommand::Type type, int8_t value) {
+  BackendCommand cmd;
+  cmd.type = type;
+  cmd.value = value;
+  cmd.station = uiStation;
+  cmd.seq = uiCommandSeq + 1;
+  
+  if (!commandQueue.push(cmd)) {
+    Serial.println("Command queue full");
+    return false;
+  }
+  uiCommandSeq = cmd.seq;
+  
+  if (backendTaskHandle != NULL) {
+    xTaskNotify(backendTaskHandle, EVT_COMMAND, eSetBits);
+  }
+  return true;
+}
+
+// Route a command to its station and record what it did to the band (backend task only)
+void dispatchCommand(const BackendCommand& cmd) {
+  if (cmd.type == BackendCommand::CAPTURE) {
+    runCapture(cmd.value);
+    return;
+  }
+  if (cmd.station >= STATION_COUNT) {
+    return;
+  }
+  Station& s = *stations[cmd.station];
+  s.manualReq = true;
+  if (runCommand(s, cmd) && cmd.type == BackendCommand::SET_BAND) {
+    s.currentBandIdx = cmd.value;
+    s.bandKnown = true;
+    s.justSwitched = true;
+  }
+}
+
+// Execute one queued command on the station's KXPA (backend task only)
+bool runCommand(Station& s, const BackendCommand& cmd) {
+  switch (cmd.type) {
+    case BackendCommand::SET_BAND: {
+      bool ok = s.kxpa.setBand(cmd.value);
+      // Band and antenna are verified, the mode may still have changed; after
+      // a failure the next poll finds out where the amp really is
+      s.scheduler.invalidate((1 << KXPA100Controller::PARAM_ANTENNA) |
+                             (1 << KXPA100Controller::PARAM_MODE) |
+                             (ok ? 0 : 1 << KXPA100Controller::PARAM_BAND));
+      return ok;
+    }
+    case BackendCommand::SET_MODE: {
+      s.scheduler.invalidate(1 << KXPA100Controller::PARAM_MODE);
+      bool ok = s.kxpa.setMode((KXPA100Controller::Mode)cmd.value);
+      if (ok) {
+        s.status.mode = cmd.value;    // protection must not trust a stale bypass
+        settings.setMode(s.index, cmd.value, millis());   // only chosen modes, never a trip
+      }
+      return ok;
+    }
+    case BackendCommand::SET_ANTENNA:
+      s.scheduler.invalidate(1 << KXPA100Controller::PARAM_ANTENNA);
+      return s.kxpa.setAntenna(cmd.value);
+    case BackendCommand::CAPTURE:
+      break;                          // not per station, see dispatchCommand()
+  }
+  return false;
+}
+
+// Frame capture commands from the serial console (backend task only)
+void runCapture(int8_t action) {
+  switch (action) {
+    case BackendCommand::CAPTURE_START:
+      if (captureSaving.load(std::memory_order_acquire)) {
+        Serial.println("Capture: save in progress");
+      } else if (startCapture()) {
+        Serial.println("Capture started");
+      }
+      break;
+    case BackendCommand::CAPTURE_STOP:
+      frameLog.stop();
+      Serial.print("Capture stopped, ");
+      Serial.print(frameLog.records());
+      Serial.println(" records");
+      break;
+    case BackendCommand::CAPTURE_SAVE:
+      // Stop here, the flash write runs in captureSaveTask: a 256 KB write takes
+      // seconds that polling and protection must not wait for
+      frameLog.stop();
+      if (captureSaveTaskHandle == NULL || captureSaving.exchange(true, std::memory_order_acq_rel)) {
+        Serial.println("Capture: save in progress or not available");
+        break;
+      }
+      xTaskNotifyGive(captureSaveTaskHandle);
+      break;
+  }
+}
+
+// Allocates the ring once, then (re)starts it
+bool startCapture() {
+  if (!frameLog.hasBuffer()) {
+    size_t size = psramFound() ? FRAME_LOG_PSRAM_BYTES : FRAME_LOG_BYTES;
+    uint8_t* buffer = (uint8_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+    if (buffer == NULL) {
+      Serial.println("Capture: no memory for the ring");
+      return false;
+    }
+    frameLog.setBuffer(buffer, size);
+  }
+  frameLog.start();
+  return true;
+}
+
+// Writes the stopped ring to flash (capture save task, while captureSaving is set)
+bool saveCapture() {
+  if (!spiffsMounted) {
+    Serial.println("Capture: SPIFFS not available");
+    return false;
+  }
+  File file = SPIFFS.open(FRAME_LOG_PATH, FILE_WRITE);
+  if (!file) {
+    Serial.println("Capture: cannot create " FRAME_LOG_PATH);
+    return false;
+  }
+  size_t written = frameLog.dump(file);
+  file.close();
+
+  bool ok = written == frameLog.dumpSize();
+  Serial.print(ok ? "Capture saved: " : "Capture truncated: ");
+  Serial.print(frameLog.records());
+  Serial.print(" records (");
+  Serial.print(frameLog.lost());
+  Serial.print(" lost), ");
+  Serial.print((unsigned long)written);
+  Serial.println(" bytes in " FRAME_LOG_PATH);
+  return ok;
+}
+
+// Sleeps until the backend hands over a stopped ring, the backend takes it back after the write
+void captureSaveTask(void * pvParameters) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (captureSaving.load(std::memory_order_acquire)) {
+      saveCapture();
+      captureSaving.store(false, std::memory_order_release);
+    }
+  }
+}
+
+// Saved capture as hex between markers, "xxd -r -p" turns it back into the file (UI task)
+void printCapture() {
+  if (captureSaving.load(std::memory_order_acquire)) {
+    Serial.println("Capture: save in progress");
+    return;
+  }
+  File file = spiffsMounted ? SPIFFS.open(FRAME_LOG_PATH, FILE_READ) : File();
+  if (!file) {
+    Serial.println("No capture saved, use cap save");
+    return;
+  }
+  Serial.println("-----BEGIN KXFL-----");
+  uint8_t chunk[32];
+  char hex[2 * sizeof(chunk) + 1];
+  size_t n;
+  while ((n = file.read(chunk, sizeof(chunk))) > 0) {
+    for (size_t i = 0; i < n; ++i) {
+      snprintf(hex + 2 * i, 3, "%02x", chunk[i]);
+    }
+    Serial.println(hex);
+  }
+  file.close();
+  Serial.println("-----END KXFL-----");
+}
+
+#if KXPA_REPLAY
+// Reads the saved capture into RAM for station A (setup only)
+bool loadReplay() {
+  if (!spiffsMounted) {
+    return false;
+  }
+  File file = SPIFFS.open(FRAME_LOG_PATH, FILE_READ);
+  if (!file) {
+    return false;
+  }
+  size_t size = file.size();
+  uint8_t* capture = (uint8_t*)(psramFound() ? ps_malloc(size) : malloc(size));
+  bool ok = capture != NULL && file.read(capture, size) == size && kxpaPort.load(capture, size, 0);
+  file.close();
+  if (!ok) {
+    free(capture);   // a rejected capture leaves the port without a pointer to it
+  }
+  Serial.println(ok ? "KXPA replay: station A plays " FRAME_LOG_PATH : "KXPA replay: capture unreadable");
+  return ok;
+}
+
+void replayPumpTask(void * pvParameters) {
+  while (true) {
+    kxpaPort.pump(esp_timer_get_time());
+    vTaskDelay(1);                    // one tick (1 ms) timing resolution
+  }
+}
+#endif
+
+#if SOAK_BENCH
+// Column names of the soak rows, printed once at boot
+void printSoakHeader() {
+  Serial.println("soak,s,polls,poll_p50,poll_p99,poll_max,switches,band_p50,band_p99,band_max,"
+                 "frames,frame_p50,frame_p99,frame_max,heap,heap_min,heap_big,frag_pct,ui_hz,backend_hz");
+}
+
+// Latencies since boot (or "stats reset") in us, heap now, loop rates since the last row (UI task)
+void printSoakRow() {
+  static const LatencyStats::Timer TIMERS[] = {
+    LatencyStats::T_KXPA_POLL, LatencyStats::T_CAT_BAND, LatencyStats::T_RENDER_FRAME
+  };
+  char line[200];
+  size_t len = snprintf(line, sizeof(line), "soak,%lu", millis() / 1000);
+
+  for (LatencyStats::Timer timer : TIMERS) {
+    len += snprintf(line + len, sizeof(line) - len, ",%lu,%lu,%lu,%lu",
+                    (unsigned long)LatencyStats::histogram(timer).count,
+                    (unsigned long)LatencyStats::percentile(timer, 50),
+                    (unsigned long)LatencyStats::percentile(timer, 99),
+                    (unsigned long)LatencyStats::histogram(timer).maxUs);
+  }
+
+  TaskProfiler::sample(profile);
+  snprintf(line + len, sizeof(line) - len, ",%lu,%lu,%lu,%u,%u,%u",
+           (unsigned long)profile.heapFree, (unsigned long)profile.heapMinFree,
+           (unsigned long)profile.heapLargest, profile.heapFragPct,
+           profile.loops[TaskProfiler::LOOP_UI].hz, profile.loops[TaskProfiler::LOOP_BACKEND].hz);
+  Serial.println(line);
+}
+#endif
+
+// BtnA+BtnC: show and control the next station (UI task only)
+void selectNextStation() {
+  if (STATION_COUNT < 2) {
+    return;
+  }
+  uiStation = (uiStation + 1) % STATION_COUNT;
+  uiUpdatingBand = false;
+  timerLastTx = 0;
+  uiView = VIEW_NONE;       // redraw layout and every field for the new station
+  timerDisplay = 0;
+  Serial.print("Station ");
+  Serial.println(stations[uiStation]->label);
+}
+
 void showPowerOffWarning() {
   M5.Lcd.fillRect(0, 80, 320, 80, RED);
   M5.Lcd.setTextColor(WHITE);
@@ -569,61 +1592,448 @@ void showPowerOffWarning() {
   M5.Lcd.drawString("to abort shutdown", 25, 140);
 }
 
-void showStatusLine(const String& text, int color) {
-  img0.fillSprite(color);
-  img0.setFont(&fonts::FreeSans12pt7b);
-  img0.setTextColor(WHITE);
-  
-  int16_t textWidth  = img0.textWidth(text);
-  int16_t textHeight = img0.fontHeight();
-  int16_t x = (img0.width()  - textWidth)  / 2;
-  int16_t y = (img0.height() - textHeight) / 2;
+// Static labels of the value view, drawn straight to the LCD once per view change
+void drawLayout() {
+  M5.Lcd.fillRect(0, PANEL_Y, IMG1_WIDTH + IMG1a_WIDTH, IMG1_HEIGHT, WHITE);
+  M5.Lcd.setFont(&fonts::FreeSansBold12pt7b);
+  M5.Lcd.setTextColor(DARKGREY);
+  M5.Lcd.drawString("Power", LINE_LEFT_X, PANEL_Y + LINE2_Y);
+  M5.Lcd.drawString("Temp.", LINE_LEFT_X, PANEL_Y + LINE3_Y);
+  M5.Lcd.drawString("SWR", LINE_LEFT_X, PANEL_Y + LINE4_Y);
 
-  img0.drawString(text, x, y);
-  img0.pushSprite(0, 0);
+  for (UiField* field : valueFields) {
+    field->invalidate();
+  }
 }
 
-void drawLeftSprite(const String& band, const String& power, const String& temp, const String& swr, bool catConn) {
-  img1.fillSprite(WHITE);
-  img1.setFont(&fonts::FreeSansBold24pt7b);
-  
-  if (!catConn)
-    img1.setTextColor(uiUpdatingBand ? RED : DARKGREY);
-  else
-    img1.setTextColor(DARKGREY);
-    
-  img1.drawString(band, LINE_LEFT_X, LINE1_Y);
-  
-  img1.setFont(&fonts::FreeSansBold12pt7b);
-  img1.setTextColor(DARKGREY);
-  img1.drawString("Power", LINE_LEFT_X, LINE2_Y);
-  img1.drawString(power, VALUES_X, LINE2_Y);
-  img1.drawString("Temp.", LINE_LEFT_X, LINE3_Y);
-  img1.drawString(temp, VALUES_X, LINE3_Y);
-  img1.drawString("SWR", LINE_LEFT_X, LINE4_Y);
-  img1.drawString(swr, VALUES_X, LINE4_Y);
+// Labels and bar frames of the meter view
+void drawMeterLayout() {
+  M5.Lcd.fillRect(0, PANEL_Y, IMG1_WIDTH + IMG1a_WIDTH, IMG1_HEIGHT, WHITE);
+  M5.Lcd.setFont(&fonts::FreeSansBold12pt7b);
+  M5.Lcd.setTextColor(DARKGREY);
+  M5.Lcd.drawString("Power", METER_X, METER_PWR_Y);
+  M5.Lcd.drawString("SWR", METER_X, METER_SWR_Y);
+  M5.Lcd.drawRect(METER_X, METER_PWR_Y + FIELD_H, METER_W, METER_BAR_H, DARKGREY);
+  M5.Lcd.drawRect(METER_X, METER_SWR_Y + FIELD_H, METER_W, METER_BAR_H, DARKGREY);
+
+  // Scale: 0/50/100 W and 1.0/2.0/3.0
+  M5.Lcd.setFont(&fonts::Font0);
+  int16_t scaleY = FIELD_H + METER_BAR_H + 2;
+  M5.Lcd.drawString("0", METER_X, METER_PWR_Y + scaleY);
+  M5.Lcd.drawString("50", METER_X + METER_W / 2 - 6, METER_PWR_Y + scaleY);
+  M5.Lcd.drawString("100W", METER_X + METER_W - 24, METER_PWR_Y + scaleY);
+  M5.Lcd.drawString("1.0", METER_X, METER_SWR_Y + scaleY);
+  M5.Lcd.drawString("2.0", METER_X + METER_W / 2 - 9, METER_SWR_Y + scaleY);
+  M5.Lcd.drawString("3.0", METER_X + METER_W - 18, METER_SWR_Y + scaleY);
 
-  img1.pushSprite(0, 30);
+  meterPowerField.invalidate();
+  meterSwrField.invalidate();
+  meterPower.invalidate();
+  meterSwr.invalidate();
+  timerMeterHistory = 0;
 }
 
-void drawRightSprite(const String& antRaw, const String& mode, const String& faults, const String& voltage) {
-  img1a.fillSprite(WHITE);
-  
-  String ant = antRaw;
-  ant.replace("^AN1;", "ANT1");
-  ant.replace("^AN2;", "ANT2");
-  ant.replace("^AN1", "ANT1");
-  ant.replace("^AN2", "ANT2");
-
-  img1a.setFont(&fonts::FreeSansBold24pt7b);
-  img1a.setTextColor(DARKGREY);
-  img1a.drawString(ant, LINE_LEFT_X, LINE1_Y);
-  
-  img1a.setFont(&fonts::FreeSansBold12pt7b);
-  img1a.setTextColor(DARKGREY);
-  img1a.drawString(mode, LINE_LEFT_X, LINE2_Y);
-  img1a.drawString(faults, LINE_LEFT_X, LINE3_Y);
-  img1a.drawString("Supply " + voltage + "V", LINE_LEFT_X, LINE4_Y);
+void drawMeter(const Telemetry& t) {
+  LatencyStats::Scope timing(LatencyStats::T_RENDER_METER);
+  char power[8], swr[8], text[12];
+  formatFixed(power, sizeof(power), t.powerX10, 10, 0);
+  formatFixed(swr, sizeof(swr), t.swrX10, 10, 1);
+  snprintf(text, sizeof(text), "%s W", power);
+
+  unsigned long now = millis();
+  M5.Lcd.startWrite();
+  meterPower.draw(t.powerX10, now);
+  meterSwr.draw(t.swrX10, now);
+  M5.Lcd.endWrite();
+
+  meterPowerField.draw(text, UI_DARKGREY);
+  meterSwrField.draw(swr, t.swrX10 >= 20 ? UI_RED : UI_DARKGREY);
+}
+
+// Peaks and averages under each bar, from the rollups (UI task, the reader side)
+void drawMeterHistory(const TelemetryHistory& h) {
+  TelemetryHistory::Stats minute, tenMin;
+  char avg[8], peak[8], longPeak[8], line[54];
+  int16_t rowY = FIELD_H + METER_BAR_H + 2 + 10;      // below the scale
+
+  // Last 60 s from the 1 s level, last 10 min from the 10 s level
+  bool ok = h.window(TelemetryHistory::CH_POWER, TelemetryHistory::LEVEL_1S, 60, minute);
+  bool okLong = h.window(TelemetryHistory::CH_POWER, TelemetryHistory::LEVEL_10S, 60, tenMin);
+  formatFixed(peak, sizeof(peak), minute.max, 10, 0);
+  formatFixed(longPeak, sizeof(longPeak), tenMin.max, 10, 0);
+  snprintf(line, sizeof(line), "60 s peak %5s W      10 min peak %5s W",
+           ok ? peak : "-", okLong ? longPeak : "-");
+  M5.Lcd.setFont(&fonts::Font0);
+  M5.Lcd.setTextColor(DARKGREY, WHITE);   // opaque, fixed width
+  M5.Lcd.drawString(line, METER_X, METER_PWR_Y + rowY);
+
+  ok = h.window(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_1S, 60, minute);
+  okLong = h.window(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_10S, 60, tenMin);
+  formatFixed(avg, sizeof(avg), minute.avg, 10, 1);
+  formatFixed(peak, sizeof(peak), minute.max, 10, 1);
+  formatFixed(longPeak, sizeof(longPeak), tenMin.max, 10, 1);
+  snprintf(line, sizeof(line), "60 s avg %4s max %4s   10 min max %4s",
+           ok ? avg : "-", ok ? peak : "-", okLong ? longPeak : "-");
+  M5.Lcd.drawString(line, METER_X, METER_SWR_Y + rowY);
+}
+
+// Latency table of the diagnostics page, one fixed row per timer (Font0, 6x8)
+const int DIAG_ROW_H = 8;
+const int DIAG_COLS = 53;
+
+void drawDiagLayout() {
+  M5.Lcd.fillRect(0, PANEL_Y, IMG1_WIDTH + IMG1a_WIDTH, IMG1_HEIGHT, WHITE);
+  M5.Lcd.setFont(&fonts::Font0);
+  M5.Lcd.setTextColor(DARKGREY);
+  M5.Lcd.drawString("                n   p50 us   p99 us   max us", 2, PANEL_Y + 2);
+}
+
+void drawDiag() {
+  char line[DIAG_COLS + 1];
+  int y = PANEL_Y + 2 + DIAG_ROW_H;
+
+  M5.Lcd.setFont(&fonts::Font0);
+  M5.Lcd.setTextColor(BLACK, WHITE);    // opaque, every row overwrites itself
+
+  // Timers with samples only, as many as fit above the two counter rows ("stats" has all)
+  const int timerEnd = PANEL_Y + IMG1_HEIGHT - 2 * DIAG_ROW_H;
+  for (uint8_t i = 0; i < LatencyStats::TIMER_COUNT && y + DIAG_ROW_H <= timerEnd; ++i) {
+    LatencyStats::Timer timer = (LatencyStats::Timer)i;
+    const LatencyStats::Histogram& h = LatencyStats::histogram(timer);
+    if (h.count == 0) {
+      continue;
+    }
+    snprintf(line, sizeof(line), "%-10s %6lu %8lu %8lu %8lu", LatencyStats::name(timer),
+             (unsigned long)h.count,
+             (unsigned long)LatencyStats::percentile(timer, 50),
+             (unsigned long)LatencyStats::percentile(timer, 99),
+             (unsigned long)h.maxUs);
+    M5.Lcd.drawString(line, 2, y);
+    y += DIAG_ROW_H;
+  }
+
+  M5.Lcd.setTextColor(RED, WHITE);
+  snprintf(line, sizeof(line), "KXPA tmo %lu unexp %lu wr %lu retry %lu fail %lu",
+           (unsigned long)LatencyStats::counter(LatencyStats::C_KXPA_TIMEOUT),
+           (unsigned long)LatencyStats::counter(LatencyStats::C_KXPA_UNEXPECTED),
+           (unsigned long)LatencyStats::counter(LatencyStats::C_KXPA_WRITE_FAIL),
+           (unsigned long)LatencyStats::counter(LatencyStats::C_KXPA_RETRY),
+           (unsigned long)LatencyStats::counter(LatencyStats::C_KXPA_FAIL));
+  M5.Lcd.drawString(line, 2, y);
+  y += DIAG_ROW_H;
+  snprintf(line, sizeof(line), "CAT  tmo %lu error %lu reconnect %lu",
+           (unsigned long)LatencyStats::counter(LatencyStats::C_CAT_TIMEOUT),
+           (unsigned long)LatencyStats::counter(LatencyStats::C_CAT_ERROR),
+           (unsigned long)LatencyStats::counter(LatencyStats::C_CAT_RECONNECT));
+  M5.Lcd.drawString(line, 2, y);
+  y += DIAG_ROW_H;
+
+  // Rows left over from a longer table, e.g. before "stats reset"
+  if (y < PANEL_Y + IMG1_HEIGHT) {
+    M5.Lcd.fillRect(0, y, IMG1_WIDTH + IMG1a_WIDTH, PANEL_Y + IMG1_HEIGHT - y, WHITE);
+  }
+}
+
+const int PROFILE_TASK_ROW = 5;       // rows above the task table
+
+void drawProfileLayout() {
+  M5.Lcd.fillRect(0, PANEL_Y, IMG1_WIDTH + IMG1a_WIDTH, IMG1_HEIGHT, WHITE);
+  M5.Lcd.setFont(&fonts::Font0);
+  M5.Lcd.setTextColor(DARKGREY);
+  M5.Lcd.drawString("task             core  stack   free    cpu", 2,
+                    PANEL_Y + 2 + (PROFILE_TASK_ROW - 1) * DIAG_ROW_H);
+}
+
+void drawProfile() {
+  char line[DIAG_COLS + 1];
+  char share[2][8];
+  int y = PANEL_Y + 2;
+
+  TaskProfiler::sample(profile);
+  M5.Lcd.setFont(&fonts::Font0);
+  M5.Lcd.setTextColor(BLACK, WHITE);    // opaque, every row overwrites itself
+
+  snprintf(line, sizeof(line), "heap %6lu min %6lu big %6lu frag %3u%%",
+           (unsigned long)profile.heapFree, (unsigned long)profile.heapMinFree,
+           (unsigned long)profile.heapLargest, profile.heapFragPct);
+  M5.Lcd.drawString(line, 2, y);
+  y += DIAG_ROW_H;
+
+  TaskProfiler::formatShare(share[0], sizeof(share[0]), profile.coreLoadPermille[0]);
+  TaskProfiler::formatShare(share[1], sizeof(share[1]), profile.coreLoadPermille[1]);
+  snprintf(line, sizeof(line), "dma  %6lu big %6lu  core0 %6s core1 %6s",
+           (unsigned long)profile.dmaFree, (unsigned long)profile.dmaLargest, share[0], share[1]);
+  M5.Lcd.drawString(line, 2, y);
+  y += DIAG_ROW_H;
+
+  static const char* const LOOP_LABELS[] = { "ui loop", "backend" };
+  for (uint8_t i = 0; i < TaskProfiler::LOOP_COUNT; ++i) {
+    const TaskProfiler::LoopRow& l = profile.loops[i];
+    TaskProfiler::formatShare(share[0], sizeof(share[0]), l.busyPermille);
+    snprintf(line, sizeof(line), "%-8s %5u Hz  busy %6s  max %7lu us", LOOP_LABELS[i],
+             l.hz, share[0], (unsigned long)l.maxUs);
+    M5.Lcd.drawString(line, 2, y);
+    y += DIAG_ROW_H;
+  }
+
+  // Tightest stack first; rows left over from a longer list are blanked
+  y = PANEL_Y + 2 + PROFILE_TASK_ROW * DIAG_ROW_H;
+  for (uint8_t i = 0; y + DIAG_ROW_H <= PANEL_Y + IMG1_HEIGHT; ++i, y += DIAG_ROW_H) {
+    if (i == 0 && profile.taskCount == 0 && profile.taskTotal > 0) {
+      // The snapshot came back empty, say why instead of a blank table
+      char msg[40];
+      snprintf(msg, sizeof(msg), "%u tasks, more than TASKS_MAX %u", profile.taskTotal,
+               TaskProfiler::TASKS_MAX);
+      M5.Lcd.setTextColor(RED, WHITE);
+      snprintf(line, sizeof(line), "%-*s", DIAG_COLS, msg);
+    } else if (i >= profile.taskCount) {
+      snprintf(line, sizeof(line), "%*s", DIAG_COLS, "");
+    } else {
+      const TaskProfiler::TaskRow& t = profile.tasks[i];
+      char core[3] = "-";
+      char size[8] = "-";
+      if (t.core >= 0) snprintf(core, sizeof(core), "%d", t.core);
+      if (t.stackSize != 0) snprintf(size, sizeof(size), "%lu", (unsigned long)t.stackSize);
+      TaskProfiler::formatShare(share[0], sizeof(share[0]), t.cpuPermille);
+      M5.Lcd.setTextColor(t.stackFree < PROFILE_STACK_LOW ? RED : BLACK, WHITE);
+      snprintf(line, sizeof(line), "%-16s %4s %6s %6lu %6s", t.name, core, size,
+               (unsigned long)t.stackFree, share[0]);
+    }
+    M5.Lcd.drawString(line, 2, y);
+  }
+}
+
+// Debug console: "stats", "stats reset", "diag", "prof", "cap ...", "config", "config reset", "set <key> <value>"
+void handleSerialConsole() {
+  static char cmd[SERIAL_CMD_MAX];
+  static uint8_t len = 0;
+
+  while (Serial.available()) {
+    char c = (char)Serial.read();
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (len < SERIAL_CMD_MAX - 1) cmd[len++] = c;
+      continue;
+    }
+    cmd[len] = '\0';
+    len = 0;
+
+    if (strcmp(cmd, "stats") == 0) {
+      LatencyStats::print(Serial);
+      for (Station* s : stations) {
+        if (STATION_COUNT > 1) {
+          Serial.print("Station ");
+          Serial.println(s->label);
+        }
+        s->kxpa.printTurnaround(Serial);
+        Serial.print("Protection trips: ");
+        Serial.print(s->protection.trips());
+        Serial.print(", last: ");
+        Serial.println(ProtectionEngine::name(s->protection.lastTrip()));
+      }
+#if TELEMETRY_UDP
+      Serial.print("Telemetry datagrams: ");
+      Serial.print(telemetryPublisher.sent());
+      Serial.print(" sent, ");
+      Serial.print(telemetryPublisher.coalesced());
+      Serial.print(" coalesced, ");
+      Serial.print(telemetryPublisher.failed());
+      Serial.println(" failed");
+#endif
+    } else if (strcmp(cmd, "stats reset") == 0) {
+      LatencyStats::reset();
+      Serial.println("Stats cleared");
+    } else if (strcmp(cmd, "diag") == 0) {
+      uiDiagShown = !uiDiagShown;
+      timerDisplay = 0;
+    } else if (strcmp(cmd, "prof") == 0) {
+      // Rates and shares since the previous sample (page refresh or the last "prof")
+      TaskProfiler::sample(profile);
+      TaskProfiler::print(Serial, profile);
+    } else if (strcmp(cmd, "cap") == 0) {
+      // Written by the backend, a torn read only garbles this printout
+      Serial.print(frameLog.capturing() ? "Capturing, " :
+                   captureSaving.load(std::memory_order_relaxed) ? "Saving, " : "Capture stopped, ");
+      Serial.print(frameLog.records());
+      Serial.print(" records, ");
+      Serial.print(frameLog.lost());
+      Serial.print(" lost, ");
+      Serial.print((unsigned long)frameLog.used());
+      Serial.println(" bytes");
+#if KXPA_REPLAY
+      Serial.print("Replay: ");
+      Serial.print(kxpaPort.txMatched());
+      Serial.print(" commands matched, ");
+      Serial.print(kxpaPort.txMismatched());
+      Serial.print(" differ, ");
+      Serial.print(kxpaPort.rxDelivered());
+      Serial.println(kxpaPort.finished() ? " frames played, done" : " frames played");
+#endif
+    } else if (strcmp(cmd, "cap start") == 0) {
+      sendCommand(BackendCommand::CAPTURE, BackendCommand::CAPTURE_START);
+    } else if (strcmp(cmd, "cap stop") == 0) {
+      sendCommand(BackendCommand::CAPTURE, BackendCommand::CAPTURE_STOP);
+    } else if (strcmp(cmd, "cap save") == 0) {
+      sendCommand(BackendCommand::CAPTURE, BackendCommand::CAPTURE_SAVE);
+    } else if (strcmp(cmd, "cap hex") == 0) {
+      printCapture();
+    } else if (strcmp(cmd, "config") == 0) {
+      settings.printTuning(Serial);
+      for (Station* s : stations) {
+        // Written by the backend, a torn read only garbles this printout
+        const SettingsStore::StationState& saved = settings.station(s->index);
+        Serial.print(s->label);
+        Serial.print(s->label[0] != '\0' ? ": " : "");
+        Serial.print("saved band ");
+        Serial.print(saved.band);
+        Serial.print(", mode ");
+        Serial.print(saved.mode);
+        Serial.print(", CAT ");
+        Serial.print(saved.catHost[0] != '\0' ? saved.catHost : "-");
+        Serial.print(":");
+        Serial.println(saved.catPort);
+      }
+      const WifiCache& wifi = settings.wifiCache();
+      Serial.print("saved WiFi: ");
+      Serial.print(wifi.ssid[0] != '\0' ? wifi.ssid : "-");
+      Serial.print(", channel ");
+      Serial.print(wifi.channel);
+      Serial.print(", IP ");
+      Serial.println(IPAddress(wifi.ip));
+      Serial.print("NVS state writes: ");
+      Serial.println(settings.writes());
+    } else if (strcmp(cmd, "config reset") == 0) {
+      settings.resetTuning();
+      Serial.println("Defaults restored, restart to apply");
+    } else if (strncmp(cmd, "set ", 4) == 0) {
+      char* key = cmd + 4;
+      char* value = strchr(key, ' ');
+      if (value != NULL) {
+        *value++ = '\0';
+      }
+      if (value != NULL && settings.setTuning(key, strtoul(value, NULL, 0))) {
+        Serial.println("Saved, restart to apply");
+      } else {
+        Serial.println("Usage: set <key> <value>, see config for keys and ranges");
+      }
+    } else if (cmd[0] != '\0') {
+      Serial.println("Commands: stats, stats reset, diag, prof, cap [start|stop|save|hex], config, config reset, set <key> <value>");
+    }
+  }
+}
+
+void drawMenuBar(MenuBar menu) {
+  if (menu == uiMenu) {
+    return;
+  }
+  uiMenu = menu;
+  dma.reclaim(barCanvas);
+  barCanvas.setFont(&fonts::FreeSans12pt7b);
+  barCanvas.setTextColor(UI_WHITE);
+
+  switch (menu) {
+    case MENU_CAT:
+      barCanvas.fillSprite(UI_DARKGREEN);
+      barCanvas.drawString("View", 130, 4);
+      break;
+    case MENU_MANUAL:
+      barCanvas.fillSprite(UI_BLUE);
+      barCanvas.drawString("Band -", 30, 4);
+      barCanvas.drawString("OK", 138, 4);
+      barCanvas.drawString("Band +", 228, 4);
+      break;
+    default:
+      barCanvas.fillSprite(UI_WHITE);
+      break;
+  }
+  dma.push(barCanvas, 0, 211);
+}
+
+void showStatusLine(const char* text, UiColor color) {
+  static const char* shownText = NULL;
+  static int shownColor = -1;
+
+  // Callers pass string literals, comparing the pointer is enough
+  if (text == shownText && color == shownColor) {
+    return;
+  }
+  shownText = text;
+  shownColor = color;
+
+  dma.reclaim(barCanvas);
+  barCanvas.fillSprite(color);
+  barCanvas.setFont(&fonts::FreeSans12pt7b);
+  barCanvas.setTextColor(UI_WHITE);
   
-  img1a.pushSprite(160, 30);
-}
\ No newline at end of file
+  int16_t textWidth  = barCanvas.textWidth(text);
+  int16_t textHeight = barCanvas.fontHeight();
+  int16_t x = (barCanvas.width()  - textWidth)  / 2;
+  int16_t y = (barCanvas.height() - textHeight) / 2;
+
+  barCanvas.drawString(text, x, y);
+  dma.push(barCanvas, 0, 0);
+}
+
+// Render a fixed-point value (value / scale) with the given decimals, "ERR" if invalid
+void formatFixed(char* out, size_t len, int16_t value, int16_t scale, uint8_t decimals) {
+  if (value == KXPA100Controller::INVALID_VALUE) {
+    snprintf(out, len, "ERR");
+    return;
+  }
+
+  int32_t unit = 1;
+  for (uint8_t i = 0; i < decimals; ++i) unit *= 10;
+
+  // Round half away from zero to the requested resolution
+  int32_t step = scale / unit;
+  int32_t v = value;
+  int32_t rounded = (v >= 0 ? v + step / 2 : v - step / 2) / step;
+  int32_t mag = rounded < 0 ? -rounded : rounded;
+
+  if (decimals == 0) {
+    snprintf(out, len, "%ld", (long)rounded);
+  } else {
+    snprintf(out, len, "%s%ld.%0*ld", rounded < 0 ? "-" : "",
+             (long)(mag / unit), decimals, (long)(mag % unit));
+  }
+}
+
+void drawLeftPanel(const char* band, int16_t powerX10, int16_t tempX10, int16_t swrX10, bool catConn) {
+  char power[8], temp[8], swr[8];
+  formatFixed(power, sizeof(power), powerX10, 10, 0);
+  formatFixed(temp, sizeof(temp), tempX10, 10, 0);
+  formatFixed(swr, sizeof(swr), swrX10, 10, 1);
+
+  fieldBand.draw(band, (!catConn && uiUpdatingBand) ? UI_RED : UI_DARKGREY);
+  fieldPower.draw(power, UI_DARKGREY);
+  fieldTemp.draw(temp, UI_DARKGREY);
+  fieldSwr.draw(swr, UI_DARKGREY);
+}
+
+void drawRightPanel(int8_t antenna, int8_t mode, const char* faults, int16_t voltageMv) {
+  char ant[8], volt[8], supply[20];
+  if (antenna > 0) {
+    snprintf(ant, sizeof(ant), "ANT%d", antenna);
+  } else {
+    snprintf(ant, sizeof(ant), "?");
+  }
+  formatFixed(volt, sizeof(volt), voltageMv, 1000, 1);
+  snprintf(supply, sizeof(supply), "Supply %sV", volt);
+
+  fieldAntenna.draw(ant, UI_DARKGREY);
+  fieldMode.draw(stations[uiStation]->kxpa.getModeName(mode), UI_DARKGREY);
+  uint8_t active = 0;
+  KXPA100Controller::Fault fault = KXPA100Controller::decodeFault(faults, &active);
+  bool faulted = fault != KXPA100Controller::FAULT_NONE && fault != KXPA100Controller::FAULT_UNKNOWN;
+  char faultLabel[20];
+  if (fault == KXPA100Controller::FAULT_OTHER) {
+    snprintf(faultLabel, sizeof(faultLabel), "%s", faults);
+  } else if (active > 1) {
+    // More than one bit set: the first one and how many others
+    snprintf(faultLabel, sizeof(faultLabel), "%s +%u", KXPA100Controller::faultName(fault), active - 1);
+  } else {
+    snprintf(faultLabel, sizeof(faultLabel), "%s", KXPA100Controller::faultName(fault));
+  }
+  fieldFaults.draw(faultLabel, faulted ? UI_RED : UI_DARKGREY);
+  fieldSupply.draw(supply, UI_DARKGREY);
+}
@@ -5,3 +5,11 @@ const char* password = "xxxxxx";
 // CAT-Server-Config
 const char* CAT_SERVER   = "xxx.xxx.xxx.xxx";
 const uint16_t RIGCTLD_PORT = xxxx;
+
+// Second station (STATION_COUNT 2): its own rigctld
+const char* CAT_SERVER_2   = "xxx.xxx.xxx.xxx";
+const uint16_t RIGCTLD_PORT_2 = xxxx;
+
+// Telemetry export (TELEMETRY_UDP): station PC or subnet broadcast; use an IP, a name costs a DNS lookup
+const char* TELEMETRY_HOST = "255.255.255.255";
+const uint16_t TELEMETRY_PORT = 7373;
@@ -0,0 +1,75 @@
+#pragma once
+// Just enough of the Arduino core to build the backend on the host.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "SimClock.h"
+
+using std::min;
+using std::max;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define DEC 10
+#define HEX 16
+
+inline unsigned long millis() { return (unsigned long)(sim::nowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)sim::nowUs(); }
+inline void delay(uint32_t ms) { sim::advance((uint64_t)ms * 1000); }
+inline void yield() {}
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(const char* data, size_t len) = 0;
+
+  size_t print(const char* s) { return write(s, strlen(s)); }
+  size_t print(char c) { return write(&c, 1); }
+  size_t print(long v, int base = DEC) { return printNumber(v < 0, v < 0 ? -(unsigned long)v : v, base); }
+  size_t print(unsigned long v, int base = DEC) { return printNumber(false, v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int8_t v, int base = DEC) { return print((long)v, base); }
+  size_t print(uint8_t v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int16_t v, int base = DEC) { return print((long)v, base); }
+  size_t print(uint16_t v, int base = DEC) { return print((unsigned long)v, base); }
+
+  template <typename T>
+  size_t println(T v) { return print(v) + print('\n'); }
+  template <typename T>
+  size_t println(T v, int base) { return print(v, base) + print('\n'); }
+  size_t println() { return print('\n'); }
+
+private:
+  size_t printNumber(bool negative, unsigned long v, int base) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == HEX ? "%s%lX" : "%s%lu", negative ? "-" : "", v);
+    return print(buf);
+  }
+};
+
+// Serial console; quiet unless a test turns it on
+class NativeSerial : public Print {
+public:
+  NativeSerial() : verbose(false) {}
+  size_t write(const char* data, size_t len) override {
+    if (verbose) fwrite(data, 1, len, stdout);
+    return len;
+  }
+  int available() { return 0; }
+  int read() { return -1; }
+  bool verbose;
+};
+
+inline NativeSerial& nativeSerial() {
+  static NativeSerial serial;
+  return serial;
+}
+#define Serial nativeSerial()
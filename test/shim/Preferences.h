@@ -0,0 +1,88 @@
+#pragma once
+// NVS stand-in: one flash shared by every Preferences instance, kept for the
+// life of the test binary so a second SettingsStore sees what the first saved.
+#include "Arduino.h"
+
+class NativeNvs {
+public:
+  static const uint8_t ENTRIES_MAX = 8;
+  static const size_t KEY_MAX = 32;
+  static const size_t VALUE_MAX = 128;
+
+  struct Entry {
+    bool used;
+    char key[KEY_MAX];            // "namespace/key"
+    size_t len;
+    uint8_t value[VALUE_MAX];
+  };
+
+  NativeNvs() : writes(0) { erase(); }
+
+  // Test side
+  void erase() { memset(entries, 0, sizeof(entries)); }
+  Entry* find(const char* ns, const char* key, bool create) {
+    char full[KEY_MAX];
+    snprintf(full, sizeof(full), "%s/%s", ns, key);
+    Entry* unused = NULL;
+    for (Entry& e : entries) {
+      if (e.used && strcmp(e.key, full) == 0) return &e;
+      if (!e.used && unused == NULL) unused = &e;
+    }
+    if (!create || unused == NULL) return NULL;
+    unused->used = true;
+    strcpy(unused->key, full);
+    unused->len = 0;
+    return unused;
+  }
+
+  Entry entries[ENTRIES_MAX];
+  uint32_t writes;
+};
+
+inline NativeNvs& nativeNvs() {
+  static NativeNvs nvs;
+  return nvs;
+}
+
+class Preferences {
+public:
+  Preferences() : _ns(NULL) {}
+
+  bool begin(const char* name, bool readOnly = false, const char* = NULL) {
+    _ns = name;
+    return true;
+  }
+  void end() { _ns = NULL; }
+
+  size_t putBytes(const char* key, const void* value, size_t len) {
+    if (_ns == NULL || len > NativeNvs::VALUE_MAX) return 0;
+    NativeNvs::Entry* e = nativeNvs().find(_ns, key, true);
+    if (e == NULL) return 0;
+    memcpy(e->value, value, len);
+    e->len = len;
+    nativeNvs().writes++;
+    return len;
+  }
+
+  size_t getBytesLength(const char* key) {
+    NativeNvs::Entry* e = _ns != NULL ? nativeNvs().find(_ns, key, false) : NULL;
+    return e != NULL ? e->len : 0;
+  }
+
+  size_t getBytes(const char* key, void* buf, size_t maxLen) {
+    NativeNvs::Entry* e = _ns != NULL ? nativeNvs().find(_ns, key, false) : NULL;
+    if (e == NULL || e->len > maxLen) return 0;
+    memcpy(buf, e->value, e->len);
+    return e->len;
+  }
+
+  bool remove(const char* key) {
+    NativeNvs::Entry* e = _ns != NULL ? nativeNvs().find(_ns, key, false) : NULL;
+    if (e == NULL) return false;
+    e->used = false;
+    return true;
+  }
+
+private:
+  const char* _ns;
+};
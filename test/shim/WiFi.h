@@ -0,0 +1,107 @@
+#pragma once
+// Station API used by CatWifiClient; tests drive the events by hand.
+#include <functional>
+#include "Arduino.h"
+
+typedef enum { WIFI_OFF, WIFI_STA } wifi_mode_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_DISCONNECTED = 6 } wl_status_t;
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED
+} arduino_event_id_t;
+
+typedef struct { uint8_t ssid[33]; uint8_t ssid_len; uint8_t bssid[6]; uint8_t channel; } wifi_event_sta_connected_t;
+typedef struct { uint8_t reason; } wifi_event_sta_disconnected_t;
+typedef struct { struct { struct { uint32_t addr; } ip, netmask, gw; } ip_info; } ip_event_got_ip_t;
+typedef union {
+  wifi_event_sta_connected_t wifi_sta_connected;
+  wifi_event_sta_disconnected_t wifi_sta_disconnected;
+  ip_event_got_ip_t got_ip;
+} arduino_event_info_t;
+
+class IPAddress {
+public:
+  IPAddress(uint32_t addr = 0) : _addr(addr) {}
+  operator uint32_t() const { return _addr; }
+
+private:
+  uint32_t _addr;
+};
+
+class NativeWiFi {
+public:
+  typedef std::function<void(arduino_event_id_t, arduino_event_info_t)> EventHandler;
+
+  NativeWiFi()
+      : begins(0), lastChannel(0), staticIp(0), dns(0x0101A8C0),
+        _status(WL_DISCONNECTED), _sleep(WIFI_PS_MIN_MODEM) {
+    memset(lastBssid, 0, sizeof(lastBssid));
+  }
+
+  bool persistent(bool) { return true; }
+  bool mode(wifi_mode_t) { return true; }
+  bool disconnect(bool = false) { _status = WL_DISCONNECTED; return true; }
+  wl_status_t begin(const char*, const char*, int32_t channel = 0, const uint8_t* bssid = NULL,
+                    bool = true) {
+    begins++;
+    lastChannel = channel;
+    if (bssid != NULL) memcpy(lastBssid, bssid, sizeof(lastBssid));
+    else memset(lastBssid, 0, sizeof(lastBssid));
+    return _status;
+  }
+  bool config(IPAddress ip, IPAddress, IPAddress, IPAddress = IPAddress()) {
+    staticIp = ip;
+    return true;
+  }
+  bool setSleep(wifi_ps_type_t type) { _sleep = type; return true; }
+  wl_status_t status() { return _status; }
+  const char* localIP() { return "192.168.1.50"; }
+  IPAddress dnsIP(uint8_t = 0) { return IPAddress(dns); }
+  int onEvent(EventHandler handler) { _handler = handler; return 0; }
+
+  // Test side: pretend the station got / lost its address
+  void emit(arduino_event_id_t event) {
+    arduino_event_info_t info;
+    memset(&info, 0, sizeof(info));
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+      info.got_ip.ip_info.ip.addr = 0x3201A8C0;         // 192.168.1.50
+      info.got_ip.ip_info.gw.addr = 0x0101A8C0;
+      info.got_ip.ip_info.netmask.addr = 0x00FFFFFF;
+    }
+    emit(event, info);
+  }
+  void emit(arduino_event_id_t event, const arduino_event_info_t& info) {
+    if (event != ARDUINO_EVENT_WIFI_STA_CONNECTED) {
+      _status = event == ARDUINO_EVENT_WIFI_STA_GOT_IP ? WL_CONNECTED : WL_DISCONNECTED;
+    }
+    if (_handler) _handler(event, info);
+  }
+  void associate(const uint8_t (&bssid)[6], uint8_t channel) {
+    arduino_event_info_t info;
+    memset(&info, 0, sizeof(info));
+    memcpy(info.wifi_sta_connected.bssid, bssid, 6);
+    info.wifi_sta_connected.channel = channel;
+    emit(ARDUINO_EVENT_WIFI_STA_CONNECTED, info);
+  }
+  wifi_ps_type_t sleepMode() const { return _sleep; }
+
+  // What the client asked for
+  uint32_t begins;
+  int32_t lastChannel;
+  uint8_t lastBssid[6];
+  uint32_t staticIp;            // last config(), 0 = DHCP
+  uint32_t dns;
+
+private:
+  wl_status_t _status;
+  wifi_ps_type_t _sleep;
+  EventHandler _handler;
+};
+
+inline NativeWiFi& nativeWiFi() {
+  static NativeWiFi wifi;
+  return wifi;
+}
+#define WiFi nativeWiFi()
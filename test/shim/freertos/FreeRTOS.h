@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;      // 1 tick = 1 ms, as on the ESP32 Arduino core
+typedef void* TaskHandle_t;
+
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define portMAX_DELAY       0xFFFFFFFFu
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdPASS              1
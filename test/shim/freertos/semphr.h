@@ -0,0 +1,27 @@
+#pragma once
+#include "FreeRTOS.h"
+#include "SimClock.h"
+
+struct SimSemaphore {
+  bool given;
+};
+typedef SimSemaphore* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() {
+  SimSemaphore* s = new SimSemaphore;
+  s->given = false;
+  return s;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+  s->given = true;
+  return pdTRUE;
+}
+
+// Blocking take: simulated time runs (devices deliver data) until given or timed out
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) {
+  uint64_t deadline = ticks == portMAX_DELAY ? sim::NEVER - 1 : sim::nowUs() + (uint64_t)ticks * 1000;
+  bool ok = sim::runUntil(deadline, [s]() { return s->given; });
+  s->given = false;
+  return ok ? pdTRUE : pdFALSE;
+}
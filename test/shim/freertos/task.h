@@ -0,0 +1,18 @@
+#pragma once
+#include "FreeRTOS.h"
+#include "SimClock.h"
+
+// One simulated task: notifications are only recorded for the tests to read
+typedef enum { eNoAction, eSetBits, eIncrement } eNotifyAction;
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+  static int self;
+  return &self;
+}
+
+inline BaseType_t xTaskNotify(TaskHandle_t, uint32_t bits, eNotifyAction) {
+  sim::state().notifyBits |= bits;
+  return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
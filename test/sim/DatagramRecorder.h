@@ -0,0 +1,37 @@
+#pragma once
+#include <string.h>
+#include "DatagramSocket.h"
+
+// Station PC on the LAN: keeps the last datagram per port and counts them all.
+// `refuse` makes every send fail like a full lwIP queue.
+class DatagramRecorder : public DatagramSocket {
+public:
+  static const size_t MAX_LEN = 256;
+
+  bool refuse;
+  uint32_t count;
+  uint16_t lastPort;
+  uint8_t last[MAX_LEN];
+  size_t lastLen;
+  char lastJson[MAX_LEN];
+  uint32_t jsonCount;
+
+  DatagramRecorder() : refuse(false), count(0), lastPort(0), lastLen(0), jsonCount(0) {
+    lastJson[0] = '\0';
+  }
+
+  bool send(const char*, uint16_t port, const uint8_t* data, size_t len) override {
+    if (refuse || len > MAX_LEN - 1) return false;
+    count++;
+    lastPort = port;
+    if (len > 0 && data[0] == '{') {
+      memcpy(lastJson, data, len);
+      lastJson[len] = '\0';
+      jsonCount++;
+    } else {
+      memcpy(last, data, len);
+      lastLen = len;
+    }
+    return true;
+  }
+};
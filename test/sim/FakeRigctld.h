@@ -0,0 +1,113 @@
+#pragma once
+#include <stdio.h>
+#include <string.h>
+#include "NetClient.h"
+#include "SimClock.h"
+
+// rigctld on the LAN, speaking the extended response protocol ("+f").
+//
+// Every query is answered with the frequency at the time of the query after
+// `replyDelayUs`; `silent` drops queries, `refuse` rejects connects and
+// `refuseHost` only those to that host. Connects answer at once; `connects`
+// and `lastTimeoutMs` show what the client asked for.
+class FakeRigctld : public NetClient, public sim::Device {
+public:
+  uint32_t frequency;
+  uint32_t replyDelayUs;
+  bool silent;
+  bool refuse;
+  const char* refuseHost;
+
+  uint32_t queries;
+  uint32_t connects;
+  uint16_t lastTimeoutMs;
+  char lastHost[48];
+  uint64_t lastQueryUs;
+
+  explicit FakeRigctld(uint32_t freq = 14250000UL, uint32_t delayUs = 3000)
+      : frequency(freq), replyDelayUs(delayUs), silent(false), refuse(false), refuseHost(NULL),
+        queries(0), connects(0), lastTimeoutMs(0), lastQueryUs(0), _connected(false), _lineLen(0),
+        _replyAtUs(sim::NEVER), _rxLen(0), _rxPos(0) {
+    _pending[0] = '\0';
+    lastHost[0] = '\0';
+    sim::attach(this);
+  }
+
+  ~FakeRigctld() { sim::detach(this); }
+
+  // Server side hangup
+  void drop() { _connected = false; }
+
+  // NetClient
+  int connect(const char* host, uint16_t, uint16_t timeoutMs) override {
+    snprintf(lastHost, sizeof(lastHost), "%s", host);
+    connects++;
+    lastTimeoutMs = timeoutMs;
+    _connected = !refuse && (refuseHost == NULL || strcmp(host, refuseHost) != 0);
+    return _connected ? 1 : 0;
+  }
+
+  bool connected() override { return _connected; }
+  int available() override { return _rxLen - _rxPos; }
+  int read() override { return _rxPos < _rxLen ? (unsigned char)_rx[_rxPos++] : -1; }
+
+  size_t print(const char* data) override {
+    size_t len = strlen(data);
+    for (size_t i = 0; i < len; ++i) {
+      char c = data[i];
+      if (c != '\n') {
+        if (_lineLen < sizeof(_line) - 1) _line[_lineLen++] = c;
+        continue;
+      }
+      _line[_lineLen] = '\0';
+      _lineLen = 0;
+      handleLine();
+    }
+    return len;
+  }
+
+  void stop() override {
+    _connected = false;
+    _replyAtUs = sim::NEVER;
+    _rxLen = _rxPos = 0;
+  }
+
+  // sim::Device
+  uint64_t nextEventUs() const override { return _replyAtUs; }
+
+  void fire(uint64_t) override {
+    _replyAtUs = sim::NEVER;
+    if (!_connected) return;
+
+    // Unread bytes move to the front, the reply is appended
+    memmove(_rx, _rx + _rxPos, _rxLen - _rxPos);
+    _rxLen -= _rxPos;
+    _rxPos = 0;
+    size_t n = strlen(_pending);
+    if (_rxLen + n <= sizeof(_rx)) {
+      memcpy(_rx + _rxLen, _pending, n);
+      _rxLen += n;
+    }
+  }
+
+private:
+  void handleLine() {
+    if (strcmp(_line, "+f") != 0) return;
+    queries++;
+    lastQueryUs = sim::nowUs();
+    if (silent || _replyAtUs != sim::NEVER) return;
+
+    snprintf(_pending, sizeof(_pending), "get_freq:\nFrequency: %lu\nRPRT 0\n",
+             (unsigned long)frequency);
+    _replyAtUs = sim::nowUs() + replyDelayUs;
+  }
+
+  bool _connected;
+  char _line[32];
+  size_t _lineLen;
+  char _pending[64];
+  uint64_t _replyAtUs;
+  char _rx[256];
+  size_t _rxLen;
+  size_t _rxPos;
+};
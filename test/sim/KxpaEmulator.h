@@ -0,0 +1,219 @@
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SerialPort.h"
+#include "SimClock.h"
+
+// Scripted KXPA100 on the other end of a simulated 38400 baud line.
+//
+// Commands are answered like the real amp (queries with their value, set
+// commands with an echo) after `responseDelayUs`, at the wire speed of
+// `baud`. Faults are injected per reply byte (`dropPerMille`) or per reply
+// (`garblePerMille`, corrupts the first value character), from a seeded
+// generator so every run is the same. No heap use after construction.
+class KxpaEmulator : public SerialPort, public sim::Device {
+public:
+  struct Config {
+    uint32_t baud;
+    uint32_t responseDelayUs;
+    uint16_t dropPerMille;
+    uint16_t garblePerMille;
+    uint32_t seed;
+  };
+
+  static Config defaults() {
+    Config c = { 38400, 2000, 0, 0, 1 };
+    return c;
+  }
+
+  // Amplifier state, tests may change it at any time
+  int band;
+  int antenna;
+  char mode;               // 'B', 'M', 'A'
+  int powerX10;
+  int swrX10;
+  int tempX10;
+  int voltage;
+  char faults[8];
+  bool silent;             // swallow everything, like a powered-off amp
+  uint8_t ignoreAntennaSets;  // this many ^ANx; are echoed but not applied
+
+  // What happened on the line
+  uint32_t commands;
+  uint32_t replies;
+  uint32_t droppedBytes;
+  uint32_t garbledReplies;
+  uint64_t lastBandSetUs;  // arrival of the last ^BNxx; at the amp, 0 = never
+  uint32_t bandSets;
+  uint32_t antennaSets;
+
+  explicit KxpaEmulator(const Config& config = defaults())
+      : band(5), antenna(1), mode('A'), powerX10(0), swrX10(10), tempX10(250),
+        voltage(13800), silent(false), ignoreAntennaSets(0), commands(0), replies(0),
+        droppedBytes(0), garbledReplies(0), lastBandSetUs(0), bandSets(0),
+        antennaSets(0), _config(config), _open(false),
+        _rng(config.seed), _hostTxFreeUs(0), _ampTxFreeUs(0), _cmdLen(0),
+        _rxHead(0), _rxTail(0), _outHead(0), _outTail(0) {
+    strcpy(faults, "0");
+    sim::attach(this);
+  }
+
+  ~KxpaEmulator() { sim::detach(this); }
+
+  // Unsolicited frame from the amp, e.g. a front panel change
+  void inject(const char* frame) { queueReply(sim::nowUs(), frame); }
+
+  uint32_t charUs() const { return 10000000UL / _config.baud; }
+  void setResponseDelay(uint32_t us) { _config.responseDelayUs = us; }
+
+  // SerialPort
+  void begin(uint32_t, int, int, bool) override { _open = true; }
+  bool isOpen() override { return _open; }
+  int available() override { return (_rxHead - _rxTail + RX_SIZE) % RX_SIZE; }
+
+  int read() override {
+    if (_rxHead == _rxTail) return -1;
+    char c = _rx[_rxTail];
+    _rxTail = (_rxTail + 1) % RX_SIZE;
+    return (unsigned char)c;
+  }
+
+  size_t write(const char* data) override {
+    size_t len = strlen(data);
+    uint64_t at = _hostTxFreeUs > sim::nowUs() ? _hostTxFreeUs : sim::nowUs();
+
+    for (size_t i = 0; i < len; ++i) {
+      at += charUs();
+      char c = data[i];
+      if (c == '^') _cmdLen = 0;
+      if (_cmdLen < CMD_MAX - 1) _cmd[_cmdLen++] = c;
+      if (c == ';') {
+        _cmd[_cmdLen] = '\0';
+        _cmdLen = 0;
+        handleCommand(at);
+      }
+    }
+    _hostTxFreeUs = at;
+    return len;
+  }
+
+  void onReceive(std::function<void(void)> callback) override { _callback = callback; }
+
+  // sim::Device
+  uint64_t nextEventUs() const override {
+    return _outHead == _outTail ? sim::NEVER : _out[_outTail].doneUs;
+  }
+
+  void fire(uint64_t) override {
+    const Outgoing& o = _out[_outTail];
+    for (uint8_t i = 0; i < o.len; ++i) {
+      if (chance(_config.dropPerMille)) {
+        droppedBytes++;
+        continue;
+      }
+      uint16_t next = (_rxHead + 1) % RX_SIZE;
+      if (next == _rxTail) break;       // UART FIFO overflow
+      _rx[_rxHead] = o.data[i];
+      _rxHead = next;
+    }
+    _outTail = (_outTail + 1) % OUT_MAX;
+    if (_callback) _callback();
+  }
+
+private:
+  static const uint8_t CMD_MAX = 16;
+  static const uint8_t REPLY_MAX = 20;
+  static const uint8_t OUT_MAX = 32;
+  static const uint16_t RX_SIZE = 256;
+
+  struct Outgoing {
+    uint64_t doneUs;
+    char data[REPLY_MAX];
+    uint8_t len;
+  };
+
+  bool chance(uint16_t perMille) {
+    _rng = _rng * 1103515245UL + 12345UL;
+    return perMille > 0 && ((_rng >> 16) % 1000) < perMille;
+  }
+
+  void handleCommand(uint64_t arrivalUs) {
+    commands++;
+    if (silent) return;
+
+    char reply[REPLY_MAX];
+    reply[0] = '\0';
+    const char* arg = _cmd + 3;
+    bool query = *arg == ';';
+
+    if (strcmp(_cmd, "^I;") == 0) {
+      strcpy(reply, "^IKXPA100;");
+    } else if (strncmp(_cmd, "^BN", 3) == 0) {
+      if (!query) {
+        band = atoi(arg);
+        lastBandSetUs = arrivalUs;
+        bandSets++;
+      }
+      snprintf(reply, sizeof(reply), "^BN%02d;", band);
+    } else if (strncmp(_cmd, "^AN", 3) == 0) {
+      if (!query) {
+        antennaSets++;
+        if (ignoreAntennaSets > 0) {
+          ignoreAntennaSets--;
+        } else {
+          antenna = atoi(arg);
+        }
+      }
+      snprintf(reply, sizeof(reply), "^AN%d;", antenna);
+    } else if (strncmp(_cmd, "^MD", 3) == 0) {
+      if (!query) mode = *arg;
+      snprintf(reply, sizeof(reply), "^MD%c;", mode);
+    } else if (strcmp(_cmd, "^PF;") == 0) {
+      snprintf(reply, sizeof(reply), "^PF%04d;", powerX10);
+    } else if (strcmp(_cmd, "^SW;") == 0) {
+      snprintf(reply, sizeof(reply), "^SW%03d;", swrX10);
+    } else if (strcmp(_cmd, "^TM;") == 0) {
+      snprintf(reply, sizeof(reply), "^TM%03d;", tempX10);
+    } else if (strcmp(_cmd, "^SV;") == 0) {
+      snprintf(reply, sizeof(reply), "^SV%05d;", voltage);
+    } else if (strcmp(_cmd, "^FL;") == 0) {
+      snprintf(reply, sizeof(reply), "^FL%s;", faults);
+    }
+
+    if (reply[0] == '\0') return;
+    if (strlen(reply) > 4 && chance(_config.garblePerMille)) {
+      reply[3] = '#';
+      garbledReplies++;
+    }
+    queueReply(arrivalUs + _config.responseDelayUs, reply);
+  }
+
+  void queueReply(uint64_t readyUs, const char* reply) {
+    uint8_t next = (_outHead + 1) % OUT_MAX;
+    if (next == _outTail) return;      // amp output buffer full, reply lost
+
+    Outgoing& o = _out[_outHead];
+    o.len = (uint8_t)strlen(reply);
+    memcpy(o.data, reply, o.len);
+    uint64_t start = readyUs > _ampTxFreeUs ? readyUs : _ampTxFreeUs;
+    o.doneUs = start + (uint64_t)o.len * charUs();
+    _ampTxFreeUs = o.doneUs;
+    _outHead = next;
+    replies++;
+  }
+
+  Config _config;
+  bool _open;
+  uint32_t _rng;
+  uint64_t _hostTxFreeUs;
+  uint64_t _ampTxFreeUs;
+  std::function<void(void)> _callback;
+
+  char _cmd[CMD_MAX];
+  uint8_t _cmdLen;
+  char _rx[RX_SIZE];
+  uint16_t _rxHead, _rxTail;
+  Outgoing _out[OUT_MAX];
+  uint8_t _outHead, _outTail;
+};
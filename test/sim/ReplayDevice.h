@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include "ReplaySerialPort.h"
+#include "SimClock.h"
+
+// Pumps a ReplaySerialPort on simulated time, like the pump task on the bench
+class ReplayDevice : public sim::Device {
+public:
+  explicit ReplayDevice(ReplaySerialPort& port) : _port(port) { sim::attach(this); }
+  ~ReplayDevice() { sim::detach(this); }
+
+  uint64_t nextEventUs() const override {
+    int64_t at = _port.nextDueUs();
+    return at == INT64_MAX ? sim::NEVER : (uint64_t)at;
+  }
+
+  void fire(uint64_t nowUs) override { _port.pump((int64_t)nowUs); }
+
+private:
+  ReplaySerialPort& _port;
+};
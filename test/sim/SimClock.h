@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+
+// Simulated time for the native test environment.
+//
+// Nothing runs in the background: time only moves inside delay(),
+// xSemaphoreTake() and friends (see test/shim), or when a test calls
+// advance(). Devices (amp emulator, fake rigctld) tell the clock when they
+// next have something to do, and are fired in time order on the way.
+namespace sim {
+
+class Device {
+public:
+  virtual ~Device() {}
+  virtual uint64_t nextEventUs() const = 0;   // NEVER if idle
+  virtual void fire(uint64_t nowUs) = 0;
+};
+
+static const uint64_t NEVER = ~(uint64_t)0;
+static const uint8_t DEVICES_MAX = 4;
+
+struct ClockState {
+  uint64_t nowUs;
+  Device* devices[DEVICES_MAX];
+  uint32_t notifyBits;       // everything sent with xTaskNotify()
+};
+
+inline ClockState& state() {
+  static ClockState s = {0, {0}, 0};
+  return s;
+}
+
+inline uint64_t nowUs() { return state().nowUs; }
+
+inline void attach(Device* device) {
+  for (uint8_t i = 0; i < DEVICES_MAX; ++i) {
+    if (state().devices[i] == 0) {
+      state().devices[i] = device;
+      return;
+    }
+  }
+}
+
+inline void detach(Device* device) {
+  for (uint8_t i = 0; i < DEVICES_MAX; ++i) {
+    if (state().devices[i] == device) state().devices[i] = 0;
+  }
+}
+
+// Earliest pending device event
+inline Device* nextDevice(uint64_t& at) {
+  Device* next = 0;
+  at = NEVER;
+  for (uint8_t i = 0; i < DEVICES_MAX; ++i) {
+    Device* d = state().devices[i];
+    if (d != 0 && d->nextEventUs() < at) {
+      at = d->nextEventUs();
+      next = d;
+    }
+  }
+  return next;
+}
+
+// Moves time forward until done() holds or the deadline passes
+template <typename Pred>
+bool runUntil(uint64_t deadlineUs, Pred done) {
+  while (!done()) {
+    uint64_t at;
+    Device* d = nextDevice(at);
+    if (d == 0 || at > deadlineUs) {
+      if (deadlineUs > state().nowUs) state().nowUs = deadlineUs;
+      return done();
+    }
+    if (at > state().nowUs) state().nowUs = at;
+    d->fire(state().nowUs);
+  }
+  return true;
+}
+
+inline bool never() { return false; }
+
+inline void advance(uint64_t us) {
+  runUntil(state().nowUs + us, never);
+}
+
+// Test helpers for the task notification shim
+inline uint32_t takeNotifyBits() {
+  uint32_t bits = state().notifyBits;
+  state().notifyBits = 0;
+  return bits;
+}
+
+} // namespace sim
@@ -0,0 +1,310 @@
+// Backend benchmarks in simulated time (pio test -e native -f test_bench)
+//
+// Every figure is deterministic: the amp and rigctld emulators run on the
+// simulated clock, so a change in the numbers is a change in the code. The
+// limits are the budgets from the README; tighten them as the code improves.
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include "KXPA100Controller.h"
+#include "KxpaScheduler.h"
+#include "BandSelector.h"
+#include "CatWifiClient.h"
+#include "SweepCatSource.h"
+#include "LatencyStats.h"
+#include "KxpaEmulator.h"
+#include "FakeRigctld.h"
+
+// Same timing as the firmware (main.cpp)
+static const unsigned long CAT_POLL_MS = 50;
+static const unsigned long BAND_DWELL_MS = 250;
+static const uint8_t KXPA_POLL_BUDGET = 6;
+static const uint16_t DELAY_COMM_MS = 20;
+
+// Budgets
+static const uint32_t POLL_CYCLE_MAX_US = 60000;           // all 9 parameters
+static const uint32_t BAND_SWITCH_MAX_US = 400000;         // CAT change -> ^BN at the amp
+static const uint32_t SOAK_BAND_P99_MAX_US = 524287;       // first CAT freq -> setBand() done, dwell included
+
+//-----------------------------------------------------------------------------
+// Heap accounting: every operator new in the test binary is counted
+//-----------------------------------------------------------------------------
+
+static unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void setUp() {
+  LatencyStats::reset();
+}
+
+void tearDown() {}
+
+static void report(const char* what, LatencyStats::Timer timer) {
+  const LatencyStats::Histogram& h = LatencyStats::histogram(timer);
+  char line[120];
+  snprintf(line, sizeof(line), "%s: n=%lu avg=%luus p50<=%luus p99<=%luus max=%luus", what,
+           (unsigned long)h.count, (unsigned long)(h.count ? h.sumUs / h.count : 0),
+           (unsigned long)LatencyStats::percentile(timer, 50),
+           (unsigned long)LatencyStats::percentile(timer, 99),
+           (unsigned long)h.maxUs);
+  TEST_MESSAGE(line);
+}
+
+//-----------------------------------------------------------------------------
+// Benchmarks
+//-----------------------------------------------------------------------------
+
+void bench_full_poll_cycle() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, DELAY_COMM_MS, true);
+  kxpa.begin();
+  KXPA100Controller::StatusSnapshot status = {};
+
+  for (int i = 0; i < 200; ++i) {
+    kxpa.pollStatus(status);
+    TEST_ASSERT_TRUE(status.connected);
+    sim::advance(200000);
+  }
+
+  report("poll cycle (9 params)", LatencyStats::T_KXPA_POLL);
+  report("reply ^SW", (LatencyStats::Timer)(LatencyStats::T_KXPA_REPLY + KXPA100Controller::PARAM_SWR));
+  TEST_ASSERT_TRUE(LatencyStats::histogram(LatencyStats::T_KXPA_POLL).maxUs < POLL_CYCLE_MAX_US);
+}
+
+void bench_two_amps_interleaved() {
+  KxpaEmulator ampA;
+  KxpaEmulator ampB;
+  KXPA100Controller kxpaA(ampA, 16, 17, 38400, DELAY_COMM_MS, true);
+  KXPA100Controller kxpaB(ampB, 36, 26, 38400, DELAY_COMM_MS, true);
+  kxpaA.begin();
+  kxpaB.begin();
+  KXPA100Controller::StatusSnapshot statusA = {};
+  KXPA100Controller::StatusSnapshot statusB = {};
+
+  // Like the backend: both polls go out before either is collected
+  uint32_t worst = 0;
+  for (int i = 0; i < 200; ++i) {
+    uint64_t start = sim::nowUs();
+    kxpaA.startPoll(statusA);
+    kxpaB.startPoll(statusB);
+    kxpaA.finishPoll();
+    kxpaB.finishPoll();
+    uint32_t cycle = (uint32_t)(sim::nowUs() - start);
+    if (cycle > worst) worst = cycle;
+    TEST_ASSERT_TRUE(statusA.connected && statusB.connected);
+    sim::advance(200000);
+  }
+
+  char line[80];
+  snprintf(line, sizeof(line), "two amps, 9 params each: max=%luus", (unsigned long)worst);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_TRUE(worst < POLL_CYCLE_MAX_US);
+}
+
+void bench_scheduled_polls_allocate_nothing() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, DELAY_COMM_MS, true);
+  kxpa.begin();
+  KxpaScheduler scheduler(KXPA_POLL_BUDGET);
+  KxpaScheduler::PollPlan plan;
+  KXPA100Controller::StatusSnapshot status = {};
+
+  // Warm up, then count over the steady state
+  unsigned long cycles = 0;
+  unsigned long before = 0;
+  for (int i = 0; i < 600; ++i) {
+    if (i == 100) {
+      before = allocations;
+      cycles = 0;
+    }
+    unsigned long now = millis();
+    if (scheduler.plan(now, plan)) {
+      kxpa.startPoll(status, plan.params, plan.count);
+      kxpa.finishPoll();
+      scheduler.complete(plan, kxpa.lastPollMissing(), millis());
+      cycles++;
+    }
+    sim::advance((uint64_t)scheduler.msUntilDue(millis()) * 1000 + 1000);
+  }
+
+  char line[80];
+  snprintf(line, sizeof(line), "allocations: %lu in %lu scheduled cycles",
+           allocations - before, cycles);
+  TEST_MESSAGE(line);
+  report("scheduled poll", LatencyStats::T_KXPA_POLL);
+  TEST_ASSERT_TRUE(cycles > 0);
+  TEST_ASSERT_EQUAL(0, allocations - before);
+}
+
+void bench_frequency_change_to_band_switch() {
+  KxpaEmulator amp;
+  amp.band = 5;
+  FakeRigctld rig(14200000UL);
+  KXPA100Controller kxpa(amp, 16, 17, 38400, DELAY_COMM_MS, true);
+  kxpa.begin();
+  CatWifiClient cat(rig, "ssid", "pass", "192.168.1.10", 4532, 1000);
+  cat.begin();
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  BandSelector selector(kxpa, BAND_DWELL_MS);
+
+  // One QSY per band, in a fixed shuffled order
+  static const uint32_t QSY[] = {
+    7100000UL, 21200000UL, 3600000UL, 28400000UL, 10120000UL, 1850000UL,
+    18100000UL, 50150000UL, 24950000UL, 14250000UL, 5355000UL
+  };
+  const int count = sizeof(QSY) / sizeof(QSY[0]);
+  LatencyStats::Histogram switches = {};
+  uint32_t worst = 0;
+  int current = amp.band;
+  unsigned long lastCatPoll = 0;
+
+  for (int q = 0; q < count; ++q) {
+    int target = kxpa.getBandIndexByFrequency(QSY[q]);
+    rig.frequency = QSY[q];
+    uint64_t changedAt = sim::nowUs();
+    uint64_t deadline = changedAt + 2000000;
+
+    // The CAT half of the backend loop, 1 ms per pass
+    while (amp.band != target && sim::nowUs() < deadline) {
+      unsigned long now = millis();
+      cat.update();
+      if (cat.isConnected() && now - lastCatPoll >= CAT_POLL_MS && cat.requestFrequency()) {
+        lastCatPoll = now;
+      }
+      uint32_t freq;
+      if (cat.takeFrequency(freq)) {
+        selector.feed(freq, now);
+      }
+      selector.setCurrent(current);
+      int next;
+      if (selector.decide(millis(), next) && next != current) {
+        kxpa.setBand(next);
+        current = next;
+        selector.setCurrent(next);
+      }
+      sim::advance(1000);
+    }
+
+    TEST_ASSERT_EQUAL(target, amp.band);
+    uint32_t latency = (uint32_t)(amp.lastBandSetUs - changedAt);
+    if (latency > worst) worst = latency;
+    switches.sumUs += latency;
+    switches.count++;
+    sim::advance(500000);
+  }
+
+  char line[100];
+  snprintf(line, sizeof(line), "freq change -> ^BN at amp: n=%lu avg=%luus max=%luus",
+           (unsigned long)switches.count, (unsigned long)(switches.sumUs / switches.count),
+           (unsigned long)worst);
+  TEST_MESSAGE(line);
+  report("setBand incl. verify", LatencyStats::T_KXPA_SET_BAND);
+  report("cat reply", LatencyStats::T_CAT_REPLY);
+  TEST_ASSERT_TRUE(worst < BAND_SWITCH_MAX_US);
+}
+
+void bench_soak_band_sweep() {
+  // Soak firmware (SOAK_BENCH) in simulated time: a new band every second for 20 minutes
+  static const uint32_t QSY[] = {
+    7100000UL, 21200000UL, 3600000UL, 28400000UL, 10120000UL, 1850000UL,
+    18100000UL, 50150000UL, 24950000UL, 14250000UL, 5355000UL
+  };
+  static const KxpaScheduler::ParamConfig SOAK_POLL[] = {
+    {KXPA100Controller::PARAM_SWR,     0, 1, 1},
+    {KXPA100Controller::PARAM_POWER,   0, 1, 1},
+    {KXPA100Controller::PARAM_FAULTS,  1, 1, 1},
+    {KXPA100Controller::PARAM_BAND,    2, 1, 1},
+    {KXPA100Controller::PARAM_TEMP,    4, 1, 1},
+    {KXPA100Controller::PARAM_VOLTAGE, 4, 1, 1}
+  };
+  const unsigned long minutes = 20;
+
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, DELAY_COMM_MS, true);
+  kxpa.begin();
+  SweepCatSource cat(QSY, sizeof(QSY) / sizeof(QSY[0]), 1000, 5);
+  cat.begin();
+  BandSelector selector(kxpa, BAND_DWELL_MS);
+  KxpaScheduler scheduler(KXPA_POLL_BUDGET);
+  for (const KxpaScheduler::ParamConfig& c : SOAK_POLL) {
+    scheduler.configure(c.param, c.priority, c.periodMs, c.txPeriodMs);
+  }
+  KxpaScheduler::PollPlan plan;
+  KXPA100Controller::StatusSnapshot status = {};
+  int current = amp.band;
+  int64_t bandSinceUs = 0;
+
+  // Steady state from the second minute on
+  unsigned long end = millis() + minutes * 60000UL;
+  unsigned long warm = millis() + 60000UL;
+  unsigned long before = 0;
+  bool counting = false;
+
+  // The backend pass with catPollMs = 0, in the same order as backendTask()
+  while (millis() < end) {
+    if (!counting && millis() >= warm) {
+      before = allocations;
+      counting = true;
+    }
+    kxpa.service();
+    cat.update();
+    cat.requestFrequency();
+    uint32_t freq;
+    if (cat.takeFrequency(freq)) {
+      selector.feed(freq, millis());
+    }
+    if (selector.pending() && bandSinceUs == 0) {
+      bandSinceUs = esp_timer_get_time();
+    }
+    if (scheduler.plan(millis(), plan)) {
+      kxpa.startPoll(status, plan.params, plan.count);
+      kxpa.finishPoll();
+      scheduler.complete(plan, kxpa.lastPollMissing(), millis());
+    }
+    selector.setCurrent(current);
+    int next;
+    if (selector.decide(millis(), next) && next != current) {
+      kxpa.setBand(next);
+      current = next;
+      selector.setCurrent(next);
+      LatencyStats::record(LatencyStats::T_CAT_BAND, (uint32_t)(esp_timer_get_time() - bandSinceUs));
+    }
+    if (!selector.pending()) {
+      bandSinceUs = 0;
+    }
+    sim::advance(1000);
+  }
+
+  char line[100];
+  snprintf(line, sizeof(line), "soak %lu min: %lu band sets, allocations after warm-up: %lu",
+           minutes, (unsigned long)amp.bandSets, allocations - before);
+  TEST_MESSAGE(line);
+  report("soak poll", LatencyStats::T_KXPA_POLL);
+  report("soak cat->band", LatencyStats::T_CAT_BAND);
+  const LatencyStats::Histogram& switches = LatencyStats::histogram(LatencyStats::T_CAT_BAND);
+  TEST_ASSERT_TRUE(switches.count >= minutes * 60 - 1);       // every step changes the band
+  TEST_ASSERT_EQUAL(switches.count, amp.bandSets);
+  TEST_ASSERT_TRUE(LatencyStats::percentile(LatencyStats::T_CAT_BAND, 99) <= SOAK_BAND_P99_MAX_US);
+  TEST_ASSERT_TRUE(LatencyStats::histogram(LatencyStats::T_KXPA_POLL).maxUs < POLL_CYCLE_MAX_US);
+  TEST_ASSERT_EQUAL(0, LatencyStats::counter(LatencyStats::C_KXPA_TIMEOUT));
+  TEST_ASSERT_EQUAL(0, allocations - before);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(bench_full_poll_cycle);
+  RUN_TEST(bench_two_amps_interleaved);
+  RUN_TEST(bench_scheduled_polls_allocate_nothing);
+  RUN_TEST(bench_frequency_change_to_band_switch);
+  RUN_TEST(bench_soak_band_sweep);
+  return UNITY_END();
+}
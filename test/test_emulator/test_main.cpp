@@ -0,0 +1,417 @@
+// Backend against the KXPA100 emulator and the fake rigctld (pio test -e native)
+#include <unity.h>
+#include "KXPA100Controller.h"
+#include "CatWifiClient.h"
+#include "LatencyStats.h"
+#include "ProtectionEngine.h"
+#include "KxpaEmulator.h"
+#include "FakeRigctld.h"
+
+void setUp() {
+  LatencyStats::reset();
+  sim::takeNotifyBits();
+}
+
+void tearDown() {}
+
+static KXPA100Controller::StatusSnapshot pollAll(KXPA100Controller& kxpa) {
+  KXPA100Controller::StatusSnapshot status = {};
+  kxpa.pollStatus(status);
+  return status;
+}
+
+//-----------------------------------------------------------------------------
+// KXPA100
+//-----------------------------------------------------------------------------
+
+void test_poll_reads_every_value() {
+  KxpaEmulator amp;
+  amp.band = 7;
+  amp.antenna = 2;
+  amp.mode = 'M';
+  amp.powerX10 = 753;
+  amp.swrX10 = 14;
+  amp.tempX10 = 312;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  KXPA100Controller::StatusSnapshot s = pollAll(kxpa);
+
+  TEST_ASSERT_TRUE(s.connected);
+  TEST_ASSERT_EQUAL(7, s.band);
+  TEST_ASSERT_EQUAL(2, s.antenna);
+  TEST_ASSERT_EQUAL(KXPA100Controller::MODE_MANUAL, s.mode);
+  TEST_ASSERT_EQUAL(753, s.powerX10);
+  TEST_ASSERT_EQUAL(14, s.swrX10);
+  TEST_ASSERT_EQUAL(312, s.tempX10);
+  TEST_ASSERT_EQUAL(13800, s.voltageMv);
+  TEST_ASSERT_EQUAL_STRING("0", s.faults);
+  TEST_ASSERT_EQUAL_HEX16(0, kxpa.lastPollMissing());
+  TEST_ASSERT_TRUE(kxpa.idle());
+}
+
+void test_slow_amp_within_timeout() {
+  KxpaEmulator::Config cfg = KxpaEmulator::defaults();
+  cfg.responseDelayUs = 80000;
+  KxpaEmulator amp(cfg);
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  TEST_ASSERT_TRUE(pollAll(kxpa).connected);
+  TEST_ASSERT_EQUAL_HEX16(0, kxpa.lastPollMissing());
+}
+
+void test_silent_amp_times_out() {
+  KxpaEmulator amp;
+  amp.silent = true;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  uint64_t start = sim::nowUs();
+  KXPA100Controller::StatusSnapshot s = pollAll(kxpa);
+
+  TEST_ASSERT_FALSE(s.connected);
+  TEST_ASSERT_EQUAL_HEX16(KXPA100Controller::POLL_ALL, kxpa.lastPollMissing());
+  TEST_ASSERT_TRUE(sim::nowUs() - start <= 260000);   // POLL_TIMEOUT_MS + one tick
+  TEST_ASSERT_EQUAL(KXPA100Controller::PARAM_COUNT,
+                    LatencyStats::counter(LatencyStats::C_KXPA_TIMEOUT));
+  TEST_ASSERT_TRUE(kxpa.idle());
+}
+
+void test_dropped_bytes_never_mismatch() {
+  KxpaEmulator::Config cfg = KxpaEmulator::defaults();
+  cfg.dropPerMille = 30;
+  KxpaEmulator amp(cfg);
+  amp.band = 0;            // "^BN00": a lost digit still reads 0
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  // A damaged frame may be lost or rejected, but never lands in the wrong field
+  for (int i = 0; i < 50; ++i) {
+    KXPA100Controller::StatusSnapshot s = pollAll(kxpa);
+    if (!(kxpa.lastPollMissing() & (1 << KXPA100Controller::PARAM_BAND))) {
+      TEST_ASSERT_TRUE(s.band == 0 || s.band == -1);
+    }
+    sim::advance(200000);
+  }
+  TEST_ASSERT_TRUE(amp.droppedBytes > 0);
+  TEST_ASSERT_TRUE(LatencyStats::counter(LatencyStats::C_KXPA_TIMEOUT) > 0);
+}
+
+void test_garbled_replies_are_rejected() {
+  KxpaEmulator::Config cfg = KxpaEmulator::defaults();
+  cfg.garblePerMille = 1000;
+  KxpaEmulator amp(cfg);
+  amp.powerX10 = 500;
+  amp.swrX10 = 15;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  KXPA100Controller::StatusSnapshot s = pollAll(kxpa);
+
+  TEST_ASSERT_EQUAL(KXPA100Controller::INVALID_VALUE, s.powerX10);
+  TEST_ASSERT_EQUAL(KXPA100Controller::INVALID_VALUE, s.swrX10);
+  TEST_ASSERT_EQUAL(-1, s.band);
+  TEST_ASSERT_EQUAL(KXPA100Controller::MODE_UNKNOWN, s.mode);
+}
+
+void test_timeouts_adapt_to_a_fast_amp() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  for (int i = 0; i < 30; ++i) {
+    pollAll(kxpa);
+    sim::advance(200000);
+  }
+  TEST_ASSERT_TRUE(kxpa.turnaround(KXPA100Controller::PARAM_SWR).timeoutUs() < 20000);
+
+  // A dead amp is noticed in a fraction of the fixed 150 ms
+  amp.silent = true;
+  uint64_t start = sim::nowUs();
+  TEST_ASSERT_FALSE(pollAll(kxpa).connected);
+  TEST_ASSERT_TRUE(sim::nowUs() - start < 50000);
+}
+
+void test_timeouts_back_off_for_a_slower_amp() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  for (int i = 0; i < 30; ++i) {
+    pollAll(kxpa);
+    sim::advance(200000);
+  }
+
+  amp.setResponseDelay(60000);
+  int polls = 0;
+  uint16_t missing = KXPA100Controller::POLL_ALL;
+  while (missing != 0 && polls < 8) {
+    pollAll(kxpa);
+    missing = kxpa.lastPollMissing();
+    polls++;
+    sim::advance(200000);
+  }
+  TEST_ASSERT_EQUAL_HEX16(0, missing);
+  TEST_ASSERT_TRUE(kxpa.turnaround(KXPA100Controller::PARAM_IDENT).timeoutUs() > 60000);
+}
+
+void test_set_band_switches_band_and_antenna() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  TEST_ASSERT_TRUE(kxpa.setBand(10));
+
+  TEST_ASSERT_EQUAL(10, amp.band);
+  TEST_ASSERT_EQUAL(BANDPLAN_ANT2_MASK & (1 << 10) ? 2 : 1, amp.antenna);
+  TEST_ASSERT_EQUAL(1, amp.bandSets);
+  TEST_ASSERT_EQUAL(1, amp.antennaSets);
+  TEST_ASSERT_EQUAL(0, LatencyStats::counter(LatencyStats::C_KXPA_RETRY));
+  TEST_ASSERT_EQUAL(1, LatencyStats::histogram(LatencyStats::T_KXPA_SET_BAND).count);
+  TEST_ASSERT_TRUE(kxpa.idle());
+}
+
+void test_set_band_follows_the_runtime_antenna_map() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.setAntennaMask(1 << 5);
+  kxpa.begin();
+
+  TEST_ASSERT_TRUE(kxpa.setBand(5));
+  TEST_ASSERT_EQUAL(2, amp.antenna);
+  TEST_ASSERT_TRUE(kxpa.setBand(10));
+  TEST_ASSERT_EQUAL(1, amp.antenna);
+  TEST_ASSERT_EQUAL_STRING("^AN1;", kxpa.getAntennaCmd(10));
+}
+
+void test_set_band_retries_only_the_antenna() {
+  KxpaEmulator amp;
+  amp.antenna = 1;
+  amp.ignoreAntennaSets = 1;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  TEST_ASSERT_TRUE(kxpa.setBand(10));
+
+  TEST_ASSERT_EQUAL(2, amp.antenna);
+  TEST_ASSERT_EQUAL(1, amp.bandSets);
+  TEST_ASSERT_EQUAL(2, amp.antennaSets);
+  TEST_ASSERT_EQUAL(1, LatencyStats::counter(LatencyStats::C_KXPA_RETRY));
+}
+
+void test_set_band_reports_a_stuck_antenna() {
+  KxpaEmulator amp;
+  amp.antenna = 1;
+  amp.ignoreAntennaSets = 255;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+
+  TEST_ASSERT_FALSE(kxpa.setBand(10));
+
+  TEST_ASSERT_EQUAL(10, amp.band);
+  TEST_ASSERT_EQUAL(1, amp.bandSets);
+  TEST_ASSERT_EQUAL(1, LatencyStats::counter(LatencyStats::C_KXPA_FAIL));
+}
+
+void test_unsolicited_frame_wakes_owner() {
+  KxpaEmulator amp;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  kxpa.setFrameNotify(xTaskGetCurrentTaskHandle(), 1 << 1);
+
+  amp.inject("^BN04;");
+  sim::advance(5000);
+
+  TEST_ASSERT_EQUAL_HEX32(1 << 1, sim::takeNotifyBits());
+  kxpa.service();
+  TEST_ASSERT_EQUAL(1, LatencyStats::counter(LatencyStats::C_KXPA_UNEXPECTED));
+}
+
+//-----------------------------------------------------------------------------
+// rigctld
+//-----------------------------------------------------------------------------
+
+static void connectCat(CatWifiClient& cat) {
+  cat.begin();
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  for (int i = 0; i < 100 && !cat.isConnected(); ++i) {
+    cat.update();
+    sim::advance(1000);
+  }
+  cat.update();
+}
+
+void test_cat_reads_frequency() {
+  FakeRigctld rig(7074000UL);
+  CatWifiClient cat(rig, "ssid", "pass", "192.168.1.10", 4532, 1000);
+  connectCat(cat);
+  TEST_ASSERT_TRUE(cat.isConnected());
+  // The connect blocks the backend of every station, so it is bounded short
+  TEST_ASSERT_TRUE(rig.lastTimeoutMs > 0 && rig.lastTimeoutMs <= 200);
+
+  uint32_t freq = 0;
+  TEST_ASSERT_TRUE(cat.requestFrequency());
+  TEST_ASSERT_FALSE(cat.requestFrequency());     // one query in flight
+  for (int i = 0; i < 20 && !cat.takeFrequency(freq); ++i) {
+    sim::advance(1000);
+    cat.update();
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(7074000UL, freq);
+  TEST_ASSERT_EQUAL(1, LatencyStats::histogram(LatencyStats::T_CAT_REPLY).count);
+}
+
+void test_cat_timeout_frees_the_request() {
+  FakeRigctld rig;
+  rig.silent = true;
+  CatWifiClient cat(rig, "ssid", "pass", "192.168.1.10", 4532, 200);
+  connectCat(cat);
+
+  TEST_ASSERT_TRUE(cat.requestFrequency());
+  sim::advance(250000);
+  cat.update();
+
+  TEST_ASSERT_EQUAL(1, LatencyStats::counter(LatencyStats::C_CAT_TIMEOUT));
+  TEST_ASSERT_TRUE(cat.requestFrequency());
+}
+
+void test_cat_reconnects_after_hangup() {
+  FakeRigctld rig;
+  CatWifiClient cat(rig, "ssid", "pass", "192.168.1.10", 4532, 1000);
+  connectCat(cat);
+
+  rig.drop();
+  cat.update();
+  TEST_ASSERT_FALSE(cat.isConnected());
+
+  for (int i = 0; i < 1000 && !cat.isConnected(); ++i) {
+    sim::advance(1000);
+    cat.update();
+  }
+  TEST_ASSERT_TRUE(cat.isConnected());
+  TEST_ASSERT_EQUAL(1, LatencyStats::counter(LatencyStats::C_CAT_RECONNECT));
+}
+
+void test_cat_falls_back_from_a_dead_cached_endpoint() {
+  FakeRigctld rig;
+  rig.refuseHost = "192.168.1.99";
+  CatWifiClient cat(rig, "ssid", "pass", "192.168.1.10", 4532, 1000);
+  cat.preferEndpoint("192.168.1.99", 4532);
+  TEST_ASSERT_EQUAL_STRING("192.168.1.99", cat.endpointHost());
+  cat.begin();
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  unsigned long start = millis();
+
+  // One connect per pass: the cached endpoint fails, the next pass goes
+  // straight to the configured server without a backoff
+  cat.update();
+  TEST_ASSERT_EQUAL(1, rig.connects);
+  TEST_ASSERT_FALSE(cat.isConnected());
+  TEST_ASSERT_EQUAL(0, cat.msUntilWork(millis()));
+  cat.update();
+  TEST_ASSERT_EQUAL(2, rig.connects);
+
+  for (int i = 0; i < 5000 && !cat.isConnected(); ++i) {
+    cat.update();
+    sim::advance(1000);
+  }
+  TEST_ASSERT_TRUE(cat.isConnected());
+  TEST_ASSERT_EQUAL_STRING("192.168.1.10", rig.lastHost);
+  TEST_ASSERT_EQUAL_STRING("192.168.1.10", cat.endpointHost());
+  TEST_ASSERT_TRUE(millis() - start < 3000);
+}
+
+//-----------------------------------------------------------------------------
+// Protection
+//-----------------------------------------------------------------------------
+
+static const ProtectionEngine::Limits LIMITS = { 30, 50, 700, 10500, 15500 };
+
+void test_fault_codes_decode() {
+  uint8_t active = 0;
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_NONE, KXPA100Controller::decodeFault("0", &active));
+  TEST_ASSERT_EQUAL(0, active);
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_HIGH_SWR, KXPA100Controller::decodeFault("16", &active));
+  TEST_ASSERT_EQUAL(1, active);
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_HIGH_TEMP, KXPA100Controller::decodeFault("02"));
+
+  // A bitmap: 03 is high current and high temperature, not high voltage
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_HIGH_CURRENT, KXPA100Controller::decodeFault("03", &active));
+  TEST_ASSERT_EQUAL(2, active);
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_LOW_VOLTAGE, KXPA100Controller::decodeFault("40", &active));
+  TEST_ASSERT_EQUAL(2, active);                       // low voltage + overdrive
+
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_OTHER, KXPA100Controller::decodeFault("64"));
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_OTHER, KXPA100Controller::decodeFault("E1"));
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_UNKNOWN, KXPA100Controller::decodeFault("?"));
+}
+
+void test_high_swr_bypasses_within_one_transaction() {
+  KxpaEmulator amp;
+  amp.powerX10 = 800;
+  amp.swrX10 = 35;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  ProtectionEngine protection(LIMITS);
+
+  KXPA100Controller::StatusSnapshot s = pollAll(kxpa);
+  ProtectionEngine::Trip trip = protection.check(s, kxpa.lastPollMask() & ~kxpa.lastPollMissing());
+  TEST_ASSERT_EQUAL(ProtectionEngine::TRIP_SWR, trip);
+
+  // Like the backend: ^MDB; goes out right after the sample
+  uint64_t start = sim::nowUs();
+  TEST_ASSERT_TRUE(kxpa.setMode(KXPA100Controller::MODE_BYPASS));
+  uint32_t reactionUs = (uint32_t)(sim::nowUs() - start);
+  TEST_ASSERT_EQUAL('B', amp.mode);
+  TEST_ASSERT_TRUE(reactionUs < 20000);
+}
+
+void test_protection_judges_only_fresh_meaningful_samples() {
+  ProtectionEngine protection(LIMITS);
+  KXPA100Controller::StatusSnapshot s = {};
+  s.connected = true;
+  s.powerX10 = 20;      // 2 W: the SWR reading means nothing yet
+  s.swrX10 = 80;
+  s.tempX10 = 750;
+  s.voltageMv = 13800;
+  strcpy(s.faults, "0");
+
+  uint16_t swrOnly = (1 << KXPA100Controller::PARAM_POWER) | (1 << KXPA100Controller::PARAM_SWR);
+  TEST_ASSERT_EQUAL(ProtectionEngine::TRIP_NONE, protection.check(s, swrOnly));
+  TEST_ASSERT_EQUAL(ProtectionEngine::TRIP_TEMP,
+                    protection.check(s, swrOnly | (1 << KXPA100Controller::PARAM_TEMP)));
+
+  s.tempX10 = 400;
+  s.voltageMv = 9800;
+  TEST_ASSERT_EQUAL(ProtectionEngine::TRIP_VOLTAGE_LOW, protection.check(s, KXPA100Controller::POLL_ALL));
+
+  s.voltageMv = KXPA100Controller::INVALID_VALUE;
+  TEST_ASSERT_EQUAL(ProtectionEngine::TRIP_NONE, protection.check(s, KXPA100Controller::POLL_ALL));
+
+  strcpy(s.faults, "1");
+  TEST_ASSERT_EQUAL(ProtectionEngine::TRIP_FAULT, protection.check(s, KXPA100Controller::POLL_ALL));
+  TEST_ASSERT_EQUAL(KXPA100Controller::FAULT_HIGH_CURRENT, protection.lastFault());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_poll_reads_every_value);
+  RUN_TEST(test_slow_amp_within_timeout);
+  RUN_TEST(test_silent_amp_times_out);
+  RUN_TEST(test_dropped_bytes_never_mismatch);
+  RUN_TEST(test_garbled_replies_are_rejected);
+  RUN_TEST(test_timeouts_adapt_to_a_fast_amp);
+  RUN_TEST(test_timeouts_back_off_for_a_slower_amp);
+  RUN_TEST(test_set_band_switches_band_and_antenna);
+  RUN_TEST(test_set_band_follows_the_runtime_antenna_map);
+  RUN_TEST(test_set_band_retries_only_the_antenna);
+  RUN_TEST(test_set_band_reports_a_stuck_antenna);
+  RUN_TEST(test_unsolicited_frame_wakes_owner);
+  RUN_TEST(test_cat_reads_frequency);
+  RUN_TEST(test_cat_timeout_frees_the_request);
+  RUN_TEST(test_cat_reconnects_after_hangup);
+  RUN_TEST(test_cat_falls_back_from_a_dead_cached_endpoint);
+  RUN_TEST(test_fault_codes_decode);
+  RUN_TEST(test_high_swr_bypasses_within_one_transaction);
+  RUN_TEST(test_protection_judges_only_fresh_meaningful_samples);
+  return UNITY_END();
+}
@@ -0,0 +1,175 @@
+// Telemetry rollups, timestamps passed in directly (pio test -e native -f test_history)
+#include <unity.h>
+#include "TelemetryHistory.h"
+#include "KXPA100Controller.h"
+
+// ~11 KB, kept off the stack like the firmware's global
+static TelemetryHistory history;
+
+void setUp() {
+  history.clear();
+}
+
+void tearDown() {}
+
+//-----------------------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------------------
+
+void test_bucket_rounds_the_average_half_away_from_zero() {
+  TelemetryHistory::Stats stats;
+  history.append(TelemetryHistory::CH_POWER, 10, 1000);
+  history.append(TelemetryHistory::CH_POWER, 11, 1500);
+  history.append(TelemetryHistory::CH_TEMP, -10, 1000);
+  history.append(TelemetryHistory::CH_TEMP, -11, 1500);
+
+  // Nothing completed yet, the 1 s bucket is still open
+  TEST_ASSERT_FALSE(history.bucket(TelemetryHistory::CH_POWER, TelemetryHistory::LEVEL_1S, 0, stats));
+
+  history.append(TelemetryHistory::CH_POWER, 500, 2000);
+  history.append(TelemetryHistory::CH_TEMP, 500, 2000);
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_POWER, TelemetryHistory::LEVEL_1S, 0, stats));
+  TEST_ASSERT_EQUAL(10, stats.min);
+  TEST_ASSERT_EQUAL(11, stats.max);
+  TEST_ASSERT_EQUAL(11, stats.avg);         // 10.5
+  TEST_ASSERT_EQUAL(2, stats.count);
+
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_TEMP, TelemetryHistory::LEVEL_1S, 0, stats));
+  TEST_ASSERT_EQUAL(-11, stats.min);
+  TEST_ASSERT_EQUAL(-10, stats.max);
+  TEST_ASSERT_EQUAL(-11, stats.avg);        // -10.5
+}
+
+void test_buckets_cascade_up_to_one_minute() {
+  // One sample per second, the value is the second: 0 .. 59, then one to close
+  for (uint32_t i = 0; i <= 60; ++i) {
+    history.append(TelemetryHistory::CH_SWR, (int16_t)i, i * 1000 + 500);
+  }
+  TelemetryHistory::Stats stats;
+
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_1S, 0, stats));
+  TEST_ASSERT_EQUAL(59, stats.min);
+  TEST_ASSERT_EQUAL(1, stats.count);
+
+  // The newest 10 s bucket is seconds 50 .. 59, the oldest 0 .. 9
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_10S, 0, stats));
+  TEST_ASSERT_EQUAL(50, stats.min);
+  TEST_ASSERT_EQUAL(59, stats.max);
+  TEST_ASSERT_EQUAL(55, stats.avg);         // 54.5
+  TEST_ASSERT_EQUAL(10, stats.count);
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_10S, 5, stats));
+  TEST_ASSERT_EQUAL(0, stats.min);
+  TEST_ASSERT_EQUAL(9, stats.max);
+  TEST_ASSERT_FALSE(history.bucket(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_10S, 6, stats));
+
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_1MIN, 0, stats));
+  TEST_ASSERT_EQUAL(0, stats.min);
+  TEST_ASSERT_EQUAL(59, stats.max);
+  TEST_ASSERT_EQUAL(30, stats.avg);         // 29.5
+  TEST_ASSERT_EQUAL(60, stats.count);
+
+  // A window over the 10 s level gives the same minute
+  TEST_ASSERT_TRUE(history.window(TelemetryHistory::CH_SWR, TelemetryHistory::LEVEL_10S, 6, stats));
+  TEST_ASSERT_EQUAL(0, stats.min);
+  TEST_ASSERT_EQUAL(59, stats.max);
+  TEST_ASSERT_EQUAL(60, stats.count);
+}
+
+void test_first_sample_aligns_the_upper_levels() {
+  // Starts 2.345 s into a 10 s period: the first 10 s bucket only spans 8 s
+  TelemetryHistory::Stats stats;
+  history.append(TelemetryHistory::CH_VOLTAGE, 13800, 12345);
+  history.append(TelemetryHistory::CH_VOLTAGE, 13700, 19999);
+  TEST_ASSERT_FALSE(history.bucket(TelemetryHistory::CH_VOLTAGE, TelemetryHistory::LEVEL_10S, 0, stats));
+
+  history.append(TelemetryHistory::CH_VOLTAGE, 12000, 20000);
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_VOLTAGE, TelemetryHistory::LEVEL_10S, 0, stats));
+  TEST_ASSERT_EQUAL(2, stats.count);
+  TEST_ASSERT_EQUAL(13700, stats.min);
+  TEST_ASSERT_EQUAL(13800, stats.max);
+
+  // ... and the first minute closes at 60 s of millis(), not 60 s after the start
+  history.append(TelemetryHistory::CH_VOLTAGE, 12500, 59999);
+  TEST_ASSERT_FALSE(history.bucket(TelemetryHistory::CH_VOLTAGE, TelemetryHistory::LEVEL_1MIN, 0, stats));
+  history.append(TelemetryHistory::CH_VOLTAGE, 12500, 60000);
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_VOLTAGE, TelemetryHistory::LEVEL_1MIN, 0, stats));
+  TEST_ASSERT_EQUAL(4, stats.count);
+  TEST_ASSERT_EQUAL(12000, stats.min);
+}
+
+void test_long_gap_starts_over() {
+  TelemetryHistory::Stats stats;
+
+  // 30 min without samples: the empty buckets are closed, the old minute stays
+  history.append(TelemetryHistory::CH_TEMP, 250, 1000);
+  history.append(TelemetryHistory::CH_TEMP, 260, 1000 + 30UL * 60000UL);
+  TEST_ASSERT_TRUE(history.window(TelemetryHistory::CH_TEMP, TelemetryHistory::LEVEL_1MIN, 60, stats));
+  TEST_ASSERT_EQUAL(1, stats.count);
+  TEST_ASSERT_EQUAL(250, stats.max);
+
+  // A gap of MAX_GAP_MS (1 h) drops the rollups instead
+  history.append(TelemetryHistory::CH_TEMP, 270, 1000 + 90UL * 60000UL);
+  TEST_ASSERT_FALSE(history.window(TelemetryHistory::CH_TEMP, TelemetryHistory::LEVEL_1MIN, 60, stats));
+  TEST_ASSERT_FALSE(history.window(TelemetryHistory::CH_TEMP, TelemetryHistory::LEVEL_1S, 60, stats));
+
+  // Raw samples are kept, newest first
+  TelemetryHistory::Sample sample;
+  TEST_ASSERT_TRUE(history.sample(TelemetryHistory::CH_TEMP, 0, sample));
+  TEST_ASSERT_EQUAL(270, sample.value);
+  TEST_ASSERT_TRUE(history.sample(TelemetryHistory::CH_TEMP, 2, sample));
+  TEST_ASSERT_EQUAL(250, sample.value);
+  TEST_ASSERT_EQUAL(1000, sample.at);
+}
+
+void test_window_counts_past_16_bits() {
+  // 1 ms polls like the soak build: 180 s of supply voltage, then one to close
+  for (uint32_t at = 0; at <= 180000; ++at) {
+    history.append(TelemetryHistory::CH_VOLTAGE, 13800, at);
+  }
+  TelemetryHistory::Stats stats;
+  TEST_ASSERT_TRUE(history.window(TelemetryHistory::CH_VOLTAGE, TelemetryHistory::LEVEL_10S, 18, stats));
+  TEST_ASSERT_EQUAL_UINT32(180000, stats.count);
+  TEST_ASSERT_EQUAL(13800, stats.avg);       // the sum is past 32 bits too
+  TEST_ASSERT_EQUAL(13800, stats.min);
+}
+
+void test_invalid_values_are_skipped() {
+  KXPA100Controller::StatusSnapshot status = {};
+  status.connected = true;
+  status.powerX10 = 400;
+  status.swrX10 = KXPA100Controller::INVALID_VALUE;
+  status.tempX10 = 320;
+  status.voltageMv = 13800;
+
+  // Temperature was not answered in this poll, SWR came back out of range
+  uint16_t answered = (1 << KXPA100Controller::PARAM_POWER) | (1 << KXPA100Controller::PARAM_SWR) |
+                      (1 << KXPA100Controller::PARAM_VOLTAGE);
+  history.appendStatus(status, answered, 1000);
+  history.append(TelemetryHistory::CH_POWER, KXPA100Controller::INVALID_VALUE, 1100);
+
+  TelemetryHistory::Sample sample;
+  TEST_ASSERT_TRUE(history.sample(TelemetryHistory::CH_POWER, 0, sample));
+  TEST_ASSERT_EQUAL(400, sample.value);
+  TEST_ASSERT_FALSE(history.sample(TelemetryHistory::CH_POWER, 1, sample));
+  TEST_ASSERT_FALSE(history.sample(TelemetryHistory::CH_SWR, 0, sample));
+  TEST_ASSERT_FALSE(history.sample(TelemetryHistory::CH_TEMP, 0, sample));
+  TEST_ASSERT_TRUE(history.sample(TelemetryHistory::CH_VOLTAGE, 0, sample));
+
+  // The skipped sample does not pull the minimum down either
+  history.append(TelemetryHistory::CH_POWER, 500, 2000);
+  TelemetryHistory::Stats stats;
+  TEST_ASSERT_TRUE(history.bucket(TelemetryHistory::CH_POWER, TelemetryHistory::LEVEL_1S, 0, stats));
+  TEST_ASSERT_EQUAL(1, stats.count);
+  TEST_ASSERT_EQUAL(400, stats.min);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bucket_rounds_the_average_half_away_from_zero);
+  RUN_TEST(test_buckets_cascade_up_to_one_minute);
+  RUN_TEST(test_first_sample_aligns_the_upper_levels);
+  RUN_TEST(test_long_gap_starts_over);
+  RUN_TEST(test_window_counts_past_16_bits);
+  RUN_TEST(test_invalid_values_are_skipped);
+  return UNITY_END();
+}
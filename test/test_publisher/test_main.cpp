@@ -0,0 +1,203 @@
+// Telemetry export against a recording socket (pio test -e native -f test_publisher)
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include "TelemetryPublisher.h"
+#include "DatagramRecorder.h"
+
+static const unsigned long MIN_INTERVAL_MS = 100;
+static const unsigned long HEARTBEAT_MS = 5000;
+
+//-----------------------------------------------------------------------------
+// Heap accounting, as in test_bench
+//-----------------------------------------------------------------------------
+
+static unsigned long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* p = malloc(size ? size : 1);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void setUp() {}
+void tearDown() {}
+
+static Telemetry sample() {
+  Telemetry t;
+  t.bandIndex = 5;
+  t.powerX10 = 753;
+  t.swrX10 = 14;
+  t.tempX10 = 312;
+  t.voltageMv = 13800;
+  t.antenna = 1;
+  t.mode = KXPA100Controller::MODE_AUTO;
+  strcpy(t.faults, "0");
+  t.kxpaConnected = true;
+  t.catConnected = true;
+  return t;
+}
+
+static TelemetryPublisher::Datagram lastDatagram(const DatagramRecorder& rx) {
+  TelemetryPublisher::Datagram d;
+  TEST_ASSERT_EQUAL(sizeof(d), rx.lastLen);
+  memcpy(&d, rx.last, sizeof(d));
+  return d;
+}
+
+//-----------------------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------------------
+
+void test_first_snapshot_goes_out_complete() {
+  DatagramRecorder rx;
+  TelemetryPublisher pub(rx, "192.168.1.20", 7373, TelemetryPublisher::FORMAT_BINARY,
+                         MIN_INTERVAL_MS, HEARTBEAT_MS);
+  pub.offer(1, sample(), DIRTY_POWER);
+  pub.update(1000, true, false);
+
+  TEST_ASSERT_EQUAL(1, rx.count);
+  TEST_ASSERT_EQUAL(7373, rx.lastPort);
+  TelemetryPublisher::Datagram d = lastDatagram(rx);
+  TEST_ASSERT_EQUAL('K', d.magic[0]);
+  TEST_ASSERT_EQUAL('X', d.magic[1]);
+  TEST_ASSERT_EQUAL(TelemetryPublisher::VERSION, d.version);
+  TEST_ASSERT_EQUAL(1, d.station);
+  TEST_ASSERT_EQUAL(1, d.sequence);
+  TEST_ASSERT_EQUAL(DIRTY_ALL, d.changed);
+  TEST_ASSERT_EQUAL(TelemetryPublisher::FLAG_KXPA_CONNECTED | TelemetryPublisher::FLAG_CAT_CONNECTED,
+                    d.flags);
+  TEST_ASSERT_EQUAL(5, d.bandIndex);
+  TEST_ASSERT_EQUAL(753, d.powerX10);
+  TEST_ASSERT_EQUAL(14, d.swrX10);
+  TEST_ASSERT_EQUAL(13800, d.voltageMv);
+  TEST_ASSERT_EQUAL_STRING("0", d.faults);
+}
+
+void test_changes_are_coalesced_and_rate_limited() {
+  DatagramRecorder rx;
+  TelemetryPublisher pub(rx, "192.168.1.20", 7373, TelemetryPublisher::FORMAT_BINARY,
+                         MIN_INTERVAL_MS, HEARTBEAT_MS);
+  Telemetry t = sample();
+  pub.offer(0, t, DIRTY_ALL);
+  pub.update(0, true, false);
+
+  // A burst of changes within one interval: one datagram with the newest values
+  for (int i = 1; i <= 10; ++i) {
+    t.powerX10 = (int16_t)(700 + i);
+    t.swrX10 = (int16_t)(10 + i);
+    pub.offer(0, t, i % 2 ? DIRTY_POWER : DIRTY_SWR);
+    pub.update((unsigned long)i * 5, true, false);
+  }
+  TEST_ASSERT_EQUAL(1, rx.count);
+  TEST_ASSERT_EQUAL(MIN_INTERVAL_MS - 50, pub.msUntilWork(50));
+
+  pub.update(MIN_INTERVAL_MS, true, false);
+  TEST_ASSERT_EQUAL(2, rx.count);
+  TelemetryPublisher::Datagram d = lastDatagram(rx);
+  TEST_ASSERT_EQUAL(710, d.powerX10);
+  TEST_ASSERT_EQUAL(20, d.swrX10);
+  TEST_ASSERT_EQUAL(DIRTY_POWER | DIRTY_SWR, d.changed);
+  TEST_ASSERT_EQUAL(9, pub.coalesced());
+}
+
+void test_heartbeat_while_nothing_changes() {
+  DatagramRecorder rx;
+  TelemetryPublisher pub(rx, "192.168.1.20", 7373, TelemetryPublisher::FORMAT_BINARY,
+                         MIN_INTERVAL_MS, HEARTBEAT_MS);
+  pub.offer(0, sample(), DIRTY_ALL);
+  pub.update(0, true, false);
+
+  // A command ack alone changes nothing on the wire
+  pub.offer(0, sample(), 0);
+  pub.update(1000, true, false);
+  TEST_ASSERT_EQUAL(1, rx.count);
+  TEST_ASSERT_EQUAL(HEARTBEAT_MS - 1000, pub.msUntilWork(1000));
+
+  pub.update(HEARTBEAT_MS, true, false);
+  TEST_ASSERT_EQUAL(2, rx.count);
+  TelemetryPublisher::Datagram d = lastDatagram(rx);
+  TEST_ASSERT_EQUAL(0, d.changed);
+  TEST_ASSERT_TRUE(d.flags & TelemetryPublisher::FLAG_HEARTBEAT);
+}
+
+void test_waits_for_cat_reply_and_link() {
+  DatagramRecorder rx;
+  TelemetryPublisher pub(rx, "192.168.1.20", 7373, TelemetryPublisher::FORMAT_BINARY,
+                         MIN_INTERVAL_MS, HEARTBEAT_MS);
+
+  // No link: nothing is sent and the backend is not kept awake
+  pub.offer(0, sample(), DIRTY_ALL);
+  pub.update(0, false, false);
+  TEST_ASSERT_EQUAL(0, rx.count);
+  TEST_ASSERT_EQUAL(ULONG_MAX, pub.msUntilWork(0));
+
+  // A CAT query in flight holds the datagram back, but only so long
+  pub.update(10, true, true);
+  TEST_ASSERT_EQUAL(0, rx.count);
+  TEST_ASSERT_EQUAL(TelemetryPublisher::BUSY_DEFER_MAX_MS - 5, pub.msUntilWork(15));
+  pub.update(10 + TelemetryPublisher::BUSY_DEFER_MAX_MS, true, true);
+  TEST_ASSERT_EQUAL(1, rx.count);
+
+  // Once the reply is in, the next change goes out right away
+  Telemetry t = sample();
+  t.powerX10 = 10;
+  pub.offer(0, t, DIRTY_POWER);
+  pub.update(200, true, true);
+  TEST_ASSERT_EQUAL(1, rx.count);
+  pub.update(203, true, false);
+  TEST_ASSERT_EQUAL(2, rx.count);
+}
+
+void test_json_mirrors_the_binary_datagram() {
+  DatagramRecorder rx;
+  TelemetryPublisher pub(rx, "192.168.1.20", 7373,
+                         TelemetryPublisher::FORMAT_BINARY | TelemetryPublisher::FORMAT_JSON,
+                         MIN_INTERVAL_MS, HEARTBEAT_MS);
+  Telemetry t = sample();
+  t.tempX10 = -5;
+  pub.offer(0, t, DIRTY_ALL);
+  pub.update(1234, true, false);
+
+  TEST_ASSERT_EQUAL(2, rx.count);
+  TEST_ASSERT_EQUAL(7374, rx.lastPort);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"station\":0,\"seq\":1,\"uptime\":1234,\"changed\":511,\"heartbeat\":false,"
+      "\"kxpa\":true,\"cat\":true,\"band\":\"20m\",\"power\":75.3,\"swr\":1.4,\"temp\":-0.5,"
+      "\"voltage\":13.800,\"antenna\":1,\"mode\":2,\"faults\":\"0\"}",
+      rx.lastJson);
+}
+
+void test_steady_state_allocates_nothing() {
+  DatagramRecorder rx;
+  TelemetryPublisher pub(rx, "192.168.1.20", 7373,
+                         TelemetryPublisher::FORMAT_BINARY | TelemetryPublisher::FORMAT_JSON,
+                         MIN_INTERVAL_MS, HEARTBEAT_MS);
+  Telemetry t = sample();
+
+  unsigned long before = allocations;
+  for (unsigned long now = 0; now < 60000; now += 10) {
+    t.powerX10 = (int16_t)(now % 1000);
+    pub.offer(0, t, DIRTY_POWER);
+    pub.offer(1, t, DIRTY_POWER);
+    pub.update(now, true, now % 50 < 5);
+  }
+
+  TEST_ASSERT_EQUAL(2 * 600, pub.sent());
+  TEST_ASSERT_EQUAL(0, allocations - before);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_snapshot_goes_out_complete);
+  RUN_TEST(test_changes_are_coalesced_and_rate_limited);
+  RUN_TEST(test_heartbeat_while_nothing_changes);
+  RUN_TEST(test_waits_for_cat_reply_and_link);
+  RUN_TEST(test_json_mirrors_the_binary_datagram);
+  RUN_TEST(test_steady_state_allocates_nothing);
+  return UNITY_END();
+}
@@ -0,0 +1,200 @@
+// Frame capture and replay against the KXPA100 emulator (pio test -e native -f test_replay)
+#include <unity.h>
+#include "KXPA100Controller.h"
+#include "LatencyStats.h"
+#include "FrameLog.h"
+#include "ReplaySerialPort.h"
+#include "KxpaEmulator.h"
+#include "ReplayDevice.h"
+
+// Capture image in RAM, what SPIFFS would hold
+class ImagePrint : public Print {
+public:
+  static const size_t SIZE = 8192;
+  uint8_t data[SIZE];
+  size_t len;
+
+  ImagePrint() : len(0) {}
+  size_t write(const char* bytes, size_t n) override {
+    size_t room = SIZE - len;
+    if (n > room) n = room;
+    memcpy(data + len, bytes, n);
+    len += n;
+    return n;
+  }
+};
+
+static uint8_t ring[4096];
+
+void setUp() {
+  LatencyStats::reset();
+}
+
+void tearDown() {}
+
+struct Session {
+  KXPA100Controller::StatusSnapshot first;
+  KXPA100Controller::StatusSnapshot second;
+  uint64_t firstUs;             // duration of each poll
+  uint64_t secondUs;
+  bool bandSet;
+  uint16_t secondMissing;
+};
+
+// Poll, switch to 40m, poll with whatever the line does by then
+static Session runSession(KXPA100Controller& kxpa, KxpaEmulator* amp, uint32_t slowUs) {
+  Session s = {};
+  uint64_t start = sim::nowUs();
+  kxpa.pollStatus(s.first);
+  s.firstUs = sim::nowUs() - start;
+
+  s.bandSet = kxpa.setBand(7);
+
+  if (amp != NULL && slowUs > 0) amp->setResponseDelay(slowUs);
+  start = sim::nowUs();
+  kxpa.pollStatus(s.second);
+  s.secondUs = sim::nowUs() - start;
+  s.secondMissing = kxpa.lastPollMissing();
+  return s;
+}
+
+static Session capture(ImagePrint& image, uint32_t slowUs) {
+  KxpaEmulator amp;
+  amp.band = 5;
+  amp.powerX10 = 512;
+  amp.swrX10 = 13;
+  KXPA100Controller kxpa(amp, 16, 17, 38400, 20, true);
+  FrameLog log;
+  log.setBuffer(ring, sizeof(ring));
+  kxpa.setFrameLog(&log, 0);
+  kxpa.begin();
+  log.start();
+
+  Session s = runSession(kxpa, &amp, slowUs);
+  sim::advance(300000);         // late replies land in the capture too
+  kxpa.service();
+  log.stop();
+  log.dump(image);
+  return s;
+}
+
+//-----------------------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------------------
+
+void test_ring_keeps_the_newest_records() {
+  FrameLog log;
+  uint8_t small[100];
+  log.setBuffer(small, sizeof(small));
+  log.start();
+  char frame[16];
+  for (int i = 0; i < 20; ++i) {
+    snprintf(frame, sizeof(frame), "^PF%04d;", i);
+    log.record(1, FrameLog::KXPA_RX, frame, esp_timer_get_time());
+    sim::advance(1000);
+  }
+  TEST_ASSERT_EQUAL(7, log.records());         // 100 / (6 + 8)
+  TEST_ASSERT_EQUAL(13, log.lost());
+
+  ImagePrint image;
+  TEST_ASSERT_EQUAL(log.dumpSize(), log.dump(image));
+  FrameLog::Reader reader(image.data, image.len);
+  TEST_ASSERT_TRUE(reader.valid());
+  TEST_ASSERT_EQUAL(13, reader.lost());
+
+  FrameLog::Record rec;
+  uint32_t previousUs = 0;
+  int n = 0;
+  while (reader.next(rec)) {
+    snprintf(frame, sizeof(frame), "^PF%04d;", 13 + n);
+    TEST_ASSERT_EQUAL(8, rec.len);
+    TEST_ASSERT_EQUAL_MEMORY(frame, rec.data, 8);
+    TEST_ASSERT_EQUAL(1, rec.station);
+    TEST_ASSERT_EQUAL(FrameLog::KXPA_RX, rec.kind);
+    TEST_ASSERT_TRUE(n == 0 || rec.timeUs - previousUs == 1000);
+    previousUs = rec.timeUs;
+    n++;
+  }
+  TEST_ASSERT_EQUAL(7, n);
+
+  // Something else entirely is no capture
+  image.data[0] = 'X';
+  TEST_ASSERT_FALSE(FrameLog::Reader(image.data, image.len).valid());
+}
+
+void test_replay_reproduces_values_and_timing() {
+  ImagePrint image;
+  Session field = capture(image, 0);
+  TEST_ASSERT_TRUE(field.bandSet);
+
+  ReplaySerialPort port;
+  TEST_ASSERT_TRUE(port.load(image.data, image.len, 0));
+  ReplayDevice device(port);
+  KXPA100Controller kxpa(port, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  Session bench = runSession(kxpa, NULL, 0);
+
+  TEST_ASSERT_TRUE(bench.bandSet);
+  TEST_ASSERT_TRUE(bench.first.connected);
+  TEST_ASSERT_EQUAL(512, bench.first.powerX10);
+  TEST_ASSERT_EQUAL(13, bench.first.swrX10);
+  TEST_ASSERT_EQUAL(5, bench.first.band);
+  TEST_ASSERT_EQUAL(7, bench.second.band);
+  TEST_ASSERT_EQUAL(field.firstUs, bench.firstUs);
+  TEST_ASSERT_EQUAL(field.secondUs, bench.secondUs);
+  TEST_ASSERT_EQUAL(0, port.txMismatched());
+  TEST_ASSERT_TRUE(port.txMatched() >= 2 * KXPA100Controller::PARAM_COUNT + 2);
+}
+
+void test_replay_repeats_a_timeout() {
+  // The amp turns slow after the band switch: every reply misses its timeout
+  ImagePrint image;
+  Session field = capture(image, 200000);
+  TEST_ASSERT_TRUE(field.secondMissing != 0);
+
+  ReplaySerialPort port;
+  port.load(image.data, image.len, 0);
+  ReplayDevice device(port);
+  KXPA100Controller kxpa(port, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  Session bench = runSession(kxpa, NULL, 0);
+  sim::advance(300000);
+  kxpa.service();
+
+  TEST_ASSERT_EQUAL_HEX16(field.secondMissing, bench.secondMissing);
+  TEST_ASSERT_EQUAL(field.secondUs, bench.secondUs);
+  TEST_ASSERT_EQUAL(0, port.txMismatched());
+  TEST_ASSERT_TRUE(port.finished());
+}
+
+void test_replay_counts_commands_that_differ() {
+  ImagePrint image;
+  capture(image, 0);
+
+  ReplaySerialPort port;
+  port.load(image.data, image.len, 0);
+  ReplayDevice device(port);
+  KXPA100Controller kxpa(port, 16, 17, 38400, 20, true);
+  kxpa.begin();
+  KXPA100Controller::StatusSnapshot status = {};
+  kxpa.pollStatus(status);
+  TEST_ASSERT_EQUAL(0, port.txMismatched());
+
+  // The capture has ^BN07; here
+  kxpa.setBand(3);
+  TEST_ASSERT_TRUE(port.txMismatched() > 0);
+
+  // Another station's frames are not this one's
+  ReplaySerialPort other;
+  other.load(image.data, image.len, 1);
+  TEST_ASSERT_TRUE(other.finished());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_keeps_the_newest_records);
+  RUN_TEST(test_replay_reproduces_values_and_timing);
+  RUN_TEST(test_replay_repeats_a_timeout);
+  RUN_TEST(test_replay_counts_commands_that_differ);
+  return UNITY_END();
+}
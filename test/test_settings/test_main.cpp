@@ -0,0 +1,152 @@
+// NVS settings against the in-memory flash of test/shim (pio test -e native -f test_settings)
+#include <unity.h>
+#include "SettingsStore.h"
+#include "KXPA100Controller.h"
+
+static const SettingsStore::Tuning DEFAULTS = { 38400, 20, 50, 250, 1 << 10 };
+
+void setUp() {
+  nativeNvs().erase();
+  nativeNvs().writes = 0;
+}
+
+void tearDown() {}
+
+//-----------------------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------------------
+
+void test_empty_flash_gives_defaults() {
+  SettingsStore store(DEFAULTS);
+  store.begin();
+
+  TEST_ASSERT_EQUAL(38400, store.tuning().baud);
+  TEST_ASSERT_EQUAL(1 << 10, store.tuning().ant2Mask);
+  TEST_ASSERT_EQUAL(-1, store.station(0).band);
+  TEST_ASSERT_EQUAL(KXPA100Controller::MODE_UNKNOWN, store.station(1).mode);
+  TEST_ASSERT_EQUAL_STRING("", store.station(0).catHost);
+  TEST_ASSERT_EQUAL(0, nativeNvs().writes);
+}
+
+void test_tuning_survives_reboot_and_checks_ranges() {
+  SettingsStore store(DEFAULTS);
+  store.begin();
+  TEST_ASSERT_TRUE(store.setTuning("catpoll", 100));
+  TEST_ASSERT_TRUE(store.setTuning("ant2", 0x600));
+  TEST_ASSERT_FALSE(store.setTuning("catpoll", 5));        // below the floor
+  TEST_ASSERT_FALSE(store.setTuning("baud", 115200));      // the KXPA100 can't
+  TEST_ASSERT_FALSE(store.setTuning("pins", 1));
+  TEST_ASSERT_EQUAL(100, store.tuning().catPollMs);
+
+  SettingsStore rebooted(DEFAULTS);
+  rebooted.begin();
+  TEST_ASSERT_EQUAL(100, rebooted.tuning().catPollMs);
+  TEST_ASSERT_EQUAL(0x600, rebooted.tuning().ant2Mask);
+  TEST_ASSERT_EQUAL(38400, rebooted.tuning().baud);
+
+  rebooted.resetTuning();
+  SettingsStore again(DEFAULTS);
+  again.begin();
+  TEST_ASSERT_EQUAL(50, again.tuning().catPollMs);
+}
+
+void test_state_is_saved_once_it_settles() {
+  SettingsStore store(DEFAULTS);
+  store.begin();
+
+  // A QSY across three bands within the delay: one write, with the last band
+  store.setBand(0, 3, 1000);
+  store.setBand(0, 4, 2000);
+  store.setBand(0, 7, 3000);
+  store.setMode(0, KXPA100Controller::MODE_AUTO, 3000);
+  TEST_ASSERT_FALSE(store.update(3000 + SettingsStore::SAVE_DELAY_MS - 1));
+  TEST_ASSERT_EQUAL(1, store.msUntilSave(3000 + SettingsStore::SAVE_DELAY_MS - 1));
+  TEST_ASSERT_TRUE(store.update(3000 + SettingsStore::SAVE_DELAY_MS));
+  TEST_ASSERT_EQUAL(1, nativeNvs().writes);
+  TEST_ASSERT_EQUAL(ULONG_MAX, store.msUntilSave(10000));
+
+  // Setting what is already there is no change, changed and back is no write
+  store.setBand(0, 7, 20000);
+  TEST_ASSERT_EQUAL(ULONG_MAX, store.msUntilSave(20000));
+  store.setBand(0, 8, 20000);
+  store.setBand(0, 7, 21000);
+  TEST_ASSERT_FALSE(store.update(30000));
+  TEST_ASSERT_EQUAL(1, nativeNvs().writes);
+
+  SettingsStore rebooted(DEFAULTS);
+  rebooted.begin();
+  TEST_ASSERT_EQUAL(7, rebooted.station(0).band);
+  TEST_ASSERT_EQUAL(KXPA100Controller::MODE_AUTO, rebooted.station(0).mode);
+  TEST_ASSERT_EQUAL(-1, rebooted.station(1).band);
+}
+
+void test_cat_endpoint_is_kept_per_station() {
+  SettingsStore store(DEFAULTS);
+  store.begin();
+  store.setCatEndpoint(1, "192.168.1.20", 4532, 0);
+  store.setCatEndpoint(1, "a-very-long-host-name.shack.example.org.invalid", 4533, 100);
+  TEST_ASSERT_TRUE(store.update(100 + SettingsStore::SAVE_DELAY_MS));
+
+  SettingsStore rebooted(DEFAULTS);
+  rebooted.begin();
+  TEST_ASSERT_EQUAL(SettingsStore::HOST_MAX - 1, strlen(rebooted.station(1).catHost));
+  TEST_ASSERT_EQUAL(4533, rebooted.station(1).catPort);
+  TEST_ASSERT_EQUAL_STRING("", rebooted.station(0).catHost);
+}
+
+void test_wifi_association_is_saved_with_the_state() {
+  SettingsStore store(DEFAULTS);
+  store.begin();
+  WifiCache wifi;
+  memset(&wifi, 0, sizeof(wifi));
+  strcpy(wifi.ssid, "shack");
+  wifi.channel = 6;
+  wifi.ip = 0x3201A8C0;
+  store.setWifiCache(wifi, 0);
+  store.setBand(0, 5, 0);
+  TEST_ASSERT_TRUE(store.update(SettingsStore::SAVE_DELAY_MS));
+  TEST_ASSERT_EQUAL(2, store.writes());
+
+  // The same association again (every reconnect hands one over): no write
+  store.setWifiCache(wifi, 10000);
+  TEST_ASSERT_FALSE(store.update(20000));
+
+  SettingsStore rebooted(DEFAULTS);
+  rebooted.begin();
+  TEST_ASSERT_EQUAL_STRING("shack", rebooted.wifiCache().ssid);
+  TEST_ASSERT_EQUAL(6, rebooted.wifiCache().channel);
+  TEST_ASSERT_EQUAL_HEX32(0x3201A8C0, rebooted.wifiCache().ip);
+}
+
+void test_blob_of_another_layout_is_ignored() {
+  Preferences prefs;
+  prefs.begin("kxpa");
+  uint8_t old[12] = {0};
+  prefs.putBytes("tune", old, sizeof(old));
+
+  // Right size, next version
+  SettingsStore written(DEFAULTS);
+  written.begin();
+  written.setBand(0, 2, 0);
+  TEST_ASSERT_TRUE(written.update(SettingsStore::SAVE_DELAY_MS));
+  uint8_t blob[NativeNvs::VALUE_MAX];
+  size_t len = prefs.getBytes("state", blob, sizeof(blob));
+  blob[0] = SettingsStore::VERSION + 1;
+  prefs.putBytes("state", blob, len);
+
+  SettingsStore store(DEFAULTS);
+  store.begin();
+  TEST_ASSERT_EQUAL(50, store.tuning().catPollMs);
+  TEST_ASSERT_EQUAL(-1, store.station(0).band);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_flash_gives_defaults);
+  RUN_TEST(test_tuning_survives_reboot_and_checks_ranges);
+  RUN_TEST(test_state_is_saved_once_it_settles);
+  RUN_TEST(test_cat_endpoint_is_kept_per_station);
+  RUN_TEST(test_wifi_association_is_saved_with_the_state);
+  RUN_TEST(test_blob_of_another_layout_is_ignored);
+  return UNITY_END();
+}
@@ -0,0 +1,128 @@
+// WiFi fast reconnect on one simulated boot (pio test -e native -f test_wifi)
+//
+// The first client to begin() owns the station interface for the life of the
+// binary, so the tests run in order against the same boot.
+#include <unity.h>
+#include "CatWifiClient.h"
+#include "LatencyStats.h"
+#include "FakeRigctld.h"
+
+static const uint8_t AP[6] = { 0x24, 0x4B, 0xFE, 0x01, 0x02, 0x03 };
+static const uint8_t AP_2[6] = { 0x24, 0x4B, 0xFE, 0x0A, 0x0B, 0x0C };
+static const uint32_t SAVED_IP = 0x3201A8C0;      // 192.168.1.50
+
+static FakeRigctld rig;
+static CatWifiClient cat(rig, "shack", "pass", "192.168.1.10", 4532, 1000);
+
+void setUp() {
+  LatencyStats::reset();
+}
+
+void tearDown() {}
+
+// Backend loop until the CAT server is connected; ms it took, or -1
+static long runUntilConnected(unsigned long limitMs) {
+  unsigned long start = millis();
+  while (millis() - start < limitMs) {
+    cat.update();
+    if (cat.isConnected()) return (long)(millis() - start);
+    sim::advance(1000);
+  }
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------------------
+
+void test_warm_boot_skips_scan_and_dhcp() {
+  WifiCache saved;
+  memset(&saved, 0, sizeof(saved));
+  strcpy(saved.ssid, "shack");
+  memcpy(saved.bssid, AP, sizeof(AP));
+  saved.channel = 6;
+  saved.ip = SAVED_IP;
+  saved.gateway = 0x0101A8C0;
+  saved.mask = 0x00FFFFFF;
+  CatWifiClient::setWifiCache(saved, true);
+
+  cat.begin();
+
+  TEST_ASSERT_EQUAL(1, WiFi.begins);
+  TEST_ASSERT_EQUAL(6, WiFi.lastChannel);
+  TEST_ASSERT_EQUAL_MEMORY(AP, WiFi.lastBssid, sizeof(AP));
+  TEST_ASSERT_EQUAL_HEX32(SAVED_IP, WiFi.staticIp);
+}
+
+void test_unreachable_saved_address_falls_back_to_dhcp() {
+  rig.refuse = true;
+  WiFi.associate(AP, 6);
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+
+  // One connect timeout with the reused address, then DHCP
+  TEST_ASSERT_EQUAL(-1, runUntilConnected(2500));
+  TEST_ASSERT_EQUAL_HEX32(0, WiFi.staticIp);
+
+  rig.refuse = false;
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  long ms = runUntilConnected(3000);
+  TEST_ASSERT_TRUE(ms >= 0 && ms < 50);
+}
+
+void test_association_is_handed_over_once() {
+  WifiCache learned;
+  TEST_ASSERT_TRUE(CatWifiClient::takeWifiCache(learned));
+  TEST_ASSERT_FALSE(CatWifiClient::takeWifiCache(learned));
+
+  TEST_ASSERT_EQUAL_STRING("shack", learned.ssid);
+  TEST_ASSERT_EQUAL_MEMORY(AP, learned.bssid, sizeof(AP));
+  TEST_ASSERT_EQUAL(6, learned.channel);
+  TEST_ASSERT_EQUAL_HEX32(SAVED_IP, learned.ip);
+  TEST_ASSERT_EQUAL_HEX32(WiFi.dns, learned.dns);
+}
+
+void test_link_loss_rejoins_the_known_ap() {
+  uint32_t begins = WiFi.begins;
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  TEST_ASSERT_EQUAL(begins + 1, WiFi.begins);
+  TEST_ASSERT_EQUAL(6, WiFi.lastChannel);
+
+  // The AP is gone: the fast join fails once, then a full scan finds another
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  TEST_ASSERT_EQUAL(begins + 2, WiFi.begins);
+  TEST_ASSERT_EQUAL(0, WiFi.lastChannel);
+
+  WiFi.associate(AP_2, 11);
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  TEST_ASSERT_EQUAL(11, WiFi.lastChannel);
+  TEST_ASSERT_EQUAL_MEMORY(AP_2, WiFi.lastBssid, sizeof(AP_2));
+}
+
+void test_fresh_address_skips_the_connect_backoff() {
+  // Pile up failed connects on a link that stays up
+  rig.refuse = true;
+  WiFi.associate(AP_2, 11);
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  TEST_ASSERT_EQUAL(-1, runUntilConnected(20000));
+  rig.refuse = false;
+  TEST_ASSERT_TRUE(cat.msUntilWork(millis()) > 1000);
+
+  // Link loss and a new address: no wait behind the backoff
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  WiFi.associate(AP_2, 11);
+  WiFi.emit(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  TEST_ASSERT_EQUAL(0, cat.msUntilWork(millis()));
+  long ms = runUntilConnected(3000);
+  TEST_ASSERT_TRUE(ms >= 0 && ms < 50);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_warm_boot_skips_scan_and_dhcp);
+  RUN_TEST(test_unreachable_saved_address_falls_back_to_dhcp);
+  RUN_TEST(test_association_is_handed_over_once);
+  RUN_TEST(test_link_loss_rejoins_the_known_ap);
+  RUN_TEST(test_fresh_address_skips_the_connect_backoff);
+  return UNITY_END();
+}
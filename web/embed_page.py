@@ -0,0 +1,33 @@
+#!/usr/bin/env python3
+"""Regenerate src/DashboardPage.h from web/dashboard.html (gzip, byte array in flash).
+
+Run from the project root after editing the page: python3 web/embed_page.py
+"""
+import gzip
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "web", "dashboard.html")
+TARGET = os.path.join(ROOT, "src", "DashboardPage.h")
+
+with open(SOURCE, "rb") as f:
+    page = f.read()
+
+# mtime=0 keeps the output reproducible
+data = gzip.compress(page, compresslevel=9, mtime=0)
+
+lines = []
+for i in range(0, len(data), 16):
+    lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+
+with open(TARGET, "w") as f:
+    f.write("#pragma once\n")
+    f.write("#include <Arduino.h>\n\n")
+    f.write("// Generated by web/embed_page.py from web/dashboard.html, do not edit.\n")
+    f.write("// %d bytes of HTML, gzipped; served as-is with Content-Encoding: gzip\n" % len(page))
+    f.write("const uint8_t DASHBOARD_PAGE_GZ[] PROGMEM = {\n")
+    f.write("\n".join(lines) + "\n")
+    f.write("};\n")
+    f.write("const size_t DASHBOARD_PAGE_GZ_LEN = sizeof(DASHBOARD_PAGE_GZ);\n")
+
+print("%s: %d -> %d bytes" % (os.path.relpath(TARGET, ROOT), len(page), len(data)))